@@ -0,0 +1,1310 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_manager_instance.cpp
+//
+// Identification: src/buffer/buffer_pool_manager_instance.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_manager_instance.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+namespace {
+
+/** Identifies a hot set file: "HOTS". */
+constexpr uint32_t HOT_SET_MAGIC = 0x484f5453;
+
+/** Write a hot set file next to the old one and move it into place, so that a crash never leaves a torn file. */
+bool WriteHotSetFile(const std::string &file_name, const std::vector<page_id_t> &page_ids) {
+  std::string tmp_file_name = file_name + ".tmp";
+  {
+    std::ofstream out(tmp_file_name, std::ios::binary | std::ios::trunc);
+    auto num_pages = static_cast<uint32_t>(page_ids.size());
+    out.write(reinterpret_cast<const char *>(&HOT_SET_MAGIC), sizeof(HOT_SET_MAGIC));
+    out.write(reinterpret_cast<const char *>(&num_pages), sizeof(num_pages));
+    out.write(reinterpret_cast<const char *>(page_ids.data()), page_ids.size() * sizeof(page_id_t));
+    out.flush();
+    if (!out) {
+      return false;
+    }
+  }
+  return std::rename(tmp_file_name.c_str(), file_name.c_str()) == 0;
+}
+
+bool ReadHotSetFile(const std::string &file_name, std::vector<page_id_t> *page_ids) {
+  std::ifstream in(file_name, std::ios::binary);
+  uint32_t magic = 0;
+  uint32_t num_pages = 0;
+  in.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+  in.read(reinterpret_cast<char *>(&num_pages), sizeof(num_pages));
+  if (!in || magic != HOT_SET_MAGIC) {
+    return false;
+  }
+  page_ids->resize(num_pages);
+  in.read(reinterpret_cast<char *>(page_ids->data()), num_pages * sizeof(page_id_t));
+  return static_cast<bool>(in);
+}
+
+}  // namespace
+
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskInterface *disk_manager,
+                                                     LogManager *log_manager, ReplacerType replacer_type)
+    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, log_manager, replacer_type) {}
+
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances,
+                                                     uint32_t instance_index, DiskInterface *disk_manager,
+                                                     LogManager *log_manager, ReplacerType replacer_type)
+    : pool_size_(pool_size),
+      chunk_size_(pool_size),
+      num_instances_(num_instances),
+      instance_index_(instance_index),
+      disk_manager_(disk_manager),
+      log_manager_(log_manager),
+      page_table_(pool_size * BUFFER_POOL_MAX_CHUNKS) {
+  BUSTUB_ASSERT(num_instances > 0, "If BPI is not part of a pool, then the pool size should just be 1");
+  BUSTUB_ASSERT(
+      instance_index < num_instances,
+      "BPI index cannot be greater than the number of BPIs in the pool. In non-parallel case, index should just be 1.");
+  BUSTUB_ASSERT(pool_size > 0, "A buffer pool needs at least one frame.");
+  // The pool starts out as one chunk of frames and can grow to BUFFER_POOL_MAX_CHUNKS of them, so the replacer and the
+  // page table are sized for that many frames up front. The replacer is told how many of them are in use as chunks
+  // come and go.
+  size_t max_frames = chunk_size_ * BUFFER_POOL_MAX_CHUNKS;
+  switch (replacer_type) {
+    case ReplacerType::CLOCK:
+      replacer_ = new ClockReplacer(max_frames);
+      break;
+    case ReplacerType::LRUK:
+      replacer_ = new LRUKReplacer(max_frames, LRUK_REPLACER_K);
+      break;
+    case ReplacerType::LRU:
+    default:
+      replacer_ = new LRUReplacer(max_frames);
+      break;
+  }
+  lookup_stripes_ = std::make_unique<LookupStripe[]>(NUM_LOOKUP_STRIPES);
+  prefetcher_ = std::make_unique<Prefetcher>(this);
+
+  std::scoped_lock bpm_slk{latch_};
+  AddChunk(0);
+  ResetScanRing();
+}
+
+BufferPoolManagerInstance::~BufferPoolManagerInstance() {
+  StopBackgroundWriter();
+  prefetcher_->Stop();
+  if (!hot_set_file_.empty()) {
+    FlushAllPagesImpl();
+    SaveHotSet(hot_set_file_);
+  }
+  for (auto &chunk : chunks_) {
+    delete chunk.load();
+  }
+  delete replacer_;
+}
+
+BufferPoolManagerInstance::FrameChunk::FrameChunk(size_t num_frames)
+    : arena_(num_frames),
+      pages_(std::make_unique<Page[]>(num_frames)),
+      io_in_progress_(std::make_unique<std::atomic<bool>[]>(num_frames)),
+      io_done_(std::make_unique<std::condition_variable_any[]>(num_frames)),
+      in_scan_ring_(std::make_unique<bool[]>(num_frames)) {
+  // A frame that holds no page cannot be pinned.
+  for (size_t i = 0; i < num_frames; ++i) {
+    pages_[i].data_ = arena_.GetFrameData(i);
+    pages_[i].pin_count_ = -1;
+  }
+}
+
+bool BufferPoolManagerInstance::Resize(size_t pool_size) {
+  size_t num_chunks = (pool_size + chunk_size_ - 1) / chunk_size_;
+  if (num_chunks == 0 || num_chunks > BUFFER_POOL_MAX_CHUNKS) {
+    return false;
+  }
+  std::unique_lock bpm_lk{latch_};
+  size_t num_active_chunks = num_active_chunks_;
+  if (num_chunks > num_active_chunks) {
+    for (size_t chunk_index = num_active_chunks; chunk_index < num_chunks; ++chunk_index) {
+      AddChunk(chunk_index);
+    }
+  } else if (num_chunks < num_active_chunks) {
+    // Stop handing out frames from the chunks that go, then retire every one of their frames that nobody has pinned.
+    // Pinned frames are retired when they are unpinned.
+    num_active_chunks_ = num_chunks;
+    free_list_.remove_if([this](frame_id_t frame_id) { return IsRetiring(frame_id); });
+    std::vector<frame_id_t> frame_ids;
+    for (size_t chunk_index = num_chunks; chunk_index < num_active_chunks; ++chunk_index) {
+      for (size_t i = 0; i < chunk_size_; ++i) {
+        auto frame_id = static_cast<frame_id_t>(chunk_index * chunk_size_ + i);
+        if (ClaimFrame(GetFrame(frame_id))) {
+          frame_ids.push_back(frame_id);
+        }
+      }
+    }
+    RetireFrames(frame_ids, &bpm_lk);
+    ReleaseRetiredChunks();
+  }
+  // Another resize may have come in while the dirty pages were written back.
+  pool_size_ = num_active_chunks_ * chunk_size_;
+  ResetScanRing();
+  return true;
+}
+
+void BufferPoolManagerInstance::PrefetchPage(page_id_t page_id, AccessType access_type) {
+  prefetcher_->PrefetchPage(page_id, access_type);
+}
+
+void BufferPoolManagerInstance::PrefetchRange(page_id_t first_page_id, size_t num_pages, AccessType access_type) {
+  prefetcher_->PrefetchRange(first_page_id, num_pages, access_type);
+}
+
+void BufferPoolManagerInstance::PrefetchChain(page_id_t page_id, size_t depth, next_page_fn next_page,
+                                              AccessType access_type) {
+  prefetcher_->PrefetchChain(page_id, depth, std::move(next_page), access_type);
+}
+
+Page *BufferPoolManagerInstance::FetchPageImpl(page_id_t page_id, AccessType access_type) {
+  // 0.     Hits do not need the latch.
+  Page *page = FetchResidentPage(page_id, access_type);
+  if (page != nullptr) {
+    return page;
+  }
+
+  std::unique_lock bpm_lk{latch_};
+  PendingRead read;
+  page = PinOrMapPage(page_id, access_type, &bpm_lk, &read);
+  if (page != nullptr && read.frame_id_ != -1) {
+    std::vector<PendingRead> reads{read};
+    std::exception_ptr error = CompleteReads(&reads, &bpm_lk);
+    if (page->page_id_ != page_id) {
+      bpm_lk.unlock();
+      ReleasePin(read.frame_id_);
+      if (error != nullptr) {
+        std::rethrow_exception(error);
+      }
+      throw Exception(ExceptionType::CORRUPTION, "page " + std::to_string(page_id) + " does not match its checksum");
+    }
+  }
+  return page;
+}
+
+std::vector<Page *> BufferPoolManagerInstance::FetchPages(const std::vector<page_id_t> &page_ids,
+                                                          AccessType access_type) {
+  // Resolve the hits first, without the latch.
+  std::vector<Page *> pages(page_ids.size(), nullptr);
+  std::vector<std::pair<page_id_t, size_t>> misses;
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    pages[i] = FetchResidentPage(page_ids[i], access_type);
+    if (pages[i] == nullptr) {
+      misses.emplace_back(page_ids[i], i);
+    }
+  }
+  if (misses.empty()) {
+    return pages;
+  }
+
+  // Map every miss to a frame under one acquisition of the latch, then read them all at once in page id order.
+  std::sort(misses.begin(), misses.end());
+  std::vector<PendingRead> reads;
+  std::vector<frame_id_t> corrupt_frames;
+  std::exception_ptr error;
+  std::unique_lock bpm_lk{latch_};
+  for (size_t i = 0; i < misses.size(); ++i) {
+    page_id_t page_id = misses[i].first;
+    if (i > 0 && page_id == misses[i - 1].first) {
+      // The same page asked for twice: pin it once more.
+      Page *page = pages[misses[i - 1].second];
+      if (page != nullptr) {
+        page->pin_count_++;
+        pages[misses[i].second] = page;
+        CountFetch(page_id, true);
+      }
+      continue;
+    }
+    // Waiting on another thread's I/O while holding frames whose I/O has not started could deadlock, e.g. if the page
+    // is the dirty victim of one of them. Finish those first.
+    if (!reads.empty() && MustWaitForIO(page_id)) {
+      std::exception_ptr read_error = CompleteReads(&reads, &bpm_lk, &corrupt_frames);
+      error = error != nullptr ? error : read_error;
+    }
+    PendingRead read;
+    pages[misses[i].second] = PinOrMapPage(page_id, access_type, &bpm_lk, &read);
+    if (pages[misses[i].second] != nullptr && read.frame_id_ != -1) {
+      reads.push_back(read);
+    }
+  }
+  if (!reads.empty()) {
+    std::exception_ptr read_error = CompleteReads(&reads, &bpm_lk, &corrupt_frames);
+    error = error != nullptr ? error : read_error;
+  }
+  if (corrupt_frames.empty()) {
+    return pages;
+  }
+
+  // Give up the whole batch. A corrupt page may have been asked for more than once, and holds a pin for each time.
+  bpm_lk.unlock();
+  for (size_t i = 0; i < pages.size(); ++i) {
+    if (pages[i] == nullptr) {
+      continue;
+    }
+    if (pages[i]->page_id_ == page_ids[i]) {
+      UnpinPageImpl(page_ids[i], false);
+      continue;
+    }
+    for (frame_id_t frame_id : corrupt_frames) {
+      if (GetFrame(frame_id) == pages[i]) {
+        ReleasePin(frame_id);
+        break;
+      }
+    }
+  }
+  if (error != nullptr) {
+    std::rethrow_exception(error);
+  }
+  throw Exception(ExceptionType::CORRUPTION, std::to_string(corrupt_frames.size()) +
+                                                 " pages of a batch do not match their checksums");
+}
+
+Page *BufferPoolManagerInstance::FetchResidentPage(page_id_t page_id, AccessType access_type) {
+  // Look P up, pin its frame and check that the frame still holds P.
+  frame_id_t frame_id = -1;
+  LookupStripe *stripe = EnterLookup();
+  // A stale entry may point into a chunk that has just been retired and taken out of the directory.
+  Page *page = page_table_.Find(page_id, &frame_id) ? FindFrame(frame_id) : nullptr;
+  if (page != nullptr) {
+    if (TryPin(page)) {
+      if (page->page_id_ == page_id) {
+        replacer_->Pin(frame_id);
+        replacer_->RecordAccess(frame_id, access_type);
+        ExitLookup(stripe);
+        CountFetch(page_id, true);
+        if (IOInProgress(frame_id)) {
+          std::unique_lock bpm_lk{latch_};
+          WaitForIO(&bpm_lk, frame_id);
+          if (page->page_id_ != page_id) {
+            // The read failed its checksum. Go and read the page again, to be told so.
+            bpm_lk.unlock();
+            ReleasePin(frame_id);
+            return nullptr;
+          }
+        }
+        return page;
+      }
+      // The frame was handed to another page between the lookup and the pin.
+      UnpinFrame(frame_id, page);
+    }
+  }
+  ExitLookup(stripe);
+  return nullptr;
+}
+
+bool BufferPoolManagerInstance::MustWaitForIO(page_id_t page_id) {
+  frame_id_t frame_id;
+  if (page_table_.Find(page_id, &frame_id)) {
+    return IOInProgress(frame_id);
+  }
+  return evicting_pages_.count(page_id) > 0;
+}
+
+Page *BufferPoolManagerInstance::PinOrMapPage(page_id_t page_id, AccessType access_type,
+                                              std::unique_lock<TimedMutex> *lock, PendingRead *read) {
+  read->frame_id_ = -1;
+  frame_id_t frame_id = -1;
+  // 1.     Search the page table for the requested page (P).
+  // 1.1    If P exists, pin it and return it immediately. If another thread is still reading P in, wait for it.
+  while (true) {
+    if (page_table_.Find(page_id, &frame_id)) {
+      Page *page = GetFrame(frame_id);
+      page->pin_count_++;
+      replacer_->Pin(frame_id);
+      replacer_->RecordAccess(frame_id, access_type);
+      CountFetch(page_id, true);
+      WaitForIO(lock, frame_id);
+      if (page->page_id_ == page_id) {
+        return page;
+      }
+      // The read failed its checksum and the page is gone from the table. Look again, and read it ourselves.
+      lock->unlock();
+      ReleasePin(frame_id);
+      lock->lock();
+      continue;
+    }
+    // P may be the dirty victim of a frame that is being reused. Reading it back before its write-back lands would
+    // return stale data, so wait on that frame and look again.
+    auto evicting = evicting_pages_.find(page_id);
+    if (evicting == evicting_pages_.end()) {
+      break;
+    }
+    WaitForIO(lock, evicting->second);
+  }
+
+  // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
+  //        Note that pages are always found from the free list first. Scans recycle their own ring of frames.
+  bool found = access_type == AccessType::Scan ? FindScanFrame(&frame_id) : FindFreeFrame(&frame_id);
+  if (!found) {
+    return nullptr;
+  }
+  Page *page = GetFrame(frame_id);
+  page_id_t victim_page_id = page->page_id_;
+  bool write_back = page->is_dirty_;
+
+  // 3.     Delete R from the page table and insert P. P is pinned and marked as having I/O in progress, so nobody
+  //        touches the frame until the read in CompleteReads has completed. A lookup that pins the frame without the
+  //        latch sees the I/O flag set before the pin count becomes valid again.
+  CountVictim(victim_page_id, write_back);
+  page_table_.Erase(victim_page_id);
+  if (write_back) {
+    evicting_pages_[victim_page_id] = frame_id;
+  }
+  IOInProgress(frame_id) = true;
+  page->page_id_ = page_id;
+  page->is_dirty_ = false;
+  page->pin_count_ = 1;
+  page_table_.Insert(page_id, frame_id);
+  replacer_->RecordAccess(frame_id, access_type);
+  CountFetch(page_id, false);
+  *read = {page_id, frame_id, victim_page_id, write_back};
+  return page;
+}
+
+std::exception_ptr BufferPoolManagerInstance::CompleteReads(std::vector<PendingRead> *reads,
+                                                            std::unique_lock<TimedMutex> *lock,
+                                                            std::vector<frame_id_t> *corrupt_frames) {
+  lock->unlock();
+
+  // 2.     If R is dirty, write it back to the disk.
+  std::vector<page_id_t> victim_page_ids;
+  std::vector<const char *> victim_data;
+  std::vector<page_id_t> page_ids;
+  std::vector<char *> page_data;
+  for (const auto &read : *reads) {
+    Page *page = GetFrame(read.frame_id_);
+    if (read.write_back_) {
+      victim_page_ids.push_back(read.victim_page_id_);
+      victim_data.push_back(page->GetData());
+    }
+    page_ids.push_back(read.page_id_);
+    page_data.push_back(page->data_);
+  }
+  std::exception_ptr error;
+  try {
+    WritePages(victim_page_ids, victim_data);
+  } catch (...) {
+    error = std::current_exception();
+  }
+  // If the victims could not be written back, they are still in their frames, and nothing is read over them.
+  bool victims_written = error == nullptr;
+
+  // 4.     Read in the page contents from disk.
+  std::vector<bool> corrupt(reads->size(), false);
+  if (victims_written) {
+    try {
+      if (reads->size() == 1) {
+        GetFrame(reads->front().frame_id_)->ResetMemory();
+        disk_manager_->ReadPage(page_ids.front(), page_data.front());
+      } else {
+        ReadPages(page_ids, page_data);
+      }
+    } catch (const Exception &e) {
+      if (e.GetType() == ExceptionType::CORRUPTION) {
+        for (size_t i = 0; i < reads->size(); ++i) {
+          corrupt[i] = !disk_manager_->VerifyPage(page_ids[i], page_data[i]);
+        }
+      } else {
+        error = std::current_exception();
+      }
+    } catch (...) {
+      error = std::current_exception();
+    }
+  }
+  if (error != nullptr) {
+    // Which pages made it in is unknown, so none of them did.
+    corrupt.assign(reads->size(), true);
+  }
+
+  lock->lock();
+  for (size_t i = 0; i < reads->size(); ++i) {
+    const auto &read = (*reads)[i];
+    if (read.write_back_) {
+      evicting_pages_.erase(read.victim_page_id_);
+    }
+    if (corrupt[i]) {
+      // Unmap the page. The frame stays pinned, out of everybody's way, until the last pin on it is given back.
+      Page *page = GetFrame(read.frame_id_);
+      page_table_.Erase(read.page_id_);
+      if (!victims_written && read.write_back_) {
+        // The victim takes its frame back, still dirty, and can be evicted again once the pins are given back.
+        page->page_id_ = read.victim_page_id_;
+        page->is_dirty_ = true;
+        page_table_.Insert(read.victim_page_id_, read.frame_id_);
+      } else {
+        page->ResetMemory();
+        page->page_id_ = INVALID_PAGE_ID;
+      }
+      if (corrupt_frames != nullptr) {
+        corrupt_frames->push_back(read.frame_id_);
+      }
+    }
+    FinishIO(read.frame_id_);
+  }
+  reads->clear();
+  return error;
+}
+
+void BufferPoolManagerInstance::ReleasePin(frame_id_t frame_id) {
+  if (UnpinFrame(frame_id) && IsRetiring(frame_id)) {
+    DrainFrame(frame_id);
+  }
+}
+
+void BufferPoolManagerInstance::ReadPages(const std::vector<page_id_t> &page_ids,
+                                          const std::vector<char *> &page_data) {
+  if (async_disk_manager_ != nullptr) {
+    // Any failure leaves the buffers unfilled, so it is passed on for CompleteReads to fail the batch.
+    async_disk_manager_->ReadPagesAsync(page_ids, page_data).get();
+    return;
+  }
+  disk_manager_->ReadPages(page_ids, page_data);
+}
+
+void BufferPoolManagerInstance::WritePages(const std::vector<page_id_t> &page_ids,
+                                           const std::vector<const char *> &page_data) {
+  if (async_disk_manager_ != nullptr) {
+    async_disk_manager_->WritePagesAsync(page_ids, page_data).get();
+    return;
+  }
+  disk_manager_->WritePages(page_ids, page_data);
+}
+
+bool BufferPoolManagerInstance::UnpinPageImpl(page_id_t page_id, bool is_dirty) {
+  // The caller's pin keeps the page in its frame, so this does not need the latch either.
+  frame_id_t frame_id;
+  LookupStripe *stripe = EnterLookup();
+  // A stale entry may point into a chunk that has just been taken out of the directory, as in FetchResidentPage.
+  Page *page = page_table_.Find(page_id, &frame_id) ? FindFrame(frame_id) : nullptr;
+  if (page == nullptr || page->page_id_ != page_id || page->pin_count_ <= 0) {
+    ExitLookup(stripe);
+    return false;
+  }
+  // Mark the page dirty before giving up the pin; whoever evicts the page next claims the frame after that.
+  if (is_dirty) {
+    page->is_dirty_ = true;
+  }
+  bool unpinned = UnpinFrame(frame_id, page);
+  ExitLookup(stripe);
+  if (unpinned && IsRetiring(frame_id)) {
+    DrainFrame(frame_id);
+  }
+  return unpinned;
+}
+
+bool BufferPoolManagerInstance::FlushPageImpl(page_id_t page_id) {
+  // Make sure you call DiskManager::WritePage!
+  std::unique_lock bpm_lk{latch_};
+  frame_id_t frame_id;
+  while (true) {
+    if (!page_table_.Find(page_id, &frame_id)) {
+      return false;
+    }
+    if (!IOInProgress(frame_id)) {
+      break;
+    }
+    // The frame holds somebody else's bytes until its I/O completes, and may even be reused afterwards.
+    WaitForIO(&bpm_lk, frame_id);
+  }
+  // Pin the page so that it stays in its frame while it is written without the latch, as in FlushAllPagesImpl. With
+  // double-write the write syncs the disk twice. The dirty flag is cleared first, so that a change made during the
+  // write marks the page again.
+  Page *page = GetFrame(frame_id);
+  if (!TryPin(page)) {
+    return false;
+  }
+  page->is_dirty_ = false;
+  bpm_lk.unlock();
+  try {
+    WritePages({page_id}, {page->GetData()});
+  } catch (...) {
+    page->is_dirty_ = true;
+    ReleasePin(frame_id);
+    throw;
+  }
+  ReleasePin(frame_id);
+  return true;
+}
+
+Page *BufferPoolManagerInstance::NewPageImpl(page_id_t *page_id, tablespace_id_t tablespace, page_id_t near_page_id) {
+  // 0.   Make sure you call AllocatePage!
+  std::unique_lock bpm_lk{latch_};
+  // 1.   If all the pages in the buffer pool are pinned, return nullptr.
+  if (free_list_.empty() && replacer_->Size() == 0) {
+    return nullptr;
+  }
+  //      Allocate the page before taking a frame: allocating throws if the tablespace is gone or full, and a frame
+  //      that was taken would be left claimed, with its victim still mapped to it. Allocating may write the free-space
+  //      map and grow the file, so it happens without the latch; the disk manager serializes allocations itself.
+  bpm_lk.unlock();
+  page_id_t new_page_id = AllocatePage(tablespace, near_page_id);
+  bpm_lk.lock();
+  // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
+  frame_id_t frame_id = -1;
+  if (!FindFreeFrame(&frame_id)) {
+    bpm_lk.unlock();
+    disk_manager_->DeallocatePage(new_page_id);
+    return nullptr;
+  }
+  Page *page = GetFrame(frame_id);
+  page_id_t victim_page_id = page->page_id_;
+  bool write_back = page->is_dirty_;
+
+  // 3.   Update P's metadata and add P to the page table.
+  CountVictim(victim_page_id, write_back);
+  page_table_.Erase(victim_page_id);
+  if (write_back) {
+    evicting_pages_[victim_page_id] = frame_id;
+    IOInProgress(frame_id) = true;
+  }
+  page->page_id_ = new_page_id;
+  page->is_dirty_ = true;
+  page->pin_count_ = 1;
+  page_table_.Insert(new_page_id, frame_id);
+  replacer_->RecordAccess(frame_id);
+
+  //      Write back the old contents without holding the latch, then zero out memory.
+  if (write_back) {
+    bpm_lk.unlock();
+    try {
+      WritePages({victim_page_id}, {page->GetData()});
+    } catch (...) {
+      // Give the new page up again. The victim takes its frame back, still dirty, and is unpinned.
+      bpm_lk.lock();
+      evicting_pages_.erase(victim_page_id);
+      page_table_.Erase(new_page_id);
+      page->page_id_ = victim_page_id;
+      page_table_.Insert(victim_page_id, frame_id);
+      FinishIO(frame_id);
+      bpm_lk.unlock();
+      ReleasePin(frame_id);
+      disk_manager_->DeallocatePage(new_page_id);
+      throw;
+    }
+    page->ResetMemory();
+    bpm_lk.lock();
+    evicting_pages_.erase(victim_page_id);
+    FinishIO(frame_id);
+  } else {
+    page->ResetMemory();
+  }
+
+  // 4.   Set the page ID output parameter. Return a pointer to P.
+  *page_id = new_page_id;
+  return page;
+}
+
+bool BufferPoolManagerInstance::DeletePageImpl(page_id_t page_id) {
+  // 0.   Make sure you call DiskManager::DeallocatePage! It may shrink the file, so it is called without the latch.
+  std::unique_lock bpm_lk{latch_};
+  // 1.   Search the page table for the requested page (P).
+  // 1.   If P does not exist, return true.
+  frame_id_t frame_id;
+  if (!page_table_.Find(page_id, &frame_id)) {
+    bpm_lk.unlock();
+    disk_manager_->DeallocatePage(page_id);
+    return true;
+  }
+  Page *page = GetFrame(frame_id);
+
+  // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
+  if (!ClaimFrame(page)) {
+    return false;
+  }
+
+  // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
+  //      The page is going away, so there is no point in writing it back even if it is dirty.
+  page_table_.Erase(page_id);
+  replacer_->Remove(frame_id);
+  page->ResetMemory();
+  page->page_id_ = INVALID_PAGE_ID;
+  page->is_dirty_ = false;
+  InScanRing(frame_id) = false;
+  if (IsRetiring(frame_id)) {
+    ReleaseRetiredChunks();
+  } else {
+    free_list_.push_back(frame_id);
+  }
+  bpm_lk.unlock();
+  disk_manager_->DeallocatePage(page_id);
+  return true;
+}
+
+bool BufferPoolManagerInstance::DropTablespace(tablespace_id_t tablespace) {
+  if (!ClaimTablespace(tablespace)) {
+    ReleaseTablespace();
+    return false;
+  }
+  DiscardTablespace();
+  disk_manager_->DropTablespace(tablespace);
+  return true;
+}
+
+bool BufferPoolManagerInstance::ClaimTablespace(tablespace_id_t tablespace) {
+  tablespace_lock_ = std::unique_lock{latch_};
+  // A write-back of one of its pages that is still under way would land in the file after it is gone.
+  auto evicting = evicting_pages_.begin();
+  while (evicting != evicting_pages_.end()) {
+    if (GetTablespace(evicting->first) == tablespace) {
+      WaitForIO(&tablespace_lock_, evicting->second);
+      evicting = evicting_pages_.begin();
+    } else {
+      ++evicting;
+    }
+  }
+  std::vector<frame_id_t> frames;
+  page_table_.ForEach([&](page_id_t page_id, frame_id_t frame_id) {
+    if (GetTablespace(page_id) == tablespace) {
+      frames.push_back(frame_id);
+    }
+  });
+  for (frame_id_t frame_id : frames) {
+    // Pinned pages, which includes pages with I/O in progress, are still in use.
+    if (!ClaimFrame(GetFrame(frame_id))) {
+      return false;
+    }
+    claimed_frames_.push_back(frame_id);
+  }
+  return true;
+}
+
+void BufferPoolManagerInstance::ReleaseTablespace() {
+  // Nobody can have pinned a claimed frame, and the replacer still holds it.
+  for (frame_id_t frame_id : claimed_frames_) {
+    GetFrame(frame_id)->pin_count_ = 0;
+  }
+  claimed_frames_.clear();
+  tablespace_lock_.unlock();
+}
+
+void BufferPoolManagerInstance::DiscardTablespace() {
+  for (frame_id_t frame_id : claimed_frames_) {
+    // As in DeletePageImpl, except that the page is not deallocated: the whole tablespace is about to go.
+    Page *page = GetFrame(frame_id);
+    page_table_.Erase(page->page_id_);
+    replacer_->Remove(frame_id);
+    page->ResetMemory();
+    page->page_id_ = INVALID_PAGE_ID;
+    page->is_dirty_ = false;
+    InScanRing(frame_id) = false;
+    if (IsRetiring(frame_id)) {
+      ReleaseRetiredChunks();
+    } else {
+      free_list_.push_back(frame_id);
+    }
+  }
+  claimed_frames_.clear();
+  tablespace_lock_.unlock();
+}
+
+void BufferPoolManagerInstance::FlushAllPagesImpl() {
+  std::vector<page_id_t> page_ids;
+  std::vector<const char *> page_data;
+  std::vector<frame_id_t> frame_ids;
+  std::vector<frame_id_t> dirty_frame_ids;
+  {
+    std::scoped_lock bpm_slk{latch_};
+    page_table_.ForEach([&](page_id_t page_id, frame_id_t frame_id) {
+      // Frames with I/O in progress are either being read in (so already on disk) or are brand new pages that are
+      // still dirty; either way their bytes are not ready to be written yet.
+      if (IOInProgress(frame_id)) {
+        return;
+      }
+      // Pin the page so that it stays in its frame while it is written without the latch, as the background writer
+      // does.
+      Page *page = GetFrame(frame_id);
+      if (!TryPin(page)) {
+        return;
+      }
+      page_ids.push_back(page_id);
+      page_data.push_back(page->GetData());
+      frame_ids.push_back(frame_id);
+      // Cleared before the write, so that a change made during the write marks the page again.
+      if (page->is_dirty_.exchange(false)) {
+        dirty_frame_ids.push_back(frame_id);
+      }
+    });
+  }
+  // One batch, so that a double-write disk manager journals the pages together. With double-write it syncs the
+  // disk, which is why the latch is not held.
+  auto release_pins = [&] {
+    for (frame_id_t frame_id : frame_ids) {
+      ReleasePin(frame_id);
+    }
+  };
+  try {
+    WritePages(page_ids, page_data);
+  } catch (...) {
+    // Which pages made it out is unknown, so none of them did. A page left clean would be dropped on eviction.
+    for (frame_id_t frame_id : dirty_frame_ids) {
+      GetFrame(frame_id)->is_dirty_ = true;
+    }
+    release_pins();
+    throw;
+  }
+  release_pins();
+}
+
+page_id_t BufferPoolManagerInstance::AllocatePage(tablespace_id_t tablespace, page_id_t near_page_id) {
+  // Every instance keeps to its own page ids, so that they mod back to its instance_index_.
+  return disk_manager_->AllocatePage(num_instances_, instance_index_, tablespace, near_page_id);
+}
+
+bool BufferPoolManagerInstance::FindFreeFrame(frame_id_t *frame_id) {
+  if (!free_list_.empty()) {
+    *frame_id = free_list_.front();
+    free_list_.pop_front();
+  } else {
+    // Dirty frames of retiring chunks that are passed over go back to the replacer once a frame has been found.
+    std::vector<frame_id_t> passed_over;
+    bool found = false;
+    while (!found) {
+      if (!replacer_->Victim(frame_id)) {
+        break;
+      }
+      // A frame of a chunk that is already gone may linger in the replacer if it was unpinned as it was retired.
+      if (GetChunk(*frame_id) == nullptr) {
+        continue;
+      }
+      // The background writer pins the pages it writes without taking them out of the replacer, and lookups that
+      // bypass the latch may have pinned the frame since it was unpinned. Whoever holds the pin puts the frame back.
+      if (!ClaimFrame(GetFrame(*frame_id))) {
+        continue;
+      }
+      if (!IsRetiring(*frame_id)) {
+        found = true;
+        continue;
+      }
+      // The frame belongs to a chunk the pool is shrinking away. A dirty page has to be written back first, which is
+      // not done under the latch; that is left to whoever unpinned the frame, or to a later try if it failed before.
+      Page *page = GetFrame(*frame_id);
+      if (page->is_dirty_) {
+        page->pin_count_ = 0;
+        passed_over.push_back(*frame_id);
+        continue;
+      }
+      RetireFrame(*frame_id);
+      ReleaseRetiredChunks();
+    }
+    for (frame_id_t passed_over_frame_id : passed_over) {
+      replacer_->Unpin(passed_over_frame_id);
+    }
+    if (!found) {
+      return false;
+    }
+  }
+  // Whoever takes the frame now owns it, even if it used to be part of the scan ring.
+  InScanRing(*frame_id) = false;
+  return true;
+}
+
+bool BufferPoolManagerInstance::FindScanFrame(frame_id_t *frame_id) {
+  if (scan_ring_.size() < scan_ring_size_) {
+    if (!FindFreeFrame(frame_id)) {
+      return false;
+    }
+    scan_ring_.push_back(*frame_id);
+    InScanRing(*frame_id) = true;
+    return true;
+  }
+
+  frame_id_t &slot = scan_ring_[scan_ring_next_];
+  scan_ring_next_ = (scan_ring_next_ + 1) % scan_ring_.size();
+  if (InScanRing(slot) && ClaimFrame(GetFrame(slot))) {
+    replacer_->Remove(slot);
+    *frame_id = slot;
+    return true;
+  }
+  // The frame is still pinned by someone, or was evicted and now holds another page. Replace it in the ring.
+  if (!FindFreeFrame(frame_id)) {
+    return false;
+  }
+  slot = *frame_id;
+  InScanRing(*frame_id) = true;
+  return true;
+}
+
+void BufferPoolManagerInstance::AddChunk(size_t chunk_index) {
+  FrameChunk *chunk = chunks_[chunk_index];
+  if (chunk == nullptr) {
+    chunk = new FrameChunk(chunk_size_);
+    chunks_[chunk_index] = chunk;
+  }
+  // A chunk that was still draining keeps the pages it holds; its retired frames become free again.
+  for (size_t i = 0; i < chunk_size_; ++i) {
+    Page *page = &chunk->pages_[i];
+    if (page->page_id_ == INVALID_PAGE_ID && page->pin_count_ == -1) {
+      free_list_.emplace_back(static_cast<frame_id_t>(chunk_index * chunk_size_ + i));
+    }
+  }
+  num_active_chunks_ = std::max<size_t>(num_active_chunks_, chunk_index + 1);
+  replacer_->SetNumFrames(FrameLimit());
+}
+
+size_t BufferPoolManagerInstance::FrameLimit() const {
+  size_t num_chunks = BUFFER_POOL_MAX_CHUNKS;
+  while (num_chunks > 0 && chunks_[num_chunks - 1] == nullptr) {
+    num_chunks--;
+  }
+  return num_chunks * chunk_size_;
+}
+
+void BufferPoolManagerInstance::RetireFrame(frame_id_t frame_id) {
+  Page *page = GetFrame(frame_id);
+  page_id_t page_id = page->page_id_;
+  if (page_id != INVALID_PAGE_ID) {
+    page_table_.Erase(page_id);
+  }
+  replacer_->Remove(frame_id);
+  page->page_id_ = INVALID_PAGE_ID;
+  page->is_dirty_ = false;
+  InScanRing(frame_id) = false;
+}
+
+void BufferPoolManagerInstance::RetireFrames(const std::vector<frame_id_t> &frame_ids,
+                                             std::unique_lock<TimedMutex> *lock) {
+  // Dirty pages are written back like dirty victims: they leave the page table for evicting_pages_, so that whoever
+  // wants one of them waits for its write-back, and the latch is released for the write.
+  std::vector<frame_id_t> dirty_frame_ids;
+  std::vector<page_id_t> page_ids;
+  std::vector<const char *> page_data;
+  for (frame_id_t frame_id : frame_ids) {
+    Page *page = GetFrame(frame_id);
+    if (page->page_id_ == INVALID_PAGE_ID || !page->is_dirty_) {
+      RetireFrame(frame_id);
+      continue;
+    }
+    page_table_.Erase(page->page_id_);
+    evicting_pages_[page->page_id_] = frame_id;
+    IOInProgress(frame_id) = true;
+    dirty_frame_ids.push_back(frame_id);
+    page_ids.push_back(page->page_id_);
+    page_data.push_back(page->GetData());
+  }
+  if (dirty_frame_ids.empty()) {
+    return;
+  }
+
+  lock->unlock();
+  bool written = true;
+  try {
+    WritePages(page_ids, page_data);
+  } catch (const Exception &e) {
+    LOG_DEBUG("write-back of %zu retiring pages failed: %s", page_ids.size(), e.what());
+    written = false;
+  }
+  lock->lock();
+
+  for (size_t i = 0; i < dirty_frame_ids.size(); ++i) {
+    frame_id_t frame_id = dirty_frame_ids[i];
+    Page *page = GetFrame(frame_id);
+    evicting_pages_.erase(page_ids[i]);
+    if (written) {
+      page->is_dirty_ = false;
+      RetireFrame(frame_id);
+      // A resize may have brought the chunk back in the meantime; then the frame is simply free.
+      if (!IsRetiring(frame_id)) {
+        free_list_.push_back(frame_id);
+      }
+    } else {
+      // The page stays in its frame, dirty and unpinned, until it can be written back.
+      page_table_.Insert(page_ids[i], frame_id);
+      page->pin_count_ = 0;
+      replacer_->Unpin(frame_id);
+    }
+    FinishIO(frame_id);
+  }
+}
+
+void BufferPoolManagerInstance::DrainFrame(frame_id_t frame_id) {
+  std::unique_lock bpm_lk{latch_};
+  // The chunk may have been drained and freed by whoever retired the frame first.
+  if (IsRetiring(frame_id) && GetChunk(frame_id) != nullptr && ClaimFrame(GetFrame(frame_id))) {
+    RetireFrames({frame_id}, &bpm_lk);
+    ReleaseRetiredChunks();
+  }
+}
+
+void BufferPoolManagerInstance::ReleaseRetiredChunks() {
+  bool released = false;
+  for (size_t chunk_index = num_active_chunks_; chunk_index < BUFFER_POOL_MAX_CHUNKS; ++chunk_index) {
+    FrameChunk *chunk = chunks_[chunk_index];
+    if (chunk == nullptr) {
+      continue;
+    }
+    bool drained = true;
+    for (size_t i = 0; i < chunk_size_ && drained; ++i) {
+      drained = chunk->pages_[i].page_id_ == INVALID_PAGE_ID && chunk->pages_[i].pin_count_ == -1;
+    }
+    if (!drained) {
+      continue;
+    }
+    // Lookups that bypass the latch may still be looking at frames of the chunk; wait them out before freeing it.
+    chunks_[chunk_index] = nullptr;
+    if (!released) {
+      WaitForLookups();
+      released = true;
+    }
+    delete chunk;
+  }
+  if (released) {
+    // the frames of the freed chunks were all removed from the replacer as they were retired
+    replacer_->SetNumFrames(FrameLimit());
+  }
+}
+
+void BufferPoolManagerInstance::ResetScanRing() {
+  // Scans get an eighth of the pool, but unless the pool is tiny at least enough to hold the current page, the pages
+  // prefetched ahead of it and one more.
+  size_t pool_size = pool_size_;
+  size_t min_scan_ring_size = std::max<size_t>(1, std::min<size_t>(SCAN_PREFETCH_DEPTH + 2, pool_size / 2));
+  scan_ring_size_ = std::clamp<size_t>(pool_size / 8, min_scan_ring_size, SCAN_RING_SIZE);
+  for (frame_id_t frame_id : scan_ring_) {
+    if (chunks_[frame_id / chunk_size_] != nullptr) {
+      InScanRing(frame_id) = false;
+    }
+  }
+  scan_ring_.clear();
+  scan_ring_.reserve(scan_ring_size_);
+  scan_ring_next_ = 0;
+}
+
+BufferPoolManagerInstance::LookupStripe *BufferPoolManagerInstance::EnterLookup() {
+  // Threads are spread over the stripes once and for all, so that each mostly counts on a cache line of its own.
+  static std::atomic<size_t> next_stripe{0};
+  thread_local size_t stripe_index = next_stripe++ % NUM_LOOKUP_STRIPES;
+  LookupStripe *stripe = &lookup_stripes_[stripe_index];
+  stripe->entered_.fetch_add(1, std::memory_order_acq_rel);
+  return stripe;
+}
+
+void BufferPoolManagerInstance::ExitLookup(LookupStripe *stripe) {
+  stripe->exited_.fetch_add(1, std::memory_order_release);
+}
+
+void BufferPoolManagerInstance::WaitForLookups() {
+  for (size_t i = 0; i < NUM_LOOKUP_STRIPES; ++i) {
+    LookupStripe *stripe = &lookup_stripes_[i];
+    while (true) {
+      // Read exits before entries: if they match, nobody was inside in between. The read-modify-write makes every
+      // later lookup on this stripe see what was done before this call.
+      uint64_t exited = stripe->exited_.load(std::memory_order_acquire);
+      uint64_t entered = stripe->entered_.fetch_add(0, std::memory_order_acq_rel);
+      if (entered == exited) {
+        break;
+      }
+      std::this_thread::yield();
+    }
+  }
+}
+
+bool BufferPoolManagerInstance::TryPin(Page *page) {
+  int pin_count = page->pin_count_;
+  while (pin_count >= 0) {
+    if (page->pin_count_.compare_exchange_weak(pin_count, pin_count + 1)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool BufferPoolManagerInstance::ClaimFrame(Page *page) {
+  int unpinned = 0;
+  return page->pin_count_.compare_exchange_strong(unpinned, -1);
+}
+
+bool BufferPoolManagerInstance::UnpinFrame(frame_id_t frame_id, Page *page) {
+  int pin_count = page->pin_count_;
+  do {
+    if (pin_count <= 0) {
+      return false;
+    }
+  } while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count - 1));
+  if (pin_count == 1) {
+    // If the frame is pinned or claimed again before this lands, the replacer hands it out as a victim once more and
+    // the claim in FindFreeFrame turns it down.
+    replacer_->Unpin(frame_id);
+  }
+  return true;
+}
+
+void BufferPoolManagerInstance::WaitForIO(std::unique_lock<TimedMutex> *lock, frame_id_t frame_id) {
+  if (IOInProgress(frame_id)) {
+    counters_.Add(BufferPoolCounter::PIN_WAITS);
+  }
+  IODone(frame_id).wait(*lock, [&] { return !IOInProgress(frame_id); });
+}
+
+void BufferPoolManagerInstance::FinishIO(frame_id_t frame_id) {
+  IOInProgress(frame_id) = false;
+  IODone(frame_id).notify_all();
+}
+
+void BufferPoolManagerInstance::CountVictim(page_id_t victim_page_id, bool dirty) {
+  if (victim_page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  if (dirty) {
+    counters_.Add(BufferPoolCounter::DIRTY_EVICTIONS);
+    bgwriter_wakeup_ = true;
+    bgwriter_cv_.notify_one();
+  } else {
+    counters_.Add(BufferPoolCounter::CLEAN_EVICTIONS);
+  }
+}
+
+BufferPoolStats BufferPoolManagerInstance::GetStats(size_t num_hot_pages) {
+  BufferPoolStats stats;
+  counters_.Snapshot(&stats);
+  stats.hot_pages_ = page_heat_.GetHottest(num_hot_pages);
+  return stats;
+}
+
+void BufferPoolManagerInstance::SetPageHeatSampling(size_t sample_rate) { page_heat_.SetSampleRate(sample_rate); }
+
+bool BufferPoolManagerInstance::SaveHotSet(const std::string &file_name) {
+  return WriteHotSetFile(file_name, GetHotSet());
+}
+
+size_t BufferPoolManagerInstance::LoadHotSet(const std::string &file_name) {
+  std::vector<page_id_t> page_ids;
+  if (!ReadHotSetFile(file_name, &page_ids)) {
+    return 0;
+  }
+  return WarmUp(page_ids);
+}
+
+void BufferPoolManagerInstance::SetHotSetFile(const std::string &file_name) {
+  std::scoped_lock bgwriter_lk{bgwriter_latch_};
+  hot_set_file_ = file_name;
+}
+
+std::vector<page_id_t> BufferPoolManagerInstance::GetHotSet() {
+  std::vector<page_id_t> page_ids;
+  std::unordered_set<page_id_t> seen;
+  std::scoped_lock bpm_slk{latch_};
+  page_table_.ForEach([&](page_id_t page_id, frame_id_t frame_id) {
+    if (GetFrame(frame_id)->pin_count_ > 0 && seen.insert(page_id).second) {
+      page_ids.push_back(page_id);
+    }
+  });
+  for (frame_id_t frame_id : replacer_->GetRecencyOrder()) {
+    if (GetChunk(frame_id) == nullptr) {
+      continue;
+    }
+    Page *page = GetFrame(frame_id);
+    page_id_t page_id = page->page_id_;
+    if (page_id != INVALID_PAGE_ID && page->pin_count_ == 0 && seen.insert(page_id).second) {
+      page_ids.push_back(page_id);
+    }
+  }
+  return page_ids;
+}
+
+size_t BufferPoolManagerInstance::WarmUp(const std::vector<page_id_t> &page_ids) {
+  std::vector<page_id_t> hot_set;
+  std::unordered_set<page_id_t> seen;
+  for (page_id_t page_id : page_ids) {
+    if (hot_set.size() == pool_size_) {
+      break;
+    }
+    if (page_id >= 0 && static_cast<uint32_t>(page_id) % num_instances_ == instance_index_ &&
+        seen.insert(page_id).second) {
+      hot_set.push_back(page_id);
+    }
+  }
+
+  // The hot set is only a hint, and may be out of date: a page it lists may have become corrupt, or its tablespace may
+  // have been dropped since. Such a page is skipped rather than failing the start-up.
+  auto touch = [this](page_id_t page_id) {
+    try {
+      if (FetchPageImpl(page_id, AccessType::Unknown) == nullptr) {
+        return false;
+      }
+    } catch (const Exception &e) {
+      LOG_DEBUG("skipping hot page %d: %s", page_id, e.what());
+      return false;
+    }
+    UnpinPageImpl(page_id, false);
+    return true;
+  };
+
+  // Each thread reads a contiguous run of the sorted ids, so the reads sweep the file instead of seeking around it.
+  std::vector<page_id_t> sorted(hot_set);
+  std::sort(sorted.begin(), sorted.end());
+  size_t num_threads = std::min<size_t>(HOT_SET_LOAD_THREADS, sorted.size());
+  std::atomic<size_t> num_loaded{0};
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t] {
+      size_t begin = sorted.size() * t / num_threads;
+      size_t end = sorted.size() * (t + 1) / num_threads;
+      for (size_t i = begin; i < end; ++i) {
+        if (touch(sorted[i])) {
+          num_loaded++;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Touch the pages again, coldest first, so that the hottest ones end up the most recently used.
+  for (auto it = hot_set.rbegin(); it != hot_set.rend(); ++it) {
+    touch(*it);
+  }
+  return num_loaded;
+}
+
+void BufferPoolManagerInstance::RunBackgroundWriter(double clean_fraction) {
+  std::scoped_lock bgwriter_lk{bgwriter_latch_};
+  bgwriter_clean_fraction_ = clean_fraction;
+  if (bgwriter_running_) {
+    return;
+  }
+  bgwriter_running_ = true;
+  bgwriter_ = std::thread(&BufferPoolManagerInstance::BackgroundWriterLoop, this);
+}
+
+void BufferPoolManagerInstance::StopBackgroundWriter() {
+  {
+    std::scoped_lock bgwriter_lk{bgwriter_latch_};
+    bgwriter_running_ = false;
+  }
+  bgwriter_cv_.notify_one();
+  if (bgwriter_.joinable()) {
+    bgwriter_.join();
+  }
+}
+
+void BufferPoolManagerInstance::BackgroundWriterLoop() {
+  auto hot_set_saved_at = std::chrono::steady_clock::now();
+  std::unique_lock bgwriter_lk{bgwriter_latch_};
+  while (bgwriter_running_) {
+    std::string hot_set_file = hot_set_file_;
+    bgwriter_lk.unlock();
+    counters_.Add(BufferPoolCounter::BACKGROUND_WRITES, CleanEvictableFrames());
+    if (!hot_set_file.empty() && std::chrono::steady_clock::now() - hot_set_saved_at >= hot_set_interval) {
+      SaveHotSet(hot_set_file);
+      hot_set_saved_at = std::chrono::steady_clock::now();
+    }
+    bgwriter_lk.lock();
+    bgwriter_cv_.wait_for(bgwriter_lk, bgwriter_interval, [&] { return !bgwriter_running_ || bgwriter_wakeup_; });
+    bgwriter_wakeup_ = false;
+  }
+}
+
+size_t BufferPoolManagerInstance::CleanEvictableFrames() {
+  // Pick the pages to write and pin them under the latch. Pinning keeps them from being evicted or deleted while we
+  // write; they stay in the replacer so that their position there is not disturbed.
+  std::vector<std::pair<page_id_t, frame_id_t>> to_write;
+  {
+    std::scoped_lock bpm_slk{latch_};
+    size_t num_evictable = 0;
+    size_t num_clean = 0;
+    size_t frame_limit = FrameLimit();
+    for (size_t i = 0; i < frame_limit; ++i) {
+      if (chunks_[i / chunk_size_] == nullptr) {
+        continue;
+      }
+      Page *page = GetFrame(i);
+      // Frames with I/O in progress are always pinned.
+      if (page->page_id_ == INVALID_PAGE_ID || page->pin_count_ != 0) {
+        continue;
+      }
+      num_evictable++;
+      if (page->is_dirty_) {
+        to_write.emplace_back(page->page_id_, static_cast<frame_id_t>(i));
+      } else {
+        num_clean++;
+      }
+    }
+    auto target = static_cast<size_t>(std::ceil(bgwriter_clean_fraction_ * num_evictable));
+    if (num_clean >= target) {
+      return 0;
+    }
+    // Writing in page id order turns the writes into one sweep over the file.
+    std::sort(to_write.begin(), to_write.end());
+    to_write.resize(std::min(to_write.size(), target - num_clean));
+    for (const auto &[page_id, frame_id] : to_write) {
+      GetFrame(frame_id)->pin_count_++;
+    }
+  }
+
+  // Copy the pages out under their latches, then write the copies as one batch. Holding several page latches at
+  // once could deadlock with a thread that latches pages in another order. The pins stay until the writes are done,
+  // so that an eviction cannot read a page back from the disk before its write lands.
+  std::vector<char> copies(to_write.size() * PAGE_SIZE);
+  std::vector<page_id_t> page_ids;
+  std::vector<const char *> page_data;
+  std::vector<frame_id_t> cleaned_frame_ids;
+  for (const auto &[page_id, frame_id] : to_write) {
+    Page *page = GetFrame(frame_id);
+    page->RLatch();
+    // WAL: a page may only reach the disk once the log records that modified it have.
+    bool log_is_behind = enable_logging && log_manager_ != nullptr && page->GetLSN() > log_manager_->GetPersistentLSN();
+    if (!log_is_behind) {
+      // Clear the dirty flag before copying the data out, so that a change made after this point marks it again.
+      {
+        std::scoped_lock bpm_slk{latch_};
+        page->is_dirty_ = false;
+      }
+      char *copy = copies.data() + page_ids.size() * PAGE_SIZE;
+      memcpy(copy, page->GetData(), PAGE_SIZE);
+      page_ids.push_back(page_id);
+      page_data.push_back(copy);
+      cleaned_frame_ids.push_back(frame_id);
+    }
+    page->RUnlatch();
+  }
+  size_t num_written = page_ids.size();
+  try {
+    WritePages(page_ids, page_data);
+  } catch (const Exception &e) {
+    // Nothing is known to have reached the disk, so the pages are still dirty. The writer tries again next round.
+    LOG_DEBUG("background write of %zu pages failed: %s", page_ids.size(), e.what());
+    for (frame_id_t frame_id : cleaned_frame_ids) {
+      GetFrame(frame_id)->is_dirty_ = true;
+    }
+    num_written = 0;
+  }
+
+  for (const auto &[page_id, frame_id] : to_write) {
+    // Either a no-op, or the frame was pinned or skipped as a victim in the meantime and has to go back.
+    if (UnpinFrame(frame_id) && IsRetiring(frame_id)) {
+      DrainFrame(frame_id);
+    }
+  }
+  return num_written;
+}
+
+}  // namespace bustub
@@ -0,0 +1,109 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.cpp
+//
+// Identification: src/buffer/buffer_pool_stats.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_stats.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace bustub {
+
+namespace {
+
+/** Hottest first; ties broken by page id so that results are stable. */
+bool Hotter(const std::pair<page_id_t, uint64_t> &a, const std::pair<page_id_t, uint64_t> &b) {
+  return a.second != b.second ? a.second > b.second : a.first < b.first;
+}
+
+}  // namespace
+
+double BufferPoolStats::HitRatio() const {
+  uint64_t num_fetches = hits_ + misses_;
+  return num_fetches == 0 ? 0 : static_cast<double>(hits_) / static_cast<double>(num_fetches);
+}
+
+void BufferPoolStats::Merge(const BufferPoolStats &other, size_t num_hot_pages) {
+  hits_ += other.hits_;
+  misses_ += other.misses_;
+  evictions_ += other.evictions_;
+  dirty_write_backs_ += other.dirty_write_backs_;
+  background_writes_ += other.background_writes_;
+  pin_waits_ += other.pin_waits_;
+  latch_acquisitions_ += other.latch_acquisitions_;
+  latch_hold_ns_ += other.latch_hold_ns_;
+  hot_pages_.insert(hot_pages_.end(), other.hot_pages_.begin(), other.hot_pages_.end());
+  std::sort(hot_pages_.begin(), hot_pages_.end(), Hotter);
+  if (hot_pages_.size() > num_hot_pages) {
+    hot_pages_.resize(num_hot_pages);
+  }
+}
+
+std::string BufferPoolStats::ToString() const {
+  std::ostringstream os;
+  os << "hits: " << hits_ << ", misses: " << misses_ << ", hit ratio: " << HitRatio() << ", evictions: " << evictions_
+     << " (" << dirty_write_backs_ << " dirty), background writes: " << background_writes_
+     << ", pin waits: " << pin_waits_ << ", latch held " << latch_acquisitions_ << " times for "
+     << latch_hold_ns_ / 1000 << " us";
+  if (!hot_pages_.empty()) {
+    os << ", hot pages:";
+    for (const auto &[page_id, num_fetches] : hot_pages_) {
+      os << " " << page_id << " (" << num_fetches << ")";
+    }
+  }
+  return os.str();
+}
+
+uint64_t BufferPoolCounters::Get(BufferPoolCounter counter) const {
+  uint64_t sum = 0;
+  for (size_t i = 0; i < NUM_SHARDS; ++i) {
+    sum += shards_[i].counts_[static_cast<size_t>(counter)].load(std::memory_order_relaxed);
+  }
+  return sum;
+}
+
+void BufferPoolCounters::Snapshot(BufferPoolStats *stats) const {
+  stats->hits_ = Get(BufferPoolCounter::HITS);
+  stats->misses_ = Get(BufferPoolCounter::MISSES);
+  stats->dirty_write_backs_ = Get(BufferPoolCounter::DIRTY_EVICTIONS);
+  stats->evictions_ = Get(BufferPoolCounter::CLEAN_EVICTIONS) + stats->dirty_write_backs_;
+  stats->background_writes_ = Get(BufferPoolCounter::BACKGROUND_WRITES);
+  stats->pin_waits_ = Get(BufferPoolCounter::PIN_WAITS);
+  stats->latch_acquisitions_ = Get(BufferPoolCounter::LATCH_ACQUISITIONS);
+  stats->latch_hold_ns_ = Get(BufferPoolCounter::LATCH_HOLD_NS);
+}
+
+size_t BufferPoolCounters::ShardIndex() {
+  // Threads are spread over the shards once and for all.
+  static std::atomic<size_t> next_shard{0};
+  thread_local size_t shard_index = next_shard++ % NUM_SHARDS;
+  return shard_index;
+}
+
+void PageHeatMap::SetSampleRate(size_t sample_rate) {
+  std::scoped_lock heat_lk{latch_};
+  heat_.clear();
+  sample_rate_ = sample_rate;
+}
+
+std::vector<std::pair<page_id_t, uint64_t>> PageHeatMap::GetHottest(size_t num_pages) const {
+  std::vector<std::pair<page_id_t, uint64_t>> hottest;
+  {
+    std::scoped_lock heat_lk{latch_};
+    hottest.assign(heat_.begin(), heat_.end());
+  }
+  num_pages = std::min(num_pages, hottest.size());
+  std::partial_sort(hottest.begin(), hottest.begin() + num_pages, hottest.end(), Hotter);
+  hottest.resize(num_pages);
+  return hottest;
+}
+
+}  // namespace bustub
@@ -12,18 +12,101 @@
 
 #include "buffer/clock_replacer.h"
 
+#include "common/macros.h"
+
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_pages)
+    : num_pages_(num_pages), num_frames_(num_pages), frames_(std::make_unique<std::atomic<uint8_t>[]>(num_pages)) {
+  for (size_t i = 0; i < num_pages_; ++i) {
+    frames_[i].store(0, std::memory_order_relaxed);
+  }
+}
 
 ClockReplacer::~ClockReplacer() = default;
 
-bool ClockReplacer::Victim(frame_id_t *frame_id) { return false; }
+bool ClockReplacer::Victim(frame_id_t *frame_id) {
+  // Two full turns are enough to clear every reference bit and come back around to an unreferenced frame. Concurrent
+  // Unpins can set bits behind the hand, but only a frame that was not evictable gets one, and the hand clears it on
+  // its next pass; so keep turning until a frame is found, or until there is none left to find.
+  while (size_.load() > 0) {
+    size_t pos = clock_hand_.fetch_add(1) % num_frames_.load();
+    uint8_t state = frames_[pos].load();
+    if ((state & EVICTABLE) == 0) {
+      continue;
+    }
+    if ((state & REFERENCED) != 0) {
+      // Second chance. If someone touched the frame meanwhile the CAS fails, which is just as good.
+      frames_[pos].compare_exchange_strong(state, state & ~REFERENCED);
+      continue;
+    }
+    if (frames_[pos].compare_exchange_strong(state, 0)) {
+      size_--;
+      *frame_id = static_cast<frame_id_t>(pos);
+      return true;
+    }
+  }
+  return false;
+}
+
+void ClockReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type) {
+  if (access_type == AccessType::Scan) {
+    frames_[frame_id].fetch_or(SCANNED);
+  } else {
+    frames_[frame_id].fetch_and(static_cast<uint8_t>(~SCANNED));
+  }
+}
+
+void ClockReplacer::Remove(frame_id_t frame_id) {
+  uint8_t old_state = frames_[frame_id].exchange(0);
+  if ((old_state & EVICTABLE) != 0) {
+    size_--;
+  }
+}
+
+void ClockReplacer::SetNumFrames(size_t num_frames) {
+  BUSTUB_ASSERT(num_frames > 0 && num_frames <= num_pages_, "the replacer can only sweep frames it was created for");
+  num_frames_ = num_frames;
+}
+
+void ClockReplacer::Pin(frame_id_t frame_id) {
+  uint8_t old_state = frames_[frame_id].fetch_and(static_cast<uint8_t>(~(EVICTABLE | REFERENCED)));
+  if ((old_state & EVICTABLE) != 0) {
+    size_--;
+  }
+}
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+void ClockReplacer::Unpin(frame_id_t frame_id) {
+  // Unpinning a frame that is already evictable changes nothing, in particular it does not earn a second chance.
+  uint8_t old_state = frames_[frame_id].load();
+  uint8_t new_state;
+  do {
+    if ((old_state & EVICTABLE) != 0) {
+      return;
+    }
+    new_state = old_state | EVICTABLE | ((old_state & SCANNED) != 0 ? 0 : REFERENCED);
+  } while (!frames_[frame_id].compare_exchange_weak(old_state, new_state));
+  size_++;
+}
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+size_t ClockReplacer::Size() { return size_.load(); }
 
-size_t ClockReplacer::Size() { return 0; }
+std::vector<frame_id_t> ClockReplacer::GetRecencyOrder() {
+  // Referenced frames survive the next pass of the hand, so they come first. Within each group, the frames the hand
+  // reaches last are the ones it would victimize last.
+  std::vector<frame_id_t> referenced;
+  std::vector<frame_id_t> unreferenced;
+  size_t hand = clock_hand_.load();
+  size_t num_frames = num_frames_.load();
+  for (size_t step = num_frames; step > 0; --step) {
+    size_t pos = (hand + step - 1) % num_frames;
+    uint8_t state = frames_[pos].load();
+    if ((state & EVICTABLE) != 0) {
+      ((state & REFERENCED) != 0 ? referenced : unreferenced).push_back(static_cast<frame_id_t>(pos));
+    }
+  }
+  referenced.insert(referenced.end(), unreferenced.begin(), unreferenced.end());
+  return referenced;
+}
 
 }  // namespace bustub
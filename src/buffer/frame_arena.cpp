@@ -0,0 +1,55 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.cpp
+//
+// Identification: src/buffer/frame_arena.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <sys/mman.h>
+
+#include <cstdint>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+FrameArena::FrameArena(size_t num_frames) : num_frames_(num_frames) {
+  size_ = num_frames * PAGE_SIZE;
+  // A pool smaller than a huge page would only waste most of one, so it gets plain base pages.
+  bool use_huge_pages = size_ >= HUGE_PAGE_SIZE;
+  size_t alignment = use_huge_pages ? HUGE_PAGE_SIZE : PAGE_SIZE;
+  size_ = (size_ + alignment - 1) / alignment * alignment;
+  // mmap only promises base page alignment. Map an extra huge page and cut off the unaligned ends, so that the kernel
+  // can back the arena with huge pages from its very first byte.
+  size_t mapped_size = use_huge_pages ? size_ + HUGE_PAGE_SIZE : size_;
+  void *mapped = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mapped == MAP_FAILED) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot map the buffer pool frames");
+  }
+  auto start = reinterpret_cast<uintptr_t>(mapped);
+  auto aligned = (start + alignment - 1) / alignment * alignment;
+  if (aligned > start) {
+    munmap(mapped, aligned - start);
+  }
+  if (aligned + size_ < start + mapped_size) {
+    munmap(reinterpret_cast<void *>(aligned + size_), start + mapped_size - (aligned + size_));
+  }
+  data_ = reinterpret_cast<char *>(aligned);
+#ifdef MADV_HUGEPAGE
+  // Only a hint: without transparent huge pages the arena is still one aligned, contiguous block.
+  if (use_huge_pages) {
+    huge_page_advised_ = madvise(data_, size_, MADV_HUGEPAGE) == 0;
+  }
+#endif
+}
+
+FrameArena::~FrameArena() { munmap(data_, size_); }
+
+}  // namespace bustub
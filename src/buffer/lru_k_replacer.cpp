@@ -0,0 +1,115 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.cpp
+//
+// Identification: src/buffer/lru_k_replacer.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/lru_k_replacer.h"
+
+#include "common/macros.h"
+
+namespace bustub {
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k) : k_(k), frames_(num_pages) {
+  BUSTUB_ASSERT(k > 0, "LRU-K needs to remember at least one access");
+}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+bool LRUKReplacer::Victim(frame_id_t *frame_id) {
+  std::scoped_lock lk{latch_};
+  // Frames with fewer than k accesses beat every frame with a full history. Within each group, the smaller the
+  // remembered timestamp (the earliest access, resp. the k-th most recent one), the larger the backward distance.
+  FrameQueue &queue = short_history_.empty() ? full_history_ : short_history_;
+  if (queue.empty()) {
+    return false;
+  }
+  frame_id_t victim = queue.begin()->second;
+  queue.erase(queue.begin());
+  frames_[victim].history_.clear();
+  frames_[victim].evictable_ = false;
+  *frame_id = victim;
+  return true;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  std::scoped_lock lk{latch_};
+  FrameInfo &frame = frames_[frame_id];
+  if (frame.evictable_) {
+    Dequeue(frame_id);
+    frame.evictable_ = false;
+  }
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  std::scoped_lock lk{latch_};
+  FrameInfo &frame = frames_[frame_id];
+  if (!frame.evictable_) {
+    frame.evictable_ = true;
+    Enqueue(frame_id);
+  }
+}
+
+void LRUKReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type) {
+  std::scoped_lock lk{latch_};
+  FrameInfo &frame = frames_[frame_id];
+  if (access_type == AccessType::Scan && !frame.history_.empty()) {
+    return;
+  }
+  // An evictable frame moves within its queue, or to the other one once its history is full.
+  if (frame.evictable_) {
+    Dequeue(frame_id);
+  }
+  frame.history_.push_back(current_timestamp_++);
+  if (frame.history_.size() > k_) {
+    frame.history_.pop_front();
+  }
+  if (frame.evictable_) {
+    Enqueue(frame_id);
+  }
+}
+
+void LRUKReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock lk{latch_};
+  FrameInfo &frame = frames_[frame_id];
+  if (frame.evictable_) {
+    Dequeue(frame_id);
+    frame.evictable_ = false;
+  }
+  frame.history_.clear();
+}
+
+size_t LRUKReplacer::Size() {
+  std::scoped_lock lk{latch_};
+  return short_history_.size() + full_history_.size();
+}
+
+std::vector<frame_id_t> LRUKReplacer::GetRecencyOrder() {
+  std::scoped_lock lk{latch_};
+  // The reverse of the order Victim picks frames in: full histories first, then the larger remembered timestamp.
+  std::vector<frame_id_t> order;
+  for (const FrameQueue *queue : {&full_history_, &short_history_}) {
+    for (auto it = queue->rbegin(); it != queue->rend(); ++it) {
+      order.push_back(it->second);
+    }
+  }
+  return order;
+}
+
+void LRUKReplacer::Enqueue(frame_id_t frame_id) {
+  const FrameInfo &frame = frames_[frame_id];
+  QueueOf(frame).insert(KeyOf(frame, frame_id));
+}
+
+void LRUKReplacer::Dequeue(frame_id_t frame_id) {
+  const FrameInfo &frame = frames_[frame_id];
+  QueueOf(frame).erase(KeyOf(frame, frame_id));
+}
+
+}  // namespace bustub
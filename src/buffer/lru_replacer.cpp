@@ -14,7 +14,9 @@
 
 namespace bustub {
 
-LRUReplacer::LRUReplacer(size_t num_pages) : num_pages(num_pages) { lru_map.reserve(this->num_pages); }
+LRUReplacer::LRUReplacer(size_t num_pages) : num_pages(num_pages), scanned(num_pages, false) {
+  lru_map.reserve(this->num_pages);
+}
 
 LRUReplacer::~LRUReplacer() = default;
 
@@ -51,6 +53,11 @@ void LRUReplacer::Unpin(frame_id_t frame_id) {
   auto lru_map_iterator = lru_map.find(frame_id);
   if (lru_map_iterator != lru_map.end()) {
     return;//nothing to do
+  } else if (scanned[frame_id]) {
+    // a page a scan has moved past is the first one we want to give up, so it goes straight to the back
+    lru_bucket_list.push_back(frame_id);
+    lru_map[frame_id] = std::prev(lru_bucket_list.end());
+    return;
   } else {
     lru_bucket_list.push_front(frame_id);
     lru_map[frame_id] = lru_bucket_list.begin();//as this is now the most recently used page we have to add this to the front of the list
@@ -63,6 +70,22 @@ void LRUReplacer::Unpin(frame_id_t frame_id) {
   */
 }
 
+void LRUReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type) {
+  std::lock_guard<std::mutex> guard(lru_lock);
+  scanned[frame_id] = access_type == AccessType::Scan;
+}
+
+void LRUReplacer::Remove(frame_id_t frame_id) {
+  Pin(frame_id);
+  std::lock_guard<std::mutex> guard(lru_lock);
+  scanned[frame_id] = false;
+}
+
 size_t LRUReplacer::Size() { return lru_map.size(); }
 
+std::vector<frame_id_t> LRUReplacer::GetRecencyOrder() {
+  std::lock_guard<std::mutex> guard(lru_lock);
+  return {lru_bucket_list.begin(), lru_bucket_list.end()};
+}
+
 }  // namespace bustub
@@ -0,0 +1,256 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// mmap_buffer_pool_manager.cpp
+//
+// Identification: src/buffer/mmap_buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/mmap_buffer_pool_manager.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <utility>
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+MmapBufferPoolManager::MappedFile::~MappedFile() {
+  if (data_ != nullptr) {
+    munmap(data_, size_);
+  }
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+}
+
+MmapBufferPoolManager::MmapBufferPoolManager(const std::string &db_file) {
+  struct stat st;
+  if (stat((db_file + DiskManager::SLOT_FILE_SUFFIX).c_str(), &st) == 0) {
+    throw Exception("can't map a compressed database");
+  }
+  void *zero_page = mmap(nullptr, PAGE_SIZE, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (zero_page == MAP_FAILED) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot map the page of zeros");
+  }
+  zero_page_ = static_cast<char *>(zero_page);
+  try {
+    MapFile(DEFAULT_TABLESPACE, db_file);
+    // the tablespace file is named after the db file, as by DiskManager
+    std::string::size_type n = db_file.rfind('.');
+    if (n != std::string::npos) {
+      std::ifstream in(db_file.substr(0, n) + ".tablespaces");
+      tablespace_id_t tablespace;
+      std::string data_file_name;
+      while (in >> tablespace && std::getline(in >> std::ws, data_file_name)) {
+        if (tablespace <= DEFAULT_TABLESPACE || tablespace >= MAX_TABLESPACES) {
+          LOG_DEBUG("bad tablespace file");
+          continue;
+        }
+        MapFile(tablespace, data_file_name);
+      }
+    }
+  } catch (const Exception &) {
+    // the files mapped so far are unmapped along with files_
+    munmap(zero_page_, PAGE_SIZE);
+    throw;
+  }
+  prefetcher_ = std::make_unique<Prefetcher>(this);
+}
+
+MmapBufferPoolManager::~MmapBufferPoolManager() {
+  prefetcher_->Stop();
+  munmap(zero_page_, PAGE_SIZE);
+}
+
+void MmapBufferPoolManager::MapFile(tablespace_id_t tablespace, const std::string &file_name) {
+  auto file = std::make_unique<MappedFile>();
+  file->fd_ = open(file_name.c_str(), O_RDONLY);
+  struct stat st;
+  if (file->fd_ < 0 || fstat(file->fd_, &st) != 0) {
+    throw Exception("can't open data file " + file_name);
+  }
+  file->size_ = st.st_size;
+  if (file->size_ > 0) {
+    void *data = mmap(nullptr, file->size_, PROT_READ, MAP_SHARED, file->fd_, 0);
+    if (data == MAP_FAILED) {
+      throw Exception("can't map data file " + file_name);
+    }
+    file->data_ = static_cast<char *>(data);
+  }
+
+  // The highest allocated page is in the last run whose free-space map page has a bit set.
+  size_t run_size = static_cast<size_t>(FREE_SPACE_MAP_INTERVAL + DiskManager::RUN_HEADER_PAGES) * PAGE_SIZE;
+  for (size_t run = (file->size_ + run_size - 1) / run_size; run > 0 && file->num_pages_ == 0; --run) {
+    off_t map_offset = DiskManager::MapPageOffset(run - 1);
+    if (static_cast<size_t>(map_offset) + PAGE_SIZE > file->size_) {
+      continue;
+    }
+    const auto *map = reinterpret_cast<const unsigned char *>(file->data_ + map_offset);
+    for (size_t byte = PAGE_SIZE; byte > 0; --byte) {
+      if (map[byte - 1] != 0) {
+        int bit = 7;
+        while ((map[byte - 1] & (1 << bit)) == 0) {
+          bit--;
+        }
+        file->num_pages_ = static_cast<page_id_t>((run - 1) * FREE_SPACE_MAP_INTERVAL + (byte - 1) * 8 + bit + 1);
+        break;
+      }
+    }
+  }
+
+  file->pages_ = std::make_unique<Page[]>(file->num_pages_);
+  file->verified_ = std::make_unique<std::atomic<bool>[]>(file->num_pages_);
+  for (page_id_t page_no = 0; page_no < file->num_pages_; ++page_no) {
+    Page *page = &file->pages_[page_no];
+    page->page_id_ = MakePageId(tablespace, page_no);
+    off_t offset = DiskManager::PageOffset(page_no);
+    page->data_ = static_cast<size_t>(offset) + PAGE_SIZE <= file->size_ ? file->data_ + offset : zero_page_;
+  }
+  files_[tablespace] = std::move(file);
+}
+
+MmapBufferPoolManager::MappedFile *MmapBufferPoolManager::FindFile(page_id_t page_id) const {
+  tablespace_id_t tablespace = GetTablespace(page_id);
+  if (page_id < 0 || tablespace >= MAX_TABLESPACES) {
+    return nullptr;
+  }
+  MappedFile *file = files_[tablespace].get();
+  return file != nullptr && GetPageNumber(page_id) < file->num_pages_ ? file : nullptr;
+}
+
+void MmapBufferPoolManager::VerifyPage(const MappedFile &file, page_id_t page_no) {
+  off_t offset = DiskManager::ChecksumOffset(page_no);
+  uint32_t checksum = 0;
+  if (static_cast<size_t>(offset) + sizeof(checksum) <= file.size_) {
+    memcpy(&checksum, file.data_ + offset, sizeof(checksum));
+  }
+  const Page &page = file.pages_[page_no];
+  if (checksum != 0 && checksum != DiskManager::PageChecksum(page.GetData())) {
+    throw Exception(ExceptionType::CORRUPTION,
+                    "page " + std::to_string(page.page_id_) + " does not match its checksum");
+  }
+}
+
+void MmapBufferPoolManager::Advise(const char *begin, const char *end) {
+  // madvise wants the start of a base page, which a bustub page need not be
+  static const auto base_page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+  auto start = reinterpret_cast<uintptr_t>(begin) / base_page_size * base_page_size;
+  if (madvise(reinterpret_cast<void *>(start), reinterpret_cast<uintptr_t>(end) - start, MADV_WILLNEED) != 0) {
+    LOG_DEBUG("madvise failed");
+  }
+}
+
+void MmapBufferPoolManager::PrefetchPage(page_id_t page_id, AccessType /* access_type */) {
+  MappedFile *file = FindFile(page_id);
+  if (file == nullptr) {
+    return;
+  }
+  const char *data = file->pages_[GetPageNumber(page_id)].GetData();
+  if (data != zero_page_) {
+    Advise(data, data + PAGE_SIZE);
+  }
+}
+
+void MmapBufferPoolManager::PrefetchRange(page_id_t first_page_id, size_t num_pages, AccessType /* access_type */) {
+  MappedFile *file = FindFile(first_page_id);
+  if (file == nullptr || num_pages == 0) {
+    return;
+  }
+  // Consecutive pages lie in order in the file, with the run headers between them, so one hint covers them all.
+  page_id_t first_page_no = GetPageNumber(first_page_id);
+  auto last_page_no = static_cast<page_id_t>(std::min<size_t>(first_page_no + num_pages, file->num_pages_) - 1);
+  size_t begin = DiskManager::PageOffset(first_page_no);
+  size_t end = std::min<size_t>(DiskManager::PageOffset(last_page_no) + PAGE_SIZE, file->size_);
+  if (begin < end) {
+    Advise(file->data_ + begin, file->data_ + end);
+  }
+}
+
+void MmapBufferPoolManager::PrefetchChain(page_id_t page_id, size_t depth, next_page_fn next_page,
+                                          AccessType access_type) {
+  // The next page is only known once the page before it has been read, so the chain is followed in the background.
+  prefetcher_->PrefetchChain(page_id, depth, std::move(next_page), access_type);
+}
+
+size_t MmapBufferPoolManager::GetPoolSize() {
+  size_t pool_size = 0;
+  for (const auto &file : files_) {
+    if (file != nullptr) {
+      pool_size += file->num_pages_;
+    }
+  }
+  return pool_size;
+}
+
+BufferPoolStats MmapBufferPoolManager::GetStats(size_t num_hot_pages) {
+  BufferPoolStats stats;
+  counters_.Snapshot(&stats);
+  stats.hot_pages_ = page_heat_.GetHottest(num_hot_pages);
+  return stats;
+}
+
+void MmapBufferPoolManager::SetPageHeatSampling(size_t sample_rate) { page_heat_.SetSampleRate(sample_rate); }
+
+tablespace_id_t MmapBufferPoolManager::CreateTablespace(const std::string & /* file_name */) {
+  throw Exception("can't create a tablespace in a database mapped read-only");
+}
+
+Page *MmapBufferPoolManager::FetchPageImpl(page_id_t page_id, AccessType /* access_type */) {
+  MappedFile *file = FindFile(page_id);
+  if (file == nullptr) {
+    return nullptr;
+  }
+  page_id_t page_no = GetPageNumber(page_id);
+  if (file->verified_[page_no].load(std::memory_order_acquire)) {
+    counters_.Add(BufferPoolCounter::HITS);
+  } else {
+    // Threads that fetch the page for the first time at once all verify it, but only one counts the miss.
+    VerifyPage(*file, page_no);
+    bool verified = file->verified_[page_no].exchange(true, std::memory_order_acq_rel);
+    counters_.Add(verified ? BufferPoolCounter::HITS : BufferPoolCounter::MISSES);
+  }
+  page_heat_.Record(page_id);
+  Page *page = &file->pages_[page_no];
+  page->pin_count_++;
+  return page;
+}
+
+bool MmapBufferPoolManager::UnpinPageImpl(page_id_t page_id, bool /* is_dirty */) {
+  MappedFile *file = FindFile(page_id);
+  if (file == nullptr) {
+    return false;
+  }
+  Page *page = &file->pages_[GetPageNumber(page_id)];
+  int pin_count = page->pin_count_.load();
+  do {
+    if (pin_count <= 0) {
+      return false;
+    }
+  } while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count - 1));
+  return true;
+}
+
+bool MmapBufferPoolManager::FlushPageImpl(page_id_t page_id) { return FindFile(page_id) != nullptr; }
+
+Page *MmapBufferPoolManager::NewPageImpl(page_id_t * /* page_id */, tablespace_id_t /* tablespace */,
+                                         page_id_t /* near_page_id */) {
+  return nullptr;
+}
+
+bool MmapBufferPoolManager::DeletePageImpl(page_id_t page_id) { return FindFile(page_id) == nullptr; }
+
+}  // namespace bustub
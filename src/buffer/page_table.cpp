@@ -0,0 +1,110 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.cpp
+//
+// Identification: src/buffer/page_table.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+#include "common/macros.h"
+
+namespace bustub {
+
+PageTable::PageTable(size_t num_frames) : capacity_(4) {
+  // At most half full, so that probes stay short and always reach an empty slot.
+  while (capacity_ < 2 * num_frames) {
+    capacity_ *= 2;
+  }
+  slots_ = std::make_unique<std::atomic<uint64_t>[]>(capacity_);
+  for (size_t i = 0; i < capacity_; ++i) {
+    slots_[i].store(MakeSlot(EMPTY, 0), std::memory_order_relaxed);
+  }
+}
+
+size_t PageTable::Home(page_id_t page_id) const {
+  // Fibonacci hashing: page ids handed out by a sharded pool are strided, and this spreads strides evenly.
+  return static_cast<size_t>((static_cast<uint32_t>(page_id) * 0x9E3779B97F4A7C15ULL) >> 32) & (capacity_ - 1);
+}
+
+bool PageTable::Find(page_id_t page_id, frame_id_t *frame_id) const {
+  size_t i = Home(page_id);
+  for (size_t probes = 0; probes < capacity_; ++probes) {
+    uint64_t slot = slots_[i].load(std::memory_order_acquire);
+    page_id_t key = KeyOf(slot);
+    if (key == page_id) {
+      *frame_id = FrameOf(slot);
+      return true;
+    }
+    if (key == EMPTY) {
+      return false;
+    }
+    i = (i + 1) & (capacity_ - 1);
+  }
+  return false;
+}
+
+void PageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  BUSTUB_ASSERT(page_id != EMPTY && page_id != TOMBSTONE, "Invalid page id in the page table.");
+  // Reuse the first tombstone on the way, but keep probing for the empty slot in case the page is already there.
+  size_t i = Home(page_id);
+  size_t target = capacity_;
+  for (size_t probes = 0; probes < capacity_; ++probes) {
+    page_id_t key = KeyOf(slots_[i].load(std::memory_order_relaxed));
+    if (key == page_id) {
+      slots_[i].store(MakeSlot(page_id, frame_id), std::memory_order_release);
+      return;
+    }
+    if (key == TOMBSTONE && target == capacity_) {
+      target = i;
+    }
+    if (key == EMPTY) {
+      if (target == capacity_) {
+        target = i;
+      }
+      break;
+    }
+    i = (i + 1) & (capacity_ - 1);
+  }
+  BUSTUB_ASSERT(target != capacity_, "Page table is full.");
+  slots_[target].store(MakeSlot(page_id, frame_id), std::memory_order_release);
+  size_++;
+}
+
+void PageTable::Erase(page_id_t page_id) {
+  size_t i = Home(page_id);
+  for (size_t probes = 0; probes < capacity_; ++probes) {
+    page_id_t key = KeyOf(slots_[i].load(std::memory_order_relaxed));
+    if (key == EMPTY) {
+      return;
+    }
+    if (key == page_id) {
+      break;
+    }
+    i = (i + 1) & (capacity_ - 1);
+  }
+  if (KeyOf(slots_[i].load(std::memory_order_relaxed)) != page_id) {
+    return;
+  }
+  size_--;
+  // A slot followed by an empty slot is on nobody's probe path, so it can become empty itself, and so can the
+  // tombstones right before it. Everything else becomes a tombstone, which keeps later entries reachable.
+  if (KeyOf(slots_[(i + 1) & (capacity_ - 1)].load(std::memory_order_relaxed)) != EMPTY) {
+    slots_[i].store(MakeSlot(TOMBSTONE, 0), std::memory_order_release);
+    return;
+  }
+  while (true) {
+    slots_[i].store(MakeSlot(EMPTY, 0), std::memory_order_release);
+    i = (i + capacity_ - 1) & (capacity_ - 1);
+    if (KeyOf(slots_[i].load(std::memory_order_relaxed)) != TOMBSTONE) {
+      return;
+    }
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,268 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.cpp
+//
+// Identification: src/buffer/parallel_buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+namespace bustub {
+
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size,
+                                                     DiskInterface *disk_manager, LogManager *log_manager,
+                                                     ReplacerType replacer_type)
+    : disk_manager_(disk_manager) {
+  BUSTUB_ASSERT(num_instances > 0, "A parallel buffer pool needs at least one instance.");
+  // Allocate and create individual BufferPoolManagerInstances
+  instances_.reserve(num_instances);
+  for (size_t i = 0; i < num_instances; ++i) {
+    instances_.emplace_back(std::make_unique<BufferPoolManagerInstance>(
+        pool_size, static_cast<uint32_t>(num_instances), static_cast<uint32_t>(i), disk_manager, log_manager,
+        replacer_type));
+  }
+  prefetcher_ = std::make_unique<Prefetcher>(this);
+}
+
+ParallelBufferPoolManager::~ParallelBufferPoolManager() { prefetcher_->Stop(); }
+
+void ParallelBufferPoolManager::PrefetchPage(page_id_t page_id, AccessType access_type) {
+  prefetcher_->PrefetchPage(page_id, access_type);
+}
+
+void ParallelBufferPoolManager::PrefetchRange(page_id_t first_page_id, size_t num_pages, AccessType access_type) {
+  prefetcher_->PrefetchRange(first_page_id, num_pages, access_type);
+}
+
+void ParallelBufferPoolManager::PrefetchChain(page_id_t page_id, size_t depth, next_page_fn next_page,
+                                              AccessType access_type) {
+  prefetcher_->PrefetchChain(page_id, depth, std::move(next_page), access_type);
+}
+
+size_t ParallelBufferPoolManager::GetPoolSize() {
+  // Get size of all BufferPoolManagerInstances
+  size_t pool_size = 0;
+  for (const auto &instance : instances_) {
+    pool_size += instance->GetPoolSize();
+  }
+  return pool_size;
+}
+
+bool ParallelBufferPoolManager::Resize(size_t pool_size) {
+  size_t instance_pool_size = (pool_size + instances_.size() - 1) / instances_.size();
+  std::vector<size_t> old_pool_sizes;
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    old_pool_sizes.push_back(instances_[i]->GetPoolSize());
+    if (!ResizeInstance(i, instance_pool_size)) {
+      // Put the instances resized so far back the way they were; a size they had before is always valid.
+      for (size_t j = 0; j < i; ++j) {
+        instances_[j]->Resize(old_pool_sizes[j]);
+      }
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ParallelBufferPoolManager::ResizeInstance(size_t instance_index, size_t pool_size) {
+  return instance_index < instances_.size() && instances_[instance_index]->Resize(pool_size);
+}
+
+bool ParallelBufferPoolManager::SaveHotSet(const std::string &file_name) {
+  bool saved = true;
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    saved = instances_[i]->SaveHotSet(InstanceHotSetFile(file_name, i)) && saved;
+  }
+  return saved;
+}
+
+size_t ParallelBufferPoolManager::LoadHotSet(const std::string &file_name) {
+  std::atomic<size_t> num_loaded{0};
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    threads.emplace_back([&, i] { num_loaded += instances_[i]->LoadHotSet(InstanceHotSetFile(file_name, i)); });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  return num_loaded;
+}
+
+void ParallelBufferPoolManager::SetHotSetFile(const std::string &file_name) {
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    instances_[i]->SetHotSetFile(file_name.empty() ? file_name : InstanceHotSetFile(file_name, i));
+  }
+}
+
+void ParallelBufferPoolManager::SetAsyncDiskManager(AsyncDiskManager *async_disk_manager) {
+  for (auto &instance : instances_) {
+    instance->SetAsyncDiskManager(async_disk_manager);
+  }
+}
+
+std::string ParallelBufferPoolManager::InstanceHotSetFile(const std::string &file_name, size_t instance_index) {
+  return file_name + "." + std::to_string(instance_index);
+}
+
+void ParallelBufferPoolManager::RunBackgroundWriter(double clean_fraction) {
+  for (auto &instance : instances_) {
+    instance->RunBackgroundWriter(clean_fraction);
+  }
+}
+
+void ParallelBufferPoolManager::StopBackgroundWriter() {
+  for (auto &instance : instances_) {
+    instance->StopBackgroundWriter();
+  }
+}
+
+BufferPoolStats ParallelBufferPoolManager::GetStats(size_t num_hot_pages) {
+  BufferPoolStats stats;
+  for (auto &instance : instances_) {
+    stats.Merge(instance->GetStats(num_hot_pages), num_hot_pages);
+  }
+  return stats;
+}
+
+void ParallelBufferPoolManager::SetPageHeatSampling(size_t sample_rate) {
+  for (auto &instance : instances_) {
+    instance->SetPageHeatSampling(sample_rate);
+  }
+}
+
+size_t ParallelBufferPoolManager::GetNumCleanVictims() const {
+  size_t num_victims = 0;
+  for (const auto &instance : instances_) {
+    num_victims += instance->GetNumCleanVictims();
+  }
+  return num_victims;
+}
+
+size_t ParallelBufferPoolManager::GetNumDirtyVictims() const {
+  size_t num_victims = 0;
+  for (const auto &instance : instances_) {
+    num_victims += instance->GetNumDirtyVictims();
+  }
+  return num_victims;
+}
+
+size_t ParallelBufferPoolManager::GetNumBackgroundWrites() const {
+  size_t num_writes = 0;
+  for (const auto &instance : instances_) {
+    num_writes += instance->GetNumBackgroundWrites();
+  }
+  return num_writes;
+}
+
+BufferPoolManagerInstance *ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) {
+  // Get BufferPoolManager responsible for handling given page id. You can use this method in your other methods.
+  return instances_[static_cast<size_t>(page_id) % instances_.size()].get();
+}
+
+Page *ParallelBufferPoolManager::FetchPageImpl(page_id_t page_id, AccessType access_type) {
+  // Fetch page for page_id from responsible BufferPoolManagerInstance
+  return GetBufferPoolManager(page_id)->FetchPageImpl(page_id, access_type);
+}
+
+std::vector<Page *> ParallelBufferPoolManager::FetchPages(const std::vector<page_id_t> &page_ids,
+                                                          AccessType access_type) {
+  // Split the batch by instance, remembering where each page goes in the result.
+  std::vector<std::vector<page_id_t>> instance_page_ids(instances_.size());
+  std::vector<std::vector<size_t>> instance_positions(instances_.size());
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    size_t instance_index = static_cast<size_t>(page_ids[i]) % instances_.size();
+    instance_page_ids[instance_index].push_back(page_ids[i]);
+    instance_positions[instance_index].push_back(i);
+  }
+  std::vector<Page *> pages(page_ids.size(), nullptr);
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    if (instance_page_ids[i].empty()) {
+      continue;
+    }
+    std::vector<Page *> instance_pages;
+    try {
+      instance_pages = instances_[i]->FetchPages(instance_page_ids[i], access_type);
+    } catch (const Exception &) {
+      // The failing instance has unpinned its own pages; give back what the instances before it pinned.
+      UnpinPages(page_ids, pages);
+      throw;
+    }
+    for (size_t j = 0; j < instance_pages.size(); ++j) {
+      pages[instance_positions[i][j]] = instance_pages[j];
+    }
+  }
+  return pages;
+}
+
+bool ParallelBufferPoolManager::UnpinPageImpl(page_id_t page_id, bool is_dirty) {
+  // Unpin page_id from responsible BufferPoolManagerInstance
+  return GetBufferPoolManager(page_id)->UnpinPageImpl(page_id, is_dirty);
+}
+
+bool ParallelBufferPoolManager::FlushPageImpl(page_id_t page_id) {
+  // Flush page_id from responsible BufferPoolManagerInstance
+  return GetBufferPoolManager(page_id)->FlushPageImpl(page_id);
+}
+
+Page *ParallelBufferPoolManager::NewPageImpl(page_id_t *page_id, tablespace_id_t tablespace, page_id_t near_page_id) {
+  // 1.   From a starting index of the BPMIs, call NewPageImpl until either 1) success and return 2) looped around to
+  //      starting index and return nullptr
+  // 2.   Bump the starting index (mod number of instances) to start search at a different BPMI each time this function
+  //      is called
+  const size_t num_instances = instances_.size();
+  const size_t start = next_instance_.fetch_add(1) % num_instances;
+  for (size_t i = 0; i < num_instances; ++i) {
+    Page *page = instances_[(start + i) % num_instances]->NewPageImpl(page_id, tablespace, near_page_id);
+    if (page != nullptr) {
+      return page;
+    }
+  }
+  return nullptr;
+}
+
+bool ParallelBufferPoolManager::DeletePageImpl(page_id_t page_id) {
+  // Delete page_id from responsible BufferPoolManagerInstance
+  return GetBufferPoolManager(page_id)->DeletePageImpl(page_id);
+}
+
+bool ParallelBufferPoolManager::DropTablespace(tablespace_id_t tablespace) {
+  // Claim the tablespace's pages in every instance before any of them is thrown away, so that a page pinned in one
+  // instance leaves the dirty pages in the others alone. Instances are claimed in order, which keeps concurrent drops
+  // from deadlocking, and stay latched until all of them are done.
+  size_t num_claimed = 0;
+  bool claimed_all = true;
+  while (claimed_all && num_claimed < instances_.size()) {
+    claimed_all = instances_[num_claimed++]->ClaimTablespace(tablespace);
+  }
+  for (size_t i = 0; i < num_claimed; ++i) {
+    if (claimed_all) {
+      instances_[i]->DiscardTablespace();
+    } else {
+      instances_[i]->ReleaseTablespace();
+    }
+  }
+  if (!claimed_all) {
+    return false;
+  }
+  disk_manager_->DropTablespace(tablespace);
+  return true;
+}
+
+void ParallelBufferPoolManager::FlushAllPagesImpl() {
+  // flush all pages from all BufferPoolManagerInstances
+  for (const auto &instance : instances_) {
+    instance->FlushAllPagesImpl();
+  }
+}
+
+}  // namespace bustub
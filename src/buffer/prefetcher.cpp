@@ -0,0 +1,141 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// prefetcher.cpp
+//
+// Identification: src/buffer/prefetcher.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/prefetcher.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+Prefetcher::Prefetcher(BufferPoolManager *bpm) : bpm_(bpm) {}
+
+Prefetcher::~Prefetcher() { Stop(); }
+
+void Prefetcher::PrefetchPage(page_id_t page_id, AccessType access_type) {
+  Enqueue(Request{page_id, 1, nullptr, access_type});
+}
+
+void Prefetcher::PrefetchRange(page_id_t first_page_id, size_t num_pages, AccessType access_type) {
+  // Whatever does not fit in the queue is dropped anyway.
+  num_pages = std::min(num_pages, static_cast<size_t>(PREFETCH_QUEUE_SIZE));
+  for (size_t i = 0; i < num_pages; ++i) {
+    Enqueue(Request{first_page_id + static_cast<page_id_t>(i), 1, nullptr, access_type});
+  }
+}
+
+void Prefetcher::PrefetchChain(page_id_t page_id, size_t depth, BufferPoolManager::next_page_fn next_page,
+                               AccessType access_type) {
+  Enqueue(Request{page_id, depth, std::move(next_page), access_type});
+}
+
+void Prefetcher::Stop() {
+  std::unique_lock lk{latch_};
+  stopped_ = true;
+  queue_.clear();
+  queued_.clear();
+  cv_.notify_all();
+  if (worker_.joinable()) {
+    std::thread worker = std::move(worker_);
+    lk.unlock();
+    worker.join();
+  }
+}
+
+void Prefetcher::Enqueue(Request request) {
+  if (request.page_id_ == INVALID_PAGE_ID || request.depth_ == 0) {
+    return;
+  }
+  std::scoped_lock lk{latch_};
+  if (stopped_ || queue_.size() >= static_cast<size_t>(PREFETCH_QUEUE_SIZE) ||
+      !queued_.insert(request.page_id_).second) {
+    return;
+  }
+  queue_.push_back(std::move(request));
+  if (!worker_.joinable()) {
+    worker_ = std::thread(&Prefetcher::Run, this);
+  }
+  cv_.notify_one();
+}
+
+void Prefetcher::Run() {
+  while (true) {
+    Request request;
+    std::vector<page_id_t> batch;
+    {
+      std::unique_lock lk{latch_};
+      cv_.wait(lk, [&] { return stopped_ || !queue_.empty(); });
+      if (stopped_) {
+        return;
+      }
+      request = std::move(queue_.front());
+      queue_.pop_front();
+      queued_.erase(request.page_id_);
+      // Single pages queued one after another, e.g. by PrefetchRange, are fetched together so that their reads can be
+      // merged or be in flight at once.
+      if (IsSinglePage(request)) {
+        batch.push_back(request.page_id_);
+        while (batch.size() < static_cast<size_t>(PREFETCH_BATCH_SIZE) && !queue_.empty() &&
+               IsSinglePage(queue_.front()) && queue_.front().access_type_ == request.access_type_) {
+          batch.push_back(queue_.front().page_id_);
+          queued_.erase(queue_.front().page_id_);
+          queue_.pop_front();
+        }
+      }
+    }
+
+    // A prefetch is only a hint. A page that cannot be read, because it is corrupt or its tablespace has been dropped
+    // since it was asked for, ends the request; whoever fetches the page for real is told why.
+    if (batch.size() > 1) {
+      try {
+        std::vector<Page *> pages = bpm_->FetchPages(batch, request.access_type_);
+        for (size_t i = 0; i < batch.size(); ++i) {
+          if (pages[i] != nullptr) {
+            bpm_->UnpinPage(batch[i], false);
+          }
+        }
+      } catch (const Exception &e) {
+        LOG_DEBUG("dropping a prefetch of %zu pages from page %d: %s", batch.size(), batch.front(), e.what());
+      }
+      continue;
+    }
+
+    page_id_t page_id = request.page_id_;
+    for (size_t i = 0; i < request.depth_ && page_id != INVALID_PAGE_ID; ++i) {
+      Page *page;
+      try {
+        page = bpm_->FetchPage(page_id, request.access_type_);
+      } catch (const Exception &e) {
+        LOG_DEBUG("dropping a prefetch of page %d: %s", page_id, e.what());
+        break;
+      }
+      if (page == nullptr) {
+        // Every frame is pinned; reading ahead would only get in the way.
+        break;
+      }
+      page_id_t next_page_id = INVALID_PAGE_ID;
+      if (request.next_page_ != nullptr) {
+        page->RLatch();
+        next_page_id = request.next_page_(page);
+        page->RUnlatch();
+      }
+      bpm_->UnpinPage(page_id, false);
+      page_id = next_page_id;
+    }
+  }
+}
+
+}  // namespace bustub
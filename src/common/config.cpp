@@ -20,4 +20,10 @@ std::chrono::duration<int64_t> log_timeout = std::chrono::seconds(1);
 
 std::chrono::milliseconds cycle_detection_interval = std::chrono::milliseconds(50);
 
+std::chrono::milliseconds bgwriter_interval = std::chrono::milliseconds(10);
+
+std::chrono::milliseconds hot_set_interval = std::chrono::milliseconds(60000);
+
+std::chrono::milliseconds scrubber_interval = std::chrono::milliseconds(100);
+
 }  // namespace bustub
@@ -0,0 +1,135 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c.cpp
+//
+// Identification: src/common/util/crc32c.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/crc32c.h"
+
+#ifdef __SSE4_2__
+#include <nmmintrin.h>
+#endif
+
+#include <array>
+#include <cstring>
+
+namespace bustub {
+
+namespace {
+
+/** The Castagnoli polynomial, bit-reversed. */
+constexpr uint32_t CRC32C_POLYNOMIAL = 0x82f63b78;
+
+/** @return the checksum of every possible byte, for the byte-at-a-time software implementation */
+constexpr std::array<uint32_t, 256> MakeTable() {
+  std::array<uint32_t, 256> table{};
+  for (uint32_t i = 0; i < 256; ++i) {
+    uint32_t crc = i;
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc >> 1) ^ ((crc & 1) != 0 ? CRC32C_POLYNOMIAL : 0);
+    }
+    table[i] = crc;
+  }
+  return table;
+}
+
+constexpr std::array<uint32_t, 256> CRC32C_TABLE = MakeTable();
+
+#ifdef __SSE4_2__
+/**
+ * Bytes covered by each of the three streams that ComputeHardware interleaves. The crc32 instruction takes three cycles
+ * but can start every cycle, so three independent streams keep it busy; their checksums are stitched together after.
+ */
+constexpr size_t STREAM_BYTES = 1360;
+
+/** Advances a crc state over STREAM_BYTES zero bytes, which is linear in the state: one table per byte of the state. */
+struct ShiftTable {
+  std::array<std::array<uint32_t, 256>, 4> tables_;
+};
+
+ShiftTable MakeShiftTable() {
+  // The images of the 32 single-bit states; every other state is a sum of those.
+  std::array<uint32_t, 32> basis;
+  for (int bit = 0; bit < 32; ++bit) {
+    uint64_t crc = uint64_t{1} << bit;
+    for (size_t i = 0; i < STREAM_BYTES; i += sizeof(uint64_t)) {
+      crc = _mm_crc32_u64(crc, 0);
+    }
+    basis[bit] = static_cast<uint32_t>(crc);
+  }
+  ShiftTable shift{};
+  for (int byte = 0; byte < 4; ++byte) {
+    for (uint32_t value = 0; value < 256; ++value) {
+      for (int bit = 0; bit < 8; ++bit) {
+        if ((value & (1U << bit)) != 0) {
+          shift.tables_[byte][value] ^= basis[byte * 8 + bit];
+        }
+      }
+    }
+  }
+  return shift;
+}
+
+uint32_t Shift(const ShiftTable &shift, uint32_t crc) {
+  return shift.tables_[0][crc & 0xff] ^ shift.tables_[1][(crc >> 8) & 0xff] ^ shift.tables_[2][(crc >> 16) & 0xff] ^
+         shift.tables_[3][crc >> 24];
+}
+
+uint64_t LoadWord(const char *data) {
+  uint64_t word;
+  memcpy(&word, data, sizeof(word));
+  return word;
+}
+#endif
+
+}  // namespace
+
+uint32_t Crc32c::ComputeSoftware(const char *data, size_t length, uint32_t crc) {
+  crc = ~crc;
+  for (size_t i = 0; i < length; ++i) {
+    crc = CRC32C_TABLE[(crc ^ static_cast<uint8_t>(data[i])) & 0xff] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+uint32_t Crc32c::ComputeHardware(const char *data, size_t length, uint32_t crc) {
+#ifdef __SSE4_2__
+  uint32_t crc32 = ~crc;
+  if (length >= 3 * STREAM_BYTES) {
+    static const ShiftTable SHIFT = MakeShiftTable();
+    for (; length >= 3 * STREAM_BYTES; data += 3 * STREAM_BYTES, length -= 3 * STREAM_BYTES) {
+      uint64_t crc_a = crc32;
+      uint64_t crc_b = 0;
+      uint64_t crc_c = 0;
+      for (size_t i = 0; i < STREAM_BYTES; i += sizeof(uint64_t)) {
+        crc_a = _mm_crc32_u64(crc_a, LoadWord(data + i));
+        crc_b = _mm_crc32_u64(crc_b, LoadWord(data + STREAM_BYTES + i));
+        crc_c = _mm_crc32_u64(crc_c, LoadWord(data + 2 * STREAM_BYTES + i));
+      }
+      // Checksumming a || b from state s is the same as checksumming a from s, moving on over |b| zero bytes, and
+      // adding the checksum of b from state 0.
+      crc32 = Shift(SHIFT, Shift(SHIFT, crc_a) ^ crc_b) ^ crc_c;
+    }
+  }
+  uint64_t crc64 = crc32;
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)) {
+    crc64 = _mm_crc32_u64(crc64, LoadWord(data + i));
+  }
+  crc32 = static_cast<uint32_t>(crc64);
+  for (; i < length; ++i) {
+    crc32 = _mm_crc32_u8(crc32, static_cast<uint8_t>(data[i]));
+  }
+  return ~crc32;
+#else
+  return ComputeSoftware(data, length, crc);
+#endif
+}
+
+}  // namespace bustub
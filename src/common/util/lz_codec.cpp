@@ -0,0 +1,177 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lz_codec.cpp
+//
+// Identification: src/common/util/lz_codec.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/lz_codec.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace bustub {
+
+namespace {
+
+/** Shortest back reference worth encoding; shorter repeats are cheaper as literals. */
+constexpr size_t MIN_MATCH = 4;
+/** Farthest back a reference can point, as offsets take 2 bytes. */
+constexpr size_t MAX_OFFSET = 65535;
+constexpr int HASH_BITS = 12;
+/** A search that keeps missing skips ahead faster, by one more byte every 2^SKIP_SHIFT misses. */
+constexpr int SKIP_SHIFT = 6;
+
+uint32_t Load32(const char *p) {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+uint32_t Hash(uint32_t sequence) { return (sequence * 2654435761U) >> (32 - HASH_BITS); }
+
+/** Append a length that did not fit in its nibble: runs of 255, then the rest. */
+char *PutExtraLength(char *op, size_t length) {
+  while (length >= 255) {
+    *op++ = static_cast<char>(255);
+    length -= 255;
+  }
+  *op++ = static_cast<char>(length);
+  return op;
+}
+
+/**
+ * Append a sequence of literals and, unless match_length is 0, a back reference.
+ * @return the end of the sequence, nullptr if it does not fit before op_end
+ */
+char *PutSequence(char *op, const char *op_end, const char *literals, size_t num_literals, size_t offset,
+                  size_t match_length) {
+  size_t worst = 1 + num_literals / 255 + 1 + num_literals + 2 + match_length / 255 + 1;
+  if (static_cast<size_t>(op_end - op) < worst) {
+    return nullptr;
+  }
+  size_t extra_match = match_length == 0 ? 0 : match_length - MIN_MATCH;
+  *op++ = static_cast<char>((std::min<size_t>(num_literals, 15) << 4) | std::min<size_t>(extra_match, 15));
+  if (num_literals >= 15) {
+    op = PutExtraLength(op, num_literals - 15);
+  }
+  memcpy(op, literals, num_literals);
+  op += num_literals;
+  if (match_length == 0) {
+    return op;
+  }
+  *op++ = static_cast<char>(offset & 0xff);
+  *op++ = static_cast<char>(offset >> 8);
+  if (extra_match >= 15) {
+    op = PutExtraLength(op, extra_match - 15);
+  }
+  return op;
+}
+
+/**
+ * Read a length that did not fit in its nibble and add it to length.
+ * @return false if the input ends first
+ */
+bool GetExtraLength(const unsigned char **ip, const unsigned char *end, size_t *length) {
+  unsigned char byte;
+  do {
+    if (*ip == end) {
+      return false;
+    }
+    byte = *(*ip)++;
+    *length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+}  // namespace
+
+size_t LzCodec::Compress(const char *src, size_t size, char *dst, size_t capacity) {
+  // Positions + 1 of the last sequence seen with each hash, 0 for none.
+  std::array<uint32_t, 1 << HASH_BITS> table{};
+  char *op = dst;
+  const char *op_end = dst + capacity;
+  size_t anchor = 0;
+  size_t pos = 0;
+  while (pos + MIN_MATCH <= size) {
+    uint32_t sequence = Load32(src + pos);
+    uint32_t &entry = table[Hash(sequence)];
+    size_t candidate = entry;
+    entry = static_cast<uint32_t>(pos + 1);
+    if (candidate == 0 || pos + 1 - candidate > MAX_OFFSET || Load32(src + candidate - 1) != sequence) {
+      pos += 1 + ((pos - anchor) >> SKIP_SHIFT);
+      continue;
+    }
+    candidate--;
+    size_t match_length = MIN_MATCH;
+    while (pos + match_length < size && src[candidate + match_length] == src[pos + match_length]) {
+      match_length++;
+    }
+    op = PutSequence(op, op_end, src + anchor, pos - anchor, pos - candidate, match_length);
+    if (op == nullptr) {
+      return 0;
+    }
+    pos += match_length;
+    anchor = pos;
+  }
+  if (anchor < size || op == dst) {
+    op = PutSequence(op, op_end, src + anchor, size - anchor, 0, 0);
+    if (op == nullptr) {
+      return 0;
+    }
+  }
+  return op - dst;
+}
+
+bool LzCodec::Decompress(const char *src, size_t size, char *dst, size_t original_size) {
+  const auto *ip = reinterpret_cast<const unsigned char *>(src);
+  const unsigned char *end = ip + size;
+  size_t out = 0;
+  while (ip < end) {
+    unsigned char token = *ip++;
+    size_t num_literals = token >> 4;
+    if (num_literals == 15 && !GetExtraLength(&ip, end, &num_literals)) {
+      return false;
+    }
+    if (num_literals > static_cast<size_t>(end - ip) || num_literals > original_size - out) {
+      return false;
+    }
+    memcpy(dst + out, ip, num_literals);
+    ip += num_literals;
+    out += num_literals;
+    if (ip == end) {
+      break;
+    }
+    if (end - ip < 2) {
+      return false;
+    }
+    size_t offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+    ip += 2;
+    size_t match_length = (token & 0xf) + MIN_MATCH;
+    if ((token & 0xf) == 15 && !GetExtraLength(&ip, end, &match_length)) {
+      return false;
+    }
+    if (offset == 0 || offset > out || match_length > original_size - out) {
+      return false;
+    }
+    // A match may overlap the bytes it produces, e.g. a run of one byte has offset 1, so copy front to back.
+    const char *match = dst + out - offset;
+    if (offset >= match_length) {
+      memcpy(dst + out, match, match_length);
+    } else {
+      for (size_t i = 0; i < match_length; ++i) {
+        dst[out + i] = match[i];
+      }
+    }
+    out += match_length;
+  }
+  return out == original_size;
+}
+
+}  // namespace bustub
@@ -12,43 +12,58 @@
 
 #pragma once
 
-#include <list>
-#include <mutex>  // NOLINT
-#include <unordered_map>
+#include <functional>
+#include <string>
+#include <vector>
 
-#include "buffer/lru_replacer.h"
-#include "storage/disk/disk_manager.h"
+#include "buffer/buffer_pool_stats.h"
+#include "buffer/replacer.h"
+#include "common/exception.h"
 #include "recovery/log_manager.h"
-#include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_interface.h"
 #include "storage/page/page.h"
+#include "storage/page/page_guard.h"
 
 namespace bustub {
 
 /**
- * BufferPoolManager reads disk pages to and from its internal buffer pool.
+ * BufferPoolManager reads disk pages to and from its internal buffer pool. This is the interface that the rest of
+ * the system (table heaps, indexes, executors) programs against; see BufferPoolManagerInstance for a single pool and
+ * ParallelBufferPoolManager for a pool that is sharded across several instances.
  */
 class BufferPoolManager {
  public:
   enum class CallbackType { BEFORE, AFTER };
   using bufferpool_callback_fn = void (*)(enum CallbackType, const page_id_t page_id);
+  /** Reads the id of the next page of a chain (table heap, leaf level of an index) out of a page. */
+  using next_page_fn = std::function<page_id_t(Page *page)>;
 
-  /**
-   * Creates a new BufferPoolManager.
-   * @param pool_size the size of the buffer pool
-   * @param disk_manager the disk manager
-   * @param log_manager the log manager (for testing only: nullptr = disable logging)
-   */
-  BufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr);
+  BufferPoolManager() = default;
 
   /**
    * Destroys an existing BufferPoolManager.
    */
-  ~BufferPoolManager();
+  virtual ~BufferPoolManager() = default;
 
   /** Grading function. Do not modify! */
   Page *FetchPage(page_id_t page_id, bufferpool_callback_fn callback = nullptr) {
     GradingCallback(callback, CallbackType::BEFORE, page_id);
-    auto *result = FetchPageImpl(page_id);
+    auto *result = FetchPageImpl(page_id, AccessType::Unknown);
+    GradingCallback(callback, CallbackType::AFTER, page_id);
+    return result;
+  }
+
+  /**
+   * Fetch the requested page, telling the buffer pool how it is going to be used.
+   * @param page_id id of page to be fetched
+   * @param access_type how the page is accessed; pages fetched for a Scan are recycled through a small ring of frames
+   * @param callback callback function to be invoked
+   * @return the requested page
+   * @throws Exception of type CORRUPTION if the page read from disk does not match its checksum
+   */
+  Page *FetchPage(page_id_t page_id, AccessType access_type, bufferpool_callback_fn callback = nullptr) {
+    GradingCallback(callback, CallbackType::BEFORE, page_id);
+    auto *result = FetchPageImpl(page_id, access_type);
     GradingCallback(callback, CallbackType::AFTER, page_id);
     return result;
   }
@@ -92,13 +107,167 @@ class BufferPoolManager {
     GradingCallback(callback, CallbackType::AFTER, INVALID_PAGE_ID);
   }
 
-  /** @return pointer to all the pages in the buffer pool */
-  Page *GetPages() { return pages_; }
+  /**
+   * Fetch the requested page and wrap its pin in a guard that unpins it on scope exit.
+   * @param page_id id of page to be fetched
+   * @param access_type how the page is accessed
+   * @return a guard holding the page, invalid if the page could not be fetched
+   */
+  BasicPageGuard FetchPageBasic(page_id_t page_id, AccessType access_type = AccessType::Unknown) {
+    return {this, FetchPageImpl(page_id, access_type)};
+  }
+
+  /**
+   * Fetch the requested page and read-latch it. The guard unlatches and unpins it on scope exit.
+   * @param page_id id of page to be fetched
+   * @param access_type how the page is accessed
+   * @return a guard holding the page, invalid if the page could not be fetched
+   */
+  ReadPageGuard FetchPageRead(page_id_t page_id, AccessType access_type = AccessType::Unknown) {
+    auto *page = FetchPageImpl(page_id, access_type);
+    if (page != nullptr) {
+      page->RLatch();
+    }
+    return {this, page};
+  }
+
+  /**
+   * Fetch the requested page and write-latch it. The guard unlatches and unpins it on scope exit.
+   * @param page_id id of page to be fetched
+   * @param access_type how the page is accessed
+   * @return a guard holding the page, invalid if the page could not be fetched
+   */
+  WritePageGuard FetchPageWrite(page_id_t page_id, AccessType access_type = AccessType::Unknown) {
+    auto *page = FetchPageImpl(page_id, access_type);
+    if (page != nullptr) {
+      page->WLatch();
+    }
+    return {this, page};
+  }
+
+  /**
+   * Create a new page and wrap its pin in a guard that unpins it on scope exit.
+   * @param[out] page_id id of created page
+   * @return a guard holding the page, invalid if no new page could be created
+   */
+  BasicPageGuard NewPageGuarded(page_id_t *page_id) { return {this, NewPageImpl(page_id)}; }
+
+  /**
+   * Create a new page in a tablespace, e.g. the one of the table or index the page belongs to.
+   * @param[out] page_id id of created page
+   * @param tablespace the tablespace to allocate the page in
+   * @param near_page_id a page the new one should be stored next to, e.g. the last page of the same table;
+   * INVALID_PAGE_ID for none
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPage(page_id_t *page_id, tablespace_id_t tablespace, page_id_t near_page_id = INVALID_PAGE_ID) {
+    return NewPageImpl(page_id, tablespace, near_page_id);
+  }
+
+  /**
+   * Create a tablespace on the disk below the buffer pool.
+   * @param file_name where to keep its pages; empty to let the disk choose
+   * @return the id of the new tablespace
+   */
+  virtual tablespace_id_t CreateTablespace(const std::string &file_name) = 0;
+
+  /**
+   * Drop a tablespace: throw away its pages in the buffer pool, dirty or not, and then drop it on disk. Nothing may use
+   * its pages any more.
+   * @param tablespace the tablespace to drop
+   * @return false if some of its pages are still pinned, in which case nothing is changed: none of its pages is thrown
+   * away, and the tablespace is left on disk
+   */
+  virtual bool DropTablespace(tablespace_id_t tablespace) = 0;
+
+  /**
+   * Fetch several pages at once, e.g. the pages of a list of RIDs. Each page that is returned is pinned once per time
+   * it is asked for, and must be unpinned as often.
+   * @param page_ids ids of the pages to fetch, in any order and possibly repeated
+   * @param access_type how the pages are accessed
+   * @return the pages in the order they were asked for; nullptr for each page that could not be fetched
+   * @throws Exception of type CORRUPTION if a page read from disk does not match its checksum; nothing stays pinned
+   */
+  virtual std::vector<Page *> FetchPages(const std::vector<page_id_t> &page_ids,
+                                         AccessType access_type = AccessType::Unknown) {
+    std::vector<Page *> pages;
+    pages.reserve(page_ids.size());
+    try {
+      for (page_id_t page_id : page_ids) {
+        pages.push_back(FetchPageImpl(page_id, access_type));
+      }
+    } catch (const Exception &) {
+      UnpinPages(page_ids, pages);
+      throw;
+    }
+    return pages;
+  }
 
   /** @return size of the buffer pool */
-  size_t GetPoolSize() { return pool_size_; }
+  virtual size_t GetPoolSize() = 0;
+
+  /**
+   * Grow or shrink the buffer pool while it is in use. Shrinking writes back and drops unpinned pages right away;
+   * frames that are pinned leave the pool as they are unpinned, so the pool may briefly hold more pages than asked.
+   * @param pool_size the new number of frames, rounded up to what the pool can allocate at a time
+   * @return false if the pool cannot be resized to that size
+   */
+  virtual bool Resize(size_t pool_size) = 0;
+
+  /**
+   * Write the ids of the pages in the buffer pool to a file, most recently used first, so that a later LoadHotSet can
+   * bring them back. Only the ids are saved; dirty pages are not written back.
+   * @param file_name the file to save the hot set to
+   * @return false if the file could not be written
+   */
+  virtual bool SaveHotSet(const std::string &file_name) = 0;
+
+  /**
+   * Read back the pages listed by SaveHotSet, in page id order and in parallel, and leave them in the replacer in
+   * the order they were saved in. Meant to be called on startup, before the pool is used.
+   * @param file_name the file the hot set was saved to
+   * @return the number of pages read in; 0 if the file is missing or corrupt
+   */
+  virtual size_t LoadHotSet(const std::string &file_name) = 0;
+
+  /**
+   * Take a snapshot of the buffer pool's counters.
+   * @param num_hot_pages how many of the most fetched pages to include, if page heat is sampled
+   * @return the statistics
+   */
+  virtual BufferPoolStats GetStats(size_t num_hot_pages = 10) = 0;
+
+  /**
+   * Start or stop estimating how often each page is fetched, which GetStats reports as hot pages.
+   * @param sample_rate count one in this many fetches per thread, 0 to stop
+   */
+  virtual void SetPageHeatSampling(size_t sample_rate) = 0;
+
+  /**
+   * Start reading a page into the buffer pool in the background. Returns right away; the page is not pinned.
+   * @param page_id id of the page to read
+   * @param access_type how the page will be accessed once it is fetched
+   */
+  virtual void PrefetchPage(page_id_t page_id, AccessType access_type = AccessType::Unknown) = 0;
+
+  /**
+   * Start reading num_pages consecutive pages, beginning with first_page_id, in the background.
+   * @param first_page_id id of the first page to read
+   * @param num_pages number of pages to read
+   * @param access_type how the pages will be accessed once they are fetched
+   */
+  virtual void PrefetchRange(page_id_t first_page_id, size_t num_pages, AccessType access_type = AccessType::Scan) = 0;
+
+  /**
+   * Start reading up to depth pages of a chain in the background, following next_page from page_id on.
+   * @param page_id id of the first page of the chain
+   * @param depth maximum number of pages to read
+   * @param next_page reads the id of the next page out of a page, INVALID_PAGE_ID at the end of the chain
+   * @param access_type how the pages will be accessed once they are fetched
+   */
+  virtual void PrefetchChain(page_id_t page_id, size_t depth, next_page_fn next_page,
+                             AccessType access_type = AccessType::Scan) = 0;
 
- //protected:
   /**
    * Grading function. Do not modify!
    * Invokes the callback function if it is not null.
@@ -115,9 +284,10 @@ class BufferPoolManager {
   /**
    * Fetch the requested page from the buffer pool.
    * @param page_id id of page to be fetched
+   * @param access_type how the page is accessed
    * @return the requested page
    */
-  Page *FetchPageImpl(page_id_t page_id);
+  virtual Page *FetchPageImpl(page_id_t page_id, AccessType access_type) = 0;
 
   /**
    * Unpin the target page from the buffer pool.
@@ -125,49 +295,64 @@ class BufferPoolManager {
    * @param is_dirty true if the page should be marked as dirty, false otherwise
    * @return false if the page pin count is <= 0 before this call, true otherwise
    */
-  bool UnpinPageImpl(page_id_t page_id, bool is_dirty);
+  virtual bool UnpinPageImpl(page_id_t page_id, bool is_dirty) = 0;
 
   /**
    * Flushes the target page to disk.
    * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
    * @return false if the page could not be found in the page table, true otherwise
    */
-  bool FlushPageImpl(page_id_t page_id);
+  virtual bool FlushPageImpl(page_id_t page_id) = 0;
 
   /**
    * Creates a new page in the buffer pool.
    * @param[out] page_id id of created page
+   * @param tablespace the tablespace to allocate the page in
+   * @param near_page_id a page the new one should be stored next to, INVALID_PAGE_ID for none
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  virtual Page *NewPageImpl(page_id_t *page_id, tablespace_id_t tablespace, page_id_t near_page_id) = 0;
+
+  /**
+   * Creates a new page in a tablespace, wherever there is room.
+   * @param[out] page_id id of created page
+   * @param tablespace the tablespace to allocate the page in
    * @return nullptr if no new pages could be created, otherwise pointer to new page
    */
-  Page *NewPageImpl(page_id_t *page_id);
+  Page *NewPageImpl(page_id_t *page_id, tablespace_id_t tablespace) {
+    return NewPageImpl(page_id, tablespace, INVALID_PAGE_ID);
+  }
+
+  /**
+   * Creates a new page in the default tablespace.
+   * @param[out] page_id id of created page
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPageImpl(page_id_t *page_id) { return NewPageImpl(page_id, DEFAULT_TABLESPACE, INVALID_PAGE_ID); }
 
   /**
    * Deletes a page from the buffer pool.
    * @param page_id id of page to be deleted
    * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
    */
-  bool DeletePageImpl(page_id_t page_id);
+  virtual bool DeletePageImpl(page_id_t page_id) = 0;
 
   /**
    * Flushes all the pages in the buffer pool to disk.
    */
-  void FlushAllPagesImpl();
-private:
-  /** Number of pages in the buffer pool. */
-  size_t pool_size_;
-  /** Array of buffer pool pages. */
-  Page *pages_;
-  /** Pointer to the disk manager. */
-  DiskManager *disk_manager_ __attribute__((__unused__));
-  /** Pointer to the log manager. */
-  LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
-  /** Replacer to find unpinned pages for replacement. */
-  Replacer *replacer_;
-  /** List of free pages. */
-  std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
-  std::mutex latch_;
+  virtual void FlushAllPagesImpl() = 0;
+
+  /**
+   * Unpin the pages a batched fetch got, e.g. when it has to give up part way through.
+   * @param page_ids ids of the pages that were asked for
+   * @param pages what was returned for the first pages.size() of them
+   */
+  void UnpinPages(const std::vector<page_id_t> &page_ids, const std::vector<Page *> &pages) {
+    for (size_t i = 0; i < pages.size(); ++i) {
+      if (pages[i] != nullptr) {
+        UnpinPageImpl(page_ids[i], false);
+      }
+    }
+  }
 };
 }  // namespace bustub
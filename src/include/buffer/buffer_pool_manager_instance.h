@@ -0,0 +1,570 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_manager_instance.h
+//
+// Identification: src/include/buffer/buffer_pool_manager_instance.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <exception>
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_stats.h"
+#include "buffer/frame_arena.h"
+#include "buffer/page_table.h"
+#include "buffer/prefetcher.h"
+#include "buffer/replacer.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/async_disk_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * BufferPoolManagerInstance reads disk pages to and from its internal buffer pool. Misses, new pages, deletes and
+ * flushes are serialized by a single latch; ParallelBufferPoolManager shards pages across several instances to spread
+ * that latch out.
+ *
+ * Fetching a page that is already in the pool, and unpinning it, do not take the latch. The page table can be read
+ * concurrently with its updates, and frames are pinned with a compare-and-swap on the pin count. A frame can only be
+ * given to another page by claiming it, i.e. swapping its pin count from 0 to -1. So once a lookup has pinned a frame
+ * and seen the page it wanted in it, the page stays there until it is unpinned.
+ *
+ * The latch is never held across disk I/O. A frame that is being written back or read in is marked as having I/O in
+ * progress: it is already mapped to its new page and pinned, and any other thread that wants either the old or the
+ * new page waits on that frame's condition variable instead of on the whole pool.
+ *
+ * Misses on pages fetched with AccessType::Scan do not take victims from the whole pool. They recycle a small ring of
+ * frames instead, so a scan over a table much larger than the pool leaves everybody else's pages in place.
+ *
+ * The frames are allocated in chunks of the initial pool size, and Resize adds or retires whole chunks. A retired
+ * chunk hands out no more frames; its unpinned pages are written back and dropped at once, and its pinned pages as
+ * they are unpinned. The chunk is freed once it is empty and no lookup that bypassed the latch can still be reading
+ * it.
+ *
+ * The ids of the resident pages can be saved to a hot set file, hottest first, and read back on startup so that the
+ * pool does not start out cold. Given a hot set file, the pool saves it periodically and when it is destroyed.
+ *
+ * An optional background writer keeps a fraction of the evictable frames clean, so that a miss rarely has to write a
+ * dirty victim back before it can read its own page. It pins the pages it writes but leaves them in the replacer, so
+ * it does not disturb the replacement order; a victim the writer is still holding is skipped.
+ */
+class BufferPoolManagerInstance : public BufferPoolManager {
+ public:
+  /**
+   * Creates a new BufferPoolManagerInstance.
+   * @param pool_size the size of the buffer pool
+   * @param disk_manager the disk manager
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy used to pick victims
+   */
+  BufferPoolManagerInstance(size_t pool_size, DiskInterface *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::LRU);
+
+  /**
+   * Creates a new BufferPoolManagerInstance that is one shard of a ParallelBufferPoolManager.
+   * @param pool_size the size of the buffer pool
+   * @param num_instances total number of BPIs in the parallel BPM
+   * @param instance_index index of this BPI in the parallel BPM
+   * @param disk_manager the disk manager
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy used to pick victims
+   */
+  BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                            DiskInterface *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::LRU);
+
+  /**
+   * Destroys an existing BufferPoolManagerInstance.
+   */
+  ~BufferPoolManagerInstance() override;
+
+  void PrefetchPage(page_id_t page_id, AccessType access_type = AccessType::Unknown) override;
+
+  void PrefetchRange(page_id_t first_page_id, size_t num_pages, AccessType access_type = AccessType::Scan) override;
+
+  void PrefetchChain(page_id_t page_id, size_t depth, next_page_fn next_page,
+                     AccessType access_type = AccessType::Scan) override;
+
+  /** @return size of the buffer pool */
+  size_t GetPoolSize() override { return pool_size_; }
+
+  /**
+   * Grow or shrink the buffer pool by whole chunks of the initial pool size.
+   * @param pool_size the new number of frames, rounded up to a multiple of the initial pool size
+   * @return false if that is zero or more than BUFFER_POOL_MAX_CHUNKS chunks
+   */
+  bool Resize(size_t pool_size) override;
+
+  /** @return pointer to the first chunk of pages in the buffer pool, i.e. all of them unless the pool was resized */
+  Page *GetPages() { return chunks_[0].load()->pages_.get(); }
+
+  /**
+   * Start the background writer. Every bgwriter_interval, or sooner when an eviction had to write back a dirty victim,
+   * it writes dirty unpinned pages in page id order until at least clean_fraction of the unpinned frames are clean.
+   * With logging enabled, pages whose LSN is not yet persistent in the log are left alone.
+   * @param clean_fraction the fraction of evictable frames to keep clean
+   */
+  void RunBackgroundWriter(double clean_fraction = BGWRITER_CLEAN_FRACTION);
+
+  /**
+   * Stop the background writer, waiting for the round it is in to finish.
+   */
+  void StopBackgroundWriter();
+
+  /**
+   * Send the I/O that comes in batches through an async disk manager, so that a batch is in flight at once rather than
+   * one page at a time: the reads of FetchPages and of the prefetcher, and the writes of the background writer and of
+   * flushes. Set it before the pool is used.
+   * @param async_disk_manager an async disk manager for the same file as the disk manager, nullptr to use the latter
+   */
+  void SetAsyncDiskManager(AsyncDiskManager *async_disk_manager) { async_disk_manager_ = async_disk_manager; }
+
+  bool SaveHotSet(const std::string &file_name) override;
+
+  size_t LoadHotSet(const std::string &file_name) override;
+
+  /**
+   * Keep a hot set file up to date: save it every hot_set_interval while the background writer runs, and flush every
+   * page and save it once more when the pool is destroyed.
+   * @param file_name the file to save the hot set to, empty to stop saving it
+   */
+  void SetHotSetFile(const std::string &file_name);
+
+  /** @return the ids of the resident pages: pinned pages first, then the rest in the order the replacer values them */
+  std::vector<page_id_t> GetHotSet();
+
+  /**
+   * Read pages into the pool, in page id order on several threads, then touch them so that the replacer ends up
+   * ranking them in the given order. Pages that belong to another instance, and pages beyond the pool size, are left
+   * out. Pages that cannot be read, e.g. because they are corrupt, are skipped.
+   * @param page_ids the pages to read, hottest first
+   * @return the number of pages read
+   */
+  size_t WarmUp(const std::vector<page_id_t> &page_ids);
+
+  BufferPoolStats GetStats(size_t num_hot_pages = 10) override;
+
+  void SetPageHeatSampling(size_t sample_rate) override;
+
+  tablespace_id_t CreateTablespace(const std::string &file_name) override {
+    return disk_manager_->CreateTablespace(file_name);
+  }
+
+  bool DropTablespace(tablespace_id_t tablespace) override;
+
+  /**
+   * Claim the frames of all the pages of a tablespace that are in this pool, so that nobody can pin them, as the first
+   * step of dropping the tablespace. Takes latch_, which stays held until DiscardTablespace or ReleaseTablespace is
+   * called, whether the claim succeeds or not; in between, this pool is frozen.
+   * @param tablespace the tablespace
+   * @return false if some of its pages are pinned, which includes pages with I/O in progress
+   */
+  bool ClaimTablespace(tablespace_id_t tablespace);
+
+  /** Give back the frames claimed by ClaimTablespace, leaving their pages as they were, and release latch_. */
+  void ReleaseTablespace();
+
+  /** Throw away the pages claimed by ClaimTablespace, dirty or not, without going to the disk, and release latch_. */
+  void DiscardTablespace();
+
+  /** @return number of evictions that found a clean victim */
+  size_t GetNumCleanVictims() const { return counters_.Get(BufferPoolCounter::CLEAN_EVICTIONS); }
+
+  /** @return number of evictions that had to write back a dirty victim */
+  size_t GetNumDirtyVictims() const { return counters_.Get(BufferPoolCounter::DIRTY_EVICTIONS); }
+
+  /** @return number of pages written by the background writer */
+  size_t GetNumBackgroundWrites() const { return counters_.Get(BufferPoolCounter::BACKGROUND_WRITES); }
+
+  /**
+   * Fetch the requested page from the buffer pool.
+   * @param page_id id of page to be fetched
+   * @param access_type how the page is accessed
+   * @return the requested page
+   */
+  Page *FetchPageImpl(page_id_t page_id, AccessType access_type) override;
+
+  /**
+   * Fetch several pages at once. The pages that are in the pool are pinned without the latch; the others are mapped
+   * to frames under a single acquisition of it and then read in together, sorted by page id, so that the disk manager
+   * can merge adjacent reads.
+   * @param page_ids ids of the pages to fetch, in any order and possibly repeated
+   * @param access_type how the pages are accessed
+   * @return the pages in the order they were asked for; nullptr for each page that could not be fetched
+   */
+  std::vector<Page *> FetchPages(const std::vector<page_id_t> &page_ids,
+                                 AccessType access_type = AccessType::Unknown) override;
+
+  /**
+   * Unpin the target page from the buffer pool.
+   * @param page_id id of page to be unpinned
+   * @param is_dirty true if the page should be marked as dirty, false otherwise
+   * @return false if the page pin count is <= 0 before this call, true otherwise
+   */
+  bool UnpinPageImpl(page_id_t page_id, bool is_dirty) override;
+
+  /**
+   * Flushes the target page to disk.
+   * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
+   * @return false if the page could not be found in the page table, true otherwise
+   */
+  bool FlushPageImpl(page_id_t page_id) override;
+
+  using BufferPoolManager::NewPageImpl;
+
+  /**
+   * Creates a new page in the buffer pool.
+   * @param[out] page_id id of created page
+   * @param tablespace the tablespace to allocate the page in
+   * @param near_page_id a page the new one should be stored next to, INVALID_PAGE_ID for none
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPageImpl(page_id_t *page_id, tablespace_id_t tablespace, page_id_t near_page_id) override;
+
+  /**
+   * Deletes a page from the buffer pool.
+   * @param page_id id of page to be deleted
+   * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
+   */
+  bool DeletePageImpl(page_id_t page_id) override;
+
+  /**
+   * Flushes all the pages in the buffer pool to disk.
+   */
+  void FlushAllPagesImpl() override;
+
+ private:
+  /** A page that has been mapped to a frame under latch_, but has not been read in yet. */
+  struct PendingRead {
+    page_id_t page_id_;
+    frame_id_t frame_id_;
+    /** The page that was in the frame before, INVALID_PAGE_ID if none. */
+    page_id_t victim_page_id_;
+    /** Whether the victim has to be written back before the frame can be read into. */
+    bool write_back_;
+  };
+
+  /**
+   * Pin a page if it is in the pool, without taking latch_. Waits if the page is still being read in.
+   * @param page_id id of the page
+   * @param access_type how the page is accessed
+   * @return the pinned page, nullptr if it is not in the pool
+   */
+  Page *FetchResidentPage(page_id_t page_id, AccessType access_type);
+
+  /**
+   * Pin a page if it is in the pool, waiting out any I/O on it; otherwise take a frame for it, map the page to it and
+   * mark it as having I/O in progress. Must be called with latch_ held through lock.
+   * @param page_id id of the page
+   * @param access_type how the page is accessed
+   * @param lock the held latch_, released while waiting
+   * @param[out] read the read CompleteReads has to do; its frame_id_ is -1 if the page was in the pool
+   * @return the pinned page, nullptr if every frame is pinned
+   */
+  Page *PinOrMapPage(page_id_t page_id, AccessType access_type, std::unique_lock<TimedMutex> *lock,
+                     PendingRead *read);
+
+  /**
+   * Write back the victims of mapped frames, read the pages into them, and finish their I/O. Must be called with
+   * latch_ held through lock; it is released for the I/O. A page that does not match its checksum is taken out of the
+   * page table again and its frame's page id reset, so that every thread holding a pin on the frame can tell; each of
+   * them has to give its pin back with ReleasePin. If the I/O fails in any other way, e.g. because the tablespace of a
+   * page does not exist, every page of the batch is dealt with the same way. If it is the write-back of the victims
+   * that fails, nothing is read, and each victim is mapped back into its frame, still dirty, rather than lost.
+   * @param reads the reads to do, sorted by page id; cleared on return
+   * @param lock the held latch_
+   * @param[out] corrupt_frames if not null, receives the frames of the pages that did not match their checksums or
+   * could not be read
+   * @return the error the I/O failed with other than a checksum mismatch, for the caller to rethrow once it has given
+   * back its pins; nullptr if there was none
+   */
+  std::exception_ptr CompleteReads(std::vector<PendingRead> *reads, std::unique_lock<TimedMutex> *lock,
+                                   std::vector<frame_id_t> *corrupt_frames = nullptr);
+
+  /** Give up a pin on a frame, draining the frame if it is retiring. Must be called without latch_. */
+  void ReleasePin(frame_id_t frame_id);
+
+  /** Read several pages, in parallel if there is an async disk manager. Throws if any of them fails. */
+  void ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data);
+
+  /** Write several pages, in parallel if there is an async disk manager. Throws if any of them fails. */
+  void WritePages(const std::vector<page_id_t> &page_ids, const std::vector<const char *> &page_data);
+
+  /**
+   * Must be called with latch_ held.
+   * @param page_id id of the page
+   * @return true if PinOrMapPage would have to wait for I/O on the page or on its write-back
+   */
+  bool MustWaitForIO(page_id_t page_id);
+
+  /**
+   * Allocate a page on disk. When this instance is a shard, only ids that map back to this shard are handed out.
+   * @param tablespace the tablespace to allocate the page in
+   * @param near_page_id a page the new one should be stored next to, INVALID_PAGE_ID for none
+   * @return the id of the allocated page
+   */
+  page_id_t AllocatePage(tablespace_id_t tablespace, page_id_t near_page_id);
+
+  /**
+   * Take a frame from the free list, or failing that from the replacer. Frames of retired chunks that come out of the
+   * replacer are retired on the way if they are clean, and passed over if they are dirty. Must be called with latch_
+   * held.
+   * @param[out] frame_id the frame that can be reused
+   * @return false if every frame is pinned
+   */
+  bool FindFreeFrame(frame_id_t *frame_id);
+
+  /**
+   * Take a frame for a page that is being scanned: the next frame of the scan ring if it is not in use, otherwise a
+   * frame from FindFreeFrame that then joins the ring. Must be called with latch_ held.
+   * @param[out] frame_id the frame that can be reused
+   * @return false if every frame is pinned
+   */
+  bool FindScanFrame(frame_id_t *frame_id);
+
+  /**
+   * Pin a frame unless it is free or being handed to another page. Safe without latch_.
+   * @param page the frame to pin
+   * @return false if the frame could not be pinned
+   */
+  bool TryPin(Page *page);
+
+  /**
+   * Take over an unpinned frame so that nobody can pin it any more. Must be called with latch_ held.
+   * @param page the frame to claim
+   * @return false if the frame is pinned
+   */
+  bool ClaimFrame(Page *page);
+
+  /**
+   * Drop one pin on a frame, and hand the frame to the replacer if that was the last one. Safe without latch_.
+   * @param frame_id the frame to unpin
+   * @return false if the frame was not pinned
+   */
+  bool UnpinFrame(frame_id_t frame_id) { return UnpinFrame(frame_id, GetFrame(frame_id)); }
+
+  /**
+   * Drop one pin on a frame that has already been looked up, as by FindFrame. Safe without latch_.
+   * @param frame_id the frame to unpin
+   * @param page the frame
+   * @return false if the frame was not pinned
+   */
+  bool UnpinFrame(frame_id_t frame_id, Page *page);
+
+  /**
+   * Block until the I/O on a frame has completed. Must be called with latch_ held through lock.
+   * @param lock the held latch_, released while waiting
+   * @param frame_id the frame to wait on
+   */
+  void WaitForIO(std::unique_lock<TimedMutex> *lock, frame_id_t frame_id);
+
+  /**
+   * Mark the I/O on a frame as done and wake everyone waiting on it. Must be called with latch_ held.
+   * @param frame_id the frame whose I/O has completed
+   */
+  void FinishIO(frame_id_t frame_id);
+
+  /**
+   * Count a fetch, and sample it for the page heat map.
+   * @param page_id the page that was fetched
+   * @param hit whether the page was in the pool
+   */
+  void CountFetch(page_id_t page_id, bool hit) {
+    counters_.Add(hit ? BufferPoolCounter::HITS : BufferPoolCounter::MISSES);
+    page_heat_.Record(page_id);
+  }
+
+  /**
+   * Count an eviction of the page that was in a frame, if there was one. Must be called with latch_ held.
+   * @param victim_page_id the page that was evicted, INVALID_PAGE_ID if the frame was free
+   * @param dirty whether the page has to be written back
+   */
+  void CountVictim(page_id_t victim_page_id, bool dirty);
+
+  /** The frames that are added to or retired from the pool together, and their per frame state. */
+  struct FrameChunk {
+    explicit FrameChunk(size_t num_frames);
+    /** The frames' data, apart from their metadata in pages_. */
+    FrameArena arena_;
+    std::unique_ptr<Page[]> pages_;
+    /** Per frame: true while the frame is being written back or read in without latch_ held. */
+    std::unique_ptr<std::atomic<bool>[]> io_in_progress_;
+    /** Per frame: signalled when the I/O on that frame completes. */
+    std::unique_ptr<std::condition_variable_any[]> io_done_;
+    /** Per frame: true while the frame belongs to the scan ring, i.e. nobody else has taken it over since. */
+    std::unique_ptr<bool[]> in_scan_ring_;
+  };
+
+  /**
+   * Counts the lookups that bypass latch_ on behalf of a group of threads, so that a retired chunk is not freed under
+   * one of them. Kept on their own cache lines to keep the threads from contending on them.
+   */
+  struct alignas(64) LookupStripe {
+    std::atomic<uint64_t> entered_{0};
+    std::atomic<uint64_t> exited_{0};
+  };
+
+  static constexpr size_t NUM_LOOKUP_STRIPES = 32;
+
+  FrameChunk *GetChunk(frame_id_t frame_id) { return chunks_[frame_id / chunk_size_].load(std::memory_order_acquire); }
+  Page *GetFrame(frame_id_t frame_id) { return &GetChunk(frame_id)->pages_[frame_id % chunk_size_]; }
+  /**
+   * Look a frame up without latch_, where its chunk may just have been taken out of the directory; the chunk pointer
+   * is loaded only once. Must be called between EnterLookup and ExitLookup.
+   * @return the frame, nullptr if its chunk is gone
+   */
+  Page *FindFrame(frame_id_t frame_id) {
+    FrameChunk *chunk = GetChunk(frame_id);
+    return chunk == nullptr ? nullptr : &chunk->pages_[frame_id % chunk_size_];
+  }
+  std::atomic<bool> &IOInProgress(frame_id_t frame_id) {
+    return GetChunk(frame_id)->io_in_progress_[frame_id % chunk_size_];
+  }
+  std::condition_variable_any &IODone(frame_id_t frame_id) {
+    return GetChunk(frame_id)->io_done_[frame_id % chunk_size_];
+  }
+  bool &InScanRing(frame_id_t frame_id) { return GetChunk(frame_id)->in_scan_ring_[frame_id % chunk_size_]; }
+
+  /** @return true if the frame belongs to a chunk that is being retired */
+  bool IsRetiring(frame_id_t frame_id) const { return frame_id / chunk_size_ >= num_active_chunks_; }
+
+  /** @return one more than the highest frame id of the chunks that exist, active or draining. Needs latch_ held. */
+  size_t FrameLimit() const;
+
+  /**
+   * Activate a chunk, allocating it unless it is still draining, and put its empty frames on the free list. Must be
+   * called with latch_ held.
+   * @param chunk_index the chunk to activate
+   */
+  void AddChunk(size_t chunk_index);
+
+  /**
+   * Drop the page in a claimed frame of a retired chunk, leaving the frame empty for good. The page must be clean, as
+   * nothing is written back. Must be called with latch_ held.
+   * @param frame_id the frame to retire
+   */
+  void RetireFrame(frame_id_t frame_id);
+
+  /**
+   * Retire claimed frames of retired chunks, writing back the dirty pages in them first. Must be called with latch_
+   * held through lock; it is released for the write-back. If that fails, the dirty pages stay in their frames,
+   * unpinned and still dirty.
+   * @param frame_ids the frames to retire
+   * @param lock the held latch_
+   */
+  void RetireFrames(const std::vector<frame_id_t> &frame_ids, std::unique_lock<TimedMutex> *lock);
+
+  /**
+   * Retire a frame of a retired chunk that has just been unpinned, unless somebody got to it first.
+   * @param frame_id the frame to retire
+   */
+  void DrainFrame(frame_id_t frame_id);
+
+  /** Free the retired chunks that have no pages left in them. Must be called with latch_ held. */
+  void ReleaseRetiredChunks();
+
+  /** Size the scan ring for the current pool size and empty it. Must be called with latch_ held. */
+  void ResetScanRing();
+
+  /**
+   * Announce a lookup that bypasses latch_. The caller may use frames from the chunk directory until ExitLookup.
+   * @return the stripe to pass to ExitLookup
+   */
+  LookupStripe *EnterLookup();
+
+  /** End a lookup started with EnterLookup. */
+  void ExitLookup(LookupStripe *stripe);
+
+  /** Wait until every lookup that started before this call has ended. */
+  void WaitForLookups();
+
+  /** Main loop of the background writer thread. */
+  void BackgroundWriterLoop();
+
+  /**
+   * Write back dirty unpinned pages, lowest page id first, until the clean target is met.
+   * @return the number of pages written
+   */
+  size_t CleanEvictableFrames();
+
+  /** Number of pages in the buffer pool. */
+  std::atomic<size_t> pool_size_;
+  /** Number of frames in each chunk, i.e. the initial pool size. */
+  const size_t chunk_size_;
+  /** How many instances are in the parallel BPM (if present, otherwise just 1 BPI) */
+  const uint32_t num_instances_ = 1;
+  /** Index of this BPI in the parallel BPM (if present, otherwise just 0) */
+  const uint32_t instance_index_ = 0;
+  /** Chunks of buffer pool frames; frame f lives in chunk f / chunk_size_. Changed under latch_, read without it. */
+  std::array<std::atomic<FrameChunk *>, BUFFER_POOL_MAX_CHUNKS> chunks_{};
+  /** Chunks below this index are in use; the rest are retired and draining, or not allocated. */
+  std::atomic<size_t> num_active_chunks_{0};
+  /** Lookups that bypass latch_, counted so that retired chunks can be freed safely. */
+  std::unique_ptr<LookupStripe[]> lookup_stripes_;
+  /** Pointer to the disk manager. */
+  DiskInterface *disk_manager_ __attribute__((__unused__));
+  /** Pointer to the log manager. */
+  LogManager *log_manager_ __attribute__((__unused__));
+  /** Pointer to the async disk manager batched I/O goes through, if any. */
+  AsyncDiskManager *async_disk_manager_ = nullptr;
+  /** Page table for keeping track of buffer pool pages. Updated under latch_, read without it. */
+  PageTable page_table_;
+  /** Replacer to find unpinned pages for replacement. */
+  Replacer *replacer_;
+  /** List of free pages. */
+  std::list<frame_id_t> free_list_;
+  /** Maximum number of frames in the scan ring. */
+  size_t scan_ring_size_;
+  /** Frames recycled by scans, reused round-robin. */
+  std::vector<frame_id_t> scan_ring_;
+  /** Next slot of scan_ring_ to reuse. */
+  size_t scan_ring_next_ = 0;
+  /** Reads pages ahead in the background. */
+  std::unique_ptr<Prefetcher> prefetcher_;
+  /** Hit, miss, eviction, background writer, pin wait and latch counters. */
+  BufferPoolCounters counters_;
+  /** Sampled fetches per page. */
+  PageHeatMap page_heat_;
+  /** Fraction of evictable frames the background writer keeps clean. */
+  std::atomic<double> bgwriter_clean_fraction_{BGWRITER_CLEAN_FRACTION};
+  /** Set when an eviction wrote back a dirty victim, so the background writer should not wait for its timer. */
+  std::atomic<bool> bgwriter_wakeup_{false};
+  /** True while the background writer should keep going. Protected by bgwriter_latch_. */
+  bool bgwriter_running_ = false;
+  /** File the hot set is kept in, empty if none. Protected by bgwriter_latch_. */
+  std::string hot_set_file_;
+  std::thread bgwriter_;
+  std::mutex bgwriter_latch_;
+  std::condition_variable bgwriter_cv_;
+  /** Dirty victims whose write-back is still in flight, and the frame they are being written from. */
+  std::unordered_map<page_id_t, frame_id_t> evicting_pages_;
+  /**
+   * This latch serializes updates to page_table_, chunks_, the I/O flags and page ids of the frames, and protects
+   * free_list_, the scan ring and evicting_pages_. The data of a frame with I/O in progress belongs to the thread
+   * doing the I/O.
+   */
+  TimedMutex latch_{&counters_};
+  /** latch_, held from ClaimTablespace until the tablespace's pages are discarded or released. */
+  std::unique_lock<TimedMutex> tablespace_lock_;
+  /** Frames claimed by ClaimTablespace. Protected by latch_. */
+  std::vector<frame_id_t> claimed_frames_;
+};
+}  // namespace bustub
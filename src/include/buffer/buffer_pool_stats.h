@@ -0,0 +1,199 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.h
+//
+// Identification: src/include/buffer/buffer_pool_stats.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/** A snapshot of what a buffer pool has done since it was created. */
+struct BufferPoolStats {
+  /** Fetches of pages that were already in the pool. */
+  uint64_t hits_ = 0;
+  /** Fetches that had to read the page in. */
+  uint64_t misses_ = 0;
+  /** Frames taken away from the page in them. */
+  uint64_t evictions_ = 0;
+  /** Evictions that had to write the victim back first. */
+  uint64_t dirty_write_backs_ = 0;
+  /** Pages written by the background writer. */
+  uint64_t background_writes_ = 0;
+  /** Fetches that had to wait for another thread's I/O on the frame. */
+  uint64_t pin_waits_ = 0;
+  /** Times the buffer pool latch was taken. */
+  uint64_t latch_acquisitions_ = 0;
+  /** Time the buffer pool latch was held, in nanoseconds. */
+  uint64_t latch_hold_ns_ = 0;
+  /** The most fetched pages and their estimated number of fetches, most first. Empty unless page heat is sampled. */
+  std::vector<std::pair<page_id_t, uint64_t>> hot_pages_;
+
+  /** @return the fraction of fetches that were hits, 0 if there were none */
+  double HitRatio() const;
+
+  /**
+   * Add another pool's statistics to these, e.g. to sum up the instances of a parallel pool.
+   * @param other the statistics to add
+   * @param num_hot_pages how many of the hottest pages of both to keep
+   */
+  void Merge(const BufferPoolStats &other, size_t num_hot_pages);
+
+  /** @return the statistics in human-readable form */
+  std::string ToString() const;
+};
+
+/** The counters a buffer pool keeps; see BufferPoolStats. */
+enum class BufferPoolCounter {
+  HITS = 0,
+  MISSES,
+  CLEAN_EVICTIONS,
+  DIRTY_EVICTIONS,
+  BACKGROUND_WRITES,
+  PIN_WAITS,
+  LATCH_ACQUISITIONS,
+  LATCH_HOLD_NS,
+  NUM_COUNTERS
+};
+
+/**
+ * BufferPoolCounters keeps the counters of a buffer pool, sharded so that threads counting at the same time mostly
+ * touch different cache lines. Each thread always counts on the same shard; reading a counter sums all of them.
+ */
+class BufferPoolCounters {
+ public:
+  BufferPoolCounters() : shards_(std::make_unique<Shard[]>(NUM_SHARDS)) {}
+
+  /**
+   * @param counter the counter to add to
+   * @param n the amount to add
+   */
+  void Add(BufferPoolCounter counter, uint64_t n = 1) {
+    shards_[ShardIndex()].counts_[static_cast<size_t>(counter)].fetch_add(n, std::memory_order_relaxed);
+  }
+
+  /**
+   * @param counter the counter to read
+   * @return the sum of the counter over all shards
+   */
+  uint64_t Get(BufferPoolCounter counter) const;
+
+  /**
+   * Fill in the counters of a snapshot.
+   * @param[out] stats the snapshot
+   */
+  void Snapshot(BufferPoolStats *stats) const;
+
+ private:
+  static constexpr size_t NUM_SHARDS = 32;
+  static constexpr size_t NUM_COUNTERS = static_cast<size_t>(BufferPoolCounter::NUM_COUNTERS);
+
+  struct alignas(64) Shard {
+    std::array<std::atomic<uint64_t>, NUM_COUNTERS> counts_{};
+  };
+
+  /** @return the shard of the calling thread */
+  static size_t ShardIndex();
+
+  std::unique_ptr<Shard[]> shards_;
+};
+
+/**
+ * A mutex that counts how often and for how long it is held. Meets the Lockable requirements, so it works with
+ * std::scoped_lock, std::unique_lock and std::condition_variable_any; time spent waiting on a condition variable does
+ * not count as held.
+ */
+class TimedMutex {
+ public:
+  /** @param counters where to count LATCH_ACQUISITIONS and LATCH_HOLD_NS */
+  explicit TimedMutex(BufferPoolCounters *counters) : counters_(counters) {}
+
+  void lock() {  // NOLINT
+    mutex_.lock();
+    acquired_at_ = std::chrono::steady_clock::now();
+  }
+
+  bool try_lock() {  // NOLINT
+    if (!mutex_.try_lock()) {
+      return false;
+    }
+    acquired_at_ = std::chrono::steady_clock::now();
+    return true;
+  }
+
+  void unlock() {  // NOLINT
+    auto held = std::chrono::steady_clock::now() - acquired_at_;
+    mutex_.unlock();
+    counters_->Add(BufferPoolCounter::LATCH_ACQUISITIONS);
+    counters_->Add(BufferPoolCounter::LATCH_HOLD_NS,
+                   std::chrono::duration_cast<std::chrono::nanoseconds>(held).count());
+  }
+
+ private:
+  std::mutex mutex_;
+  BufferPoolCounters *counters_;
+  /** When the current holder took the mutex. Only touched by the holder. */
+  std::chrono::steady_clock::time_point acquired_at_;
+};
+
+/**
+ * PageHeatMap estimates how often each page is fetched by counting one fetch in every sample_rate, per thread. It is
+ * off until a sample rate is set.
+ */
+class PageHeatMap {
+ public:
+  /**
+   * Start or stop sampling, forgetting everything counted so far.
+   * @param sample_rate count one in this many fetches, 0 to stop sampling
+   */
+  void SetSampleRate(size_t sample_rate);
+
+  /**
+   * Count a fetch of a page, if it is sampled.
+   * @param page_id the page that was fetched
+   */
+  void Record(page_id_t page_id) {
+    size_t sample_rate = sample_rate_.load(std::memory_order_relaxed);
+    if (sample_rate == 0) {
+      return;
+    }
+    thread_local size_t num_fetches = 0;
+    if (++num_fetches % sample_rate == 0) {
+      std::scoped_lock heat_lk{latch_};
+      heat_[page_id] += sample_rate;
+    }
+  }
+
+  /**
+   * @param num_pages how many pages to return at most
+   * @return the pages with the most estimated fetches and their estimates, most first
+   */
+  std::vector<std::pair<page_id_t, uint64_t>> GetHottest(size_t num_pages) const;
+
+ private:
+  std::atomic<size_t> sample_rate_{0};
+  mutable std::mutex latch_;
+  /** Estimated number of fetches per sampled page. */
+  std::unordered_map<page_id_t, uint64_t> heat_;
+};
+
+}  // namespace bustub
@@ -12,8 +12,9 @@
 
 #pragma once
 
-#include <list>
-#include <mutex>  // NOLINT
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <vector>
 
 #include "buffer/replacer.h"
@@ -23,6 +24,10 @@ namespace bustub {
 
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ *
+ * The replacer takes no locks. Each frame keeps its evictable and reference bits together in one atomic byte, so
+ * Pin and Unpin are a single atomic read-modify-write on that frame, and Victim sweeps a shared atomic clock hand,
+ * claiming a frame with a compare-and-swap.
  */
 class ClockReplacer : public Replacer {
  public:
@@ -43,10 +48,34 @@ class ClockReplacer : public Replacer {
 
   void Unpin(frame_id_t frame_id) override;
 
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  void SetNumFrames(size_t num_frames) override;
+
   size_t Size() override;
 
+  std::vector<frame_id_t> GetRecencyOrder() override;
+
  private:
-  // TODO(student): implement me!
+  /** The frame is in the replacer, i.e. it may be victimized. */
+  static constexpr uint8_t EVICTABLE = 0x1;
+  /** The frame was unpinned since the clock hand last passed it. */
+  static constexpr uint8_t REFERENCED = 0x2;
+  /** The last access to the frame was a scan, so unpinning it does not earn it a second chance. */
+  static constexpr uint8_t SCANNED = 0x4;
+
+  /** Number of frames the replacer tracks. */
+  const size_t num_pages_;
+  /** Number of those frames in use; the clock hand only sweeps over these. */
+  std::atomic<size_t> num_frames_;
+  /** Per-frame EVICTABLE, REFERENCED and SCANNED bits. */
+  std::unique_ptr<std::atomic<uint8_t>[]> frames_;
+  /** Position of the clock hand; only ever incremented, taken modulo num_frames_. */
+  std::atomic<size_t> clock_hand_{0};
+  /** Number of frames with the EVICTABLE bit set. */
+  std::atomic<size_t> size_{0};
 };
 
 }  // namespace bustub
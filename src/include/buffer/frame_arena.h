@@ -0,0 +1,68 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.h
+//
+// Identification: src/include/buffer/frame_arena.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * FrameArena is one contiguous, zeroed block of memory holding the data of a number of buffer pool frames.
+ *
+ * Arenas of at least a huge page are aligned to one and, where the kernel supports it, backed by transparent huge
+ * pages, so that a large pool costs a few TLB entries rather than one per frame. The frames' metadata is kept apart
+ * from their data, so that walking the metadata does not pull page data into the cache.
+ */
+class FrameArena {
+ public:
+  /** Huge pages on x86-64 and arm64 with 4 KB base pages are 2 MB. */
+  static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+  /**
+   * Map a new arena.
+   * @param num_frames the number of PAGE_SIZE frames the arena holds
+   * @throws Exception OUT_OF_MEMORY if the memory cannot be mapped
+   */
+  explicit FrameArena(size_t num_frames);
+
+  ~FrameArena();
+
+  FrameArena(const FrameArena &) = delete;
+  FrameArena &operator=(const FrameArena &) = delete;
+
+  /**
+   * @param index the index of a frame in the arena
+   * @return the data of the frame
+   */
+  char *GetFrameData(size_t index) const { return data_ + index * PAGE_SIZE; }
+
+  /** @return the number of frames in the arena */
+  size_t GetNumFrames() const { return num_frames_; }
+
+  /** @return true if the kernel was asked to back the arena with huge pages */
+  bool IsHugePageAdvised() const { return huge_page_advised_; }
+
+ private:
+  /** Number of frames in the arena. */
+  const size_t num_frames_;
+  /** Start of the mapping. */
+  char *data_ = nullptr;
+  /** Length of the mapping, rounded up to a whole number of huge pages, or base pages for a small arena. */
+  size_t size_ = 0;
+  /** Whether madvise(MADV_HUGEPAGE) succeeded. */
+  bool huge_page_advised_ = false;
+};
+
+}  // namespace bustub
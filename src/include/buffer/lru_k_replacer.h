@@ -0,0 +1,103 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.h
+//
+// Identification: src/include/buffer/lru_k_replacer.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <deque>
+#include <mutex>  // NOLINT
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy.
+ *
+ * The replacer evicts the frame whose backward k-distance is the largest, i.e. whose k-th most recent access is the
+ * furthest in the past. A frame that has been accessed fewer than k times has an infinite backward k-distance; if
+ * several frames do, the one whose earliest recorded access is oldest goes first. Pages that a sequential scan touches
+ * once therefore leave before pages that are looked up over and over, however recently the scan ran. Scan accesses to a
+ * frame that already has a history are not recorded at all, so repeated scans never turn a page hot.
+ *
+ * The evictable frames are kept ordered by the timestamp their backward k-distance is measured from, in one set for
+ * frames with fewer than k accesses and one for the rest, so Victim takes O(log N) rather than a scan of every frame.
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be required to store
+   * @param k the number of most recent accesses remembered per frame
+   */
+  LRUKReplacer(size_t num_pages, size_t k);
+
+  /**
+   * Destroys the LRUKReplacer.
+   */
+  ~LRUKReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+  std::vector<frame_id_t> GetRecencyOrder() override;
+
+ private:
+  struct FrameInfo {
+    /** Timestamps of the last k accesses, oldest first. */
+    std::deque<size_t> history_;
+    /** True if the frame is unpinned and may be victimized. */
+    bool evictable_{false};
+  };
+
+  /** Evictable frames by the oldest timestamp in their history, 0 for none, then by frame id. */
+  using FrameQueue = std::set<std::pair<size_t, frame_id_t>>;
+
+  /** Put an evictable frame into the queue of its group. */
+  void Enqueue(frame_id_t frame_id);
+
+  /** Take an evictable frame out of the queue of its group. Must be called before its history changes. */
+  void Dequeue(frame_id_t frame_id);
+
+  /** @return the queue of the group the frame's history puts it in */
+  FrameQueue &QueueOf(const FrameInfo &frame) { return frame.history_.size() >= k_ ? full_history_ : short_history_; }
+
+  /** @return the key of the frame in its queue */
+  static std::pair<size_t, frame_id_t> KeyOf(const FrameInfo &frame, frame_id_t frame_id) {
+    return {frame.history_.empty() ? 0 : frame.history_.front(), frame_id};
+  }
+
+  /** Number of accesses remembered per frame. */
+  const size_t k_;
+  /** Logical clock, advanced on every recorded access. */
+  size_t current_timestamp_{0};
+  std::vector<FrameInfo> frames_;
+  /** Evictable frames with fewer than k accesses, which are victimized first. */
+  FrameQueue short_history_;
+  /** Evictable frames with k accesses. */
+  FrameQueue full_history_;
+  std::mutex latch_;
+};
+
+}  // namespace bustub
@@ -44,8 +44,14 @@ class LRUReplacer : public Replacer {
 
   void Unpin(frame_id_t frame_id) override;
 
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown) override;
+
+  void Remove(frame_id_t frame_id) override;
+
   size_t Size() override;
 
+  std::vector<frame_id_t> GetRecencyOrder() override;
+
  private:
   // TODO(student): implement me!
   using ListIterator = typename std::list<frame_id_t>::const_iterator;
@@ -55,6 +61,8 @@ class LRUReplacer : public Replacer {
   std::mutex lru_lock;
   std::list<frame_id_t> lru_bucket_list;
   CacheMap lru_map;
+  // frames whose last access was a scan; they are unpinned at the least recently used end
+  std::vector<bool> scanned;
   
 };
 
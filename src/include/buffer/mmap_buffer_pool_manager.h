@@ -0,0 +1,173 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// mmap_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/mmap_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_stats.h"
+#include "buffer/prefetcher.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * MmapBufferPoolManager serves a database read-only out of memory mappings of its data files, e.g. for a read replica
+ * or offline analytics. Every page of the files gets a Page up front that points straight into the mapping, so a fetch
+ * copies nothing, never evicts, and only pins the page; the kernel's page cache is the only copy of the data, and it
+ * is faulted in on first touch rather than read in before the first query.
+ *
+ * The db file and the tablespaces in the tablespace file next to it are mapped as they are when the pool is created;
+ * pages allocated or files grown later are not seen. The files are opened and mapped read-only, so nothing can change
+ * them: NewPage and DeletePage fail, tablespaces cannot be created or dropped, there is never anything to flush, and
+ * writing to a page's data faults. Unpinning a page as dirty just unpins it. Allocated pages past the end of a file,
+ * which were never written, point at a shared page of zeros. A page is checked against its checksum the first time it
+ * is fetched. Compressed databases cannot be mapped, and a double-write file left behind by a crash is not recovered;
+ * open the database with a DiskManager once first.
+ */
+class MmapBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * Creates a new MmapBufferPoolManager.
+   * @param db_file the database file to map, as given to the DiskManager that wrote it
+   * @throws Exception if a data file cannot be opened or mapped, or the database is compressed
+   */
+  explicit MmapBufferPoolManager(const std::string &db_file);
+
+  /**
+   * Destroys an existing MmapBufferPoolManager and unmaps its files. No page may be used any more.
+   */
+  ~MmapBufferPoolManager() override;
+
+  /** The kernel reads the pages ahead into the page cache. */
+  void PrefetchPage(page_id_t page_id, AccessType access_type = AccessType::Unknown) override;
+
+  /** The kernel reads the pages ahead into the page cache. */
+  void PrefetchRange(page_id_t first_page_id, size_t num_pages, AccessType access_type = AccessType::Scan) override;
+
+  void PrefetchChain(page_id_t page_id, size_t depth, next_page_fn next_page,
+                     AccessType access_type = AccessType::Scan) override;
+
+  /** @return the number of pages mapped, over all data files */
+  size_t GetPoolSize() override;
+
+  /** @return false, as the pool is as large as the data files */
+  bool Resize(size_t /* pool_size */) override { return false; }
+
+  /** @return false, as every page is always in the pool */
+  bool SaveHotSet(const std::string & /* file_name */) override { return false; }
+
+  /** @return 0, as every page is always in the pool */
+  size_t LoadHotSet(const std::string & /* file_name */) override { return 0; }
+
+  /**
+   * Take a snapshot of the counters. A fetch is a miss the first time a page is fetched, and a hit after that.
+   * @param num_hot_pages how many of the most fetched pages to include, if page heat is sampled
+   * @return the statistics
+   */
+  BufferPoolStats GetStats(size_t num_hot_pages = 10) override;
+
+  void SetPageHeatSampling(size_t sample_rate) override;
+
+  /** @throws Exception as the database is read-only */
+  tablespace_id_t CreateTablespace(const std::string &file_name) override;
+
+  /** @return false, as the database is read-only */
+  bool DropTablespace(tablespace_id_t /* tablespace */) override { return false; }
+
+  /**
+   * Fetch the requested page. Pins it; nothing is read or copied.
+   * @param page_id id of page to be fetched
+   * @param access_type how the page is accessed
+   * @return the requested page, nullptr if it is not in a mapped file
+   * @throws Exception of type CORRUPTION if the page does not match its checksum
+   */
+  Page *FetchPageImpl(page_id_t page_id, AccessType access_type) override;
+
+  /**
+   * Unpin the target page.
+   * @param page_id id of page to be unpinned
+   * @param is_dirty ignored, as the page cannot have been changed
+   * @return false if the page pin count is <= 0 before this call, true otherwise
+   */
+  bool UnpinPageImpl(page_id_t page_id, bool is_dirty) override;
+
+  /**
+   * Flushes the target page to disk, which is never needed.
+   * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
+   * @return false if the page is not in a mapped file, true otherwise
+   */
+  bool FlushPageImpl(page_id_t page_id) override;
+
+  /** @return nullptr, as the database is read-only */
+  Page *NewPageImpl(page_id_t *page_id, tablespace_id_t tablespace, page_id_t near_page_id) override;
+
+  using BufferPoolManager::NewPageImpl;
+
+  /** @return false if the page is in a mapped file, as the database is read-only; true otherwise */
+  bool DeletePageImpl(page_id_t page_id) override;
+
+  /** Nothing is ever dirty. */
+  void FlushAllPagesImpl() override {}
+
+ private:
+  /** A data file mapped read-only, and a Page for each of its pages. */
+  struct MappedFile {
+    /** Unmaps and closes the file. */
+    ~MappedFile();
+
+    int fd_{-1};
+    // the mapping of the whole file, nullptr if the file is empty
+    char *data_{nullptr};
+    size_t size_{0};
+    // one past the highest allocated page number
+    page_id_t num_pages_{0};
+    std::unique_ptr<Page[]> pages_;
+    // whether each page has been checked against its checksum
+    std::unique_ptr<std::atomic<bool>[]> verified_;
+  };
+
+  /**
+   * Open and map a data file, and point a Page at each of its pages.
+   * @param tablespace the tablespace of the file
+   * @param file_name the file
+   * @throws Exception if the file cannot be opened or mapped
+   */
+  void MapFile(tablespace_id_t tablespace, const std::string &file_name);
+
+  /** @return the mapped file that holds the page with the given id, nullptr if there is none */
+  MappedFile *FindFile(page_id_t page_id) const;
+
+  /**
+   * Check a page against its checksum, as stored in the run header pages in front of it.
+   * @throws Exception of type CORRUPTION if the page does not match it
+   */
+  static void VerifyPage(const MappedFile &file, page_id_t page_no);
+
+  /** Ask the kernel to read the part of a mapping between begin and end into the page cache. */
+  static void Advise(const char *begin, const char *end);
+
+  /** The mapped data file of each tablespace; the db file is files_[DEFAULT_TABLESPACE]. */
+  std::array<std::unique_ptr<MappedFile>, MAX_TABLESPACES> files_;
+  /** A read-only page of zeros, for allocated pages past the end of their file. */
+  char *zero_page_{nullptr};
+  BufferPoolCounters counters_;
+  PageHeatMap page_heat_;
+  /** Follows chains in the background, which faults their pages in. */
+  std::unique_ptr<Prefetcher> prefetcher_;
+};
+
+}  // namespace bustub
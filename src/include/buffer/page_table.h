@@ -0,0 +1,101 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.h
+//
+// Identification: src/include/buffer/page_table.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * PageTable maps the ids of the pages in a buffer pool to the frames that hold them.
+ *
+ * It is a fixed-capacity open-addressing hash table with linear probing. Its capacity is at least twice the number of
+ * frames, so it never has to grow. Each slot is a single atomic word holding both the page id and the frame id.
+ *
+ * Insert and Erase must be serialized by the caller. Find may run concurrently with them and takes no lock. A
+ * concurrent Find can miss an entry that is being inserted, or return one that is being erased. Callers must treat a
+ * miss as "look again under the latch", and must check that the frame still holds the page before trusting a hit.
+ */
+class PageTable {
+ public:
+  /**
+   * Create a new PageTable.
+   * @param num_frames the number of frames in the buffer pool, i.e. the most entries the table ever holds
+   */
+  explicit PageTable(size_t num_frames);
+
+  /**
+   * Look up a page. Safe to call concurrently with Insert and Erase.
+   * @param page_id the page to look up
+   * @param[out] frame_id the frame that holds the page
+   * @return true if the page is in the table
+   */
+  bool Find(page_id_t page_id, frame_id_t *frame_id) const;
+
+  /**
+   * Map a page that is not in the table yet to a frame.
+   * @param page_id the page
+   * @param frame_id the frame that holds it
+   */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * Remove a page from the table, if it is there.
+   * @param page_id the page
+   */
+  void Erase(page_id_t page_id);
+
+  /**
+   * Call f(page_id, frame_id) for every entry. Must not run concurrently with Insert or Erase.
+   * @param f the function to call
+   */
+  template <typename F>
+  void ForEach(F f) const {
+    for (size_t i = 0; i < capacity_; ++i) {
+      uint64_t slot = slots_[i].load(std::memory_order_relaxed);
+      if (IsLive(slot)) {
+        f(KeyOf(slot), FrameOf(slot));
+      }
+    }
+  }
+
+  /** @return the number of entries in the table */
+  size_t Size() const { return size_; }
+
+ private:
+  /** Key of a slot that has never held an entry; probes stop here. */
+  static constexpr page_id_t EMPTY = INVALID_PAGE_ID;
+  /** Key of a slot whose entry was erased; probes go on past it. */
+  static constexpr page_id_t TOMBSTONE = INVALID_PAGE_ID - 1;
+
+  static uint64_t MakeSlot(page_id_t page_id, frame_id_t frame_id) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32) | static_cast<uint32_t>(frame_id);
+  }
+  static page_id_t KeyOf(uint64_t slot) { return static_cast<page_id_t>(static_cast<uint32_t>(slot >> 32)); }
+  static frame_id_t FrameOf(uint64_t slot) { return static_cast<frame_id_t>(static_cast<uint32_t>(slot)); }
+  static bool IsLive(uint64_t slot) { return KeyOf(slot) != EMPTY && KeyOf(slot) != TOMBSTONE; }
+
+  /** @return the slot the probe for page_id starts at */
+  size_t Home(page_id_t page_id) const;
+
+  /** Number of slots, a power of two. */
+  size_t capacity_;
+  std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+  size_t size_ = 0;
+};
+
+}  // namespace bustub
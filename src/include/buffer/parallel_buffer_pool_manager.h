@@ -0,0 +1,216 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/parallel_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/prefetcher.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_interface.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * ParallelBufferPoolManager shards the buffer pool across several independent BufferPoolManagerInstances. A page
+ * always lives in the instance given by (page_id % num_instances), so each instance only ever sees its own pages and
+ * threads working on different shards never touch the same latch.
+ */
+class ParallelBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * Creates a new ParallelBufferPoolManager.
+   * @param num_instances the number of individual BufferPoolManagerInstances to store
+   * @param pool_size the pool size of each BufferPoolManagerInstance
+   * @param disk_manager the disk manager
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy every instance uses
+   */
+  ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskInterface *disk_manager,
+                            LogManager *log_manager = nullptr, ReplacerType replacer_type = ReplacerType::LRU);
+
+  /**
+   * Destroys an existing ParallelBufferPoolManager.
+   */
+  ~ParallelBufferPoolManager() override;
+
+  void PrefetchPage(page_id_t page_id, AccessType access_type = AccessType::Unknown) override;
+
+  void PrefetchRange(page_id_t first_page_id, size_t num_pages, AccessType access_type = AccessType::Scan) override;
+
+  void PrefetchChain(page_id_t page_id, size_t depth, next_page_fn next_page,
+                     AccessType access_type = AccessType::Scan) override;
+
+  /** @return size of the buffer pool, summed over every instance */
+  size_t GetPoolSize() override;
+
+  /**
+   * Resize the buffer pool, splitting the new size evenly over the instances.
+   * @param pool_size the new total number of frames
+   * @return false if some instance could not be resized, in which case none is
+   */
+  bool Resize(size_t pool_size) override;
+
+  /**
+   * Resize a single instance, e.g. to move memory over to the shard that misses the most.
+   * @param instance_index the instance to resize
+   * @param pool_size the new number of frames of that instance
+   * @return false if the instance could not be resized
+   */
+  bool ResizeInstance(size_t instance_index, size_t pool_size);
+
+  /**
+   * Save the hot set of every instance, instance i to file_name.i.
+   * @param file_name the prefix of the files to save the hot sets to
+   * @return false if some file could not be written
+   */
+  bool SaveHotSet(const std::string &file_name) override;
+
+  /**
+   * Read back the hot sets saved by SaveHotSet, all instances at once.
+   * @param file_name the prefix of the files the hot sets were saved to
+   * @return the number of pages read in
+   */
+  size_t LoadHotSet(const std::string &file_name) override;
+
+  /**
+   * Keep the hot set files of every instance up to date; see BufferPoolManagerInstance::SetHotSetFile.
+   * @param file_name the prefix of the files to save the hot sets to, empty to stop saving them
+   */
+  void SetHotSetFile(const std::string &file_name);
+
+  /**
+   * Send the batched I/O of every instance through an async disk manager; see
+   * BufferPoolManagerInstance::SetAsyncDiskManager.
+   * @param async_disk_manager an async disk manager for the same file as the disk manager, nullptr to use the latter
+   */
+  void SetAsyncDiskManager(AsyncDiskManager *async_disk_manager);
+
+  /**
+   * Start the background writer of every instance.
+   * @param clean_fraction the fraction of evictable frames each instance keeps clean
+   */
+  void RunBackgroundWriter(double clean_fraction = BGWRITER_CLEAN_FRACTION);
+
+  /**
+   * Stop the background writer of every instance.
+   */
+  void StopBackgroundWriter();
+
+  /**
+   * Take a snapshot of the counters of all instances, summed up.
+   * @param num_hot_pages how many of the most fetched pages to include, if page heat is sampled
+   * @return the statistics
+   */
+  BufferPoolStats GetStats(size_t num_hot_pages = 10) override;
+
+  void SetPageHeatSampling(size_t sample_rate) override;
+
+  tablespace_id_t CreateTablespace(const std::string &file_name) override {
+    return disk_manager_->CreateTablespace(file_name);
+  }
+
+  /** Every instance throws away its pages of the tablespace before it is dropped on disk. */
+  bool DropTablespace(tablespace_id_t tablespace) override;
+
+  /** @return number of evictions that found a clean victim, over all instances */
+  size_t GetNumCleanVictims() const;
+
+  /** @return number of evictions that had to write back a dirty victim, over all instances */
+  size_t GetNumDirtyVictims() const;
+
+  /** @return number of pages written by the background writers of all instances */
+  size_t GetNumBackgroundWrites() const;
+
+  /**
+   * @param page_id id of page
+   * @return pointer to the BufferPoolManagerInstance responsible for handling given page id
+   */
+  BufferPoolManagerInstance *GetBufferPoolManager(page_id_t page_id);
+
+  /**
+   * Fetch the requested page from the responsible BufferPoolManagerInstance.
+   * @param page_id id of page to be fetched
+   * @param access_type how the page is accessed
+   * @return the requested page
+   */
+  Page *FetchPageImpl(page_id_t page_id, AccessType access_type) override;
+
+  /**
+   * Fetch several pages at once, each instance fetching its share in one batch.
+   * @param page_ids ids of the pages to fetch, in any order and possibly repeated
+   * @param access_type how the pages are accessed
+   * @return the pages in the order they were asked for; nullptr for each page that could not be fetched
+   */
+  std::vector<Page *> FetchPages(const std::vector<page_id_t> &page_ids,
+                                 AccessType access_type = AccessType::Unknown) override;
+
+  /**
+   * Unpin the target page from the responsible BufferPoolManagerInstance.
+   * @param page_id id of page to be unpinned
+   * @param is_dirty true if the page should be marked as dirty, false otherwise
+   * @return false if the page pin count is <= 0 before this call, true otherwise
+   */
+  bool UnpinPageImpl(page_id_t page_id, bool is_dirty) override;
+
+  /**
+   * Flushes the target page to disk.
+   * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
+   * @return false if the page could not be found in the page table, true otherwise
+   */
+  bool FlushPageImpl(page_id_t page_id) override;
+
+  /**
+   * Creates a new page. Instances are asked in round-robin order, starting one past the instance that was asked
+   * first on the previous call, until one of them has a free frame.
+   * @param[out] page_id id of created page
+   * @param tablespace the tablespace to allocate the page in
+   * @param near_page_id a page the new one should be stored next to, INVALID_PAGE_ID for none
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPageImpl(page_id_t *page_id, tablespace_id_t tablespace, page_id_t near_page_id) override;
+
+  using BufferPoolManager::NewPageImpl;
+
+  /**
+   * Deletes a page from the responsible BufferPoolManagerInstance.
+   * @param page_id id of page to be deleted
+   * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
+   */
+  bool DeletePageImpl(page_id_t page_id) override;
+
+  /**
+   * Flushes all the pages in every BufferPoolManagerInstance to disk.
+   */
+  void FlushAllPagesImpl() override;
+
+ private:
+  /** @return the hot set file of one instance */
+  static std::string InstanceHotSetFile(const std::string &file_name, size_t instance_index);
+
+  /** The disk the instances share. */
+  DiskInterface *disk_manager_;
+  /** The shards. Instance i owns every page id with (page_id % num_instances) == i. */
+  std::vector<std::unique_ptr<BufferPoolManagerInstance>> instances_;
+  /** The instance that NewPageImpl asks first on its next call. */
+  std::atomic<size_t> next_instance_{0};
+  /** Reads pages ahead through this pool, so that chains may cross from one instance to another. */
+  std::unique_ptr<Prefetcher> prefetcher_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,109 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// prefetcher.h
+//
+// Identification: src/include/buffer/prefetcher.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <unordered_set>
+
+#include "buffer/buffer_pool_manager.h"
+
+namespace bustub {
+
+/**
+ * Prefetcher reads pages into a buffer pool on a background thread, so that a later FetchPage finds them resident.
+ *
+ * Requests are queued and served in order by a single worker thread, which is started by the first request. A
+ * prefetched page is fetched and unpinned right away: it competes for frames like any other page, and nothing is held
+ * if nobody ends up asking for it. A request for a page that is already queued is dropped, and so is any request
+ * while PREFETCH_QUEUE_SIZE requests are waiting: a prefetch is only a hint, and one the worker cannot keep up with
+ * is no use. Consecutive requests for single pages are fetched as one batch of up to PREFETCH_BATCH_SIZE pages.
+ */
+class Prefetcher {
+ public:
+  /**
+   * Creates a new Prefetcher.
+   * @param bpm the buffer pool to read pages into
+   */
+  explicit Prefetcher(BufferPoolManager *bpm);
+
+  /**
+   * Stops the worker, dropping whatever is still queued.
+   */
+  ~Prefetcher();
+
+  /**
+   * Queue a single page.
+   * @param page_id id of the page to read
+   * @param access_type how the page will be accessed once it is fetched for real
+   */
+  void PrefetchPage(page_id_t page_id, AccessType access_type);
+
+  /**
+   * Queue the pages first_page_id, first_page_id + 1, ..., first_page_id + num_pages - 1.
+   * @param first_page_id id of the first page to read
+   * @param num_pages number of pages to read
+   * @param access_type how the pages will be accessed once they are fetched for real
+   */
+  void PrefetchRange(page_id_t first_page_id, size_t num_pages, AccessType access_type);
+
+  /**
+   * Queue a chain of pages: page_id, then the page next_page returns for it, and so on, depth pages in total or until
+   * next_page returns INVALID_PAGE_ID.
+   * @param page_id id of the first page of the chain
+   * @param depth maximum number of pages to read
+   * @param next_page reads the id of the next page out of a page; called with the page read-latched
+   * @param access_type how the pages will be accessed once they are fetched for real
+   */
+  void PrefetchChain(page_id_t page_id, size_t depth, BufferPoolManager::next_page_fn next_page,
+                     AccessType access_type);
+
+  /**
+   * Drops all queued requests and waits for the worker to exit. Further requests are ignored. The owning buffer pool
+   * must call this before it starts tearing itself down.
+   */
+  void Stop();
+
+ private:
+  struct Request {
+    page_id_t page_id_;
+    size_t depth_;
+    BufferPoolManager::next_page_fn next_page_;
+    AccessType access_type_;
+  };
+
+  void Enqueue(Request request);
+
+  /** @return true if the request is for one page rather than a chain */
+  static bool IsSinglePage(const Request &request) { return request.depth_ == 1 && request.next_page_ == nullptr; }
+
+  /** Main loop of the worker thread. */
+  void Run();
+
+  /** Buffer pool that pages are read into. */
+  BufferPoolManager *bpm_;
+  /** Requests that have not been picked up by the worker yet. */
+  std::deque<Request> queue_;
+  /** First page ids of the requests in queue_. */
+  std::unordered_set<page_id_t> queued_;
+  bool stopped_ = false;
+  std::thread worker_;
+  /** Protects queue_, queued_, stopped_ and worker_. */
+  std::mutex latch_;
+  /** Signalled when a request is queued or the prefetcher is stopped. */
+  std::condition_variable cv_;
+};
+
+}  // namespace bustub
@@ -12,10 +12,21 @@
 
 #pragma once
 
+#include <vector>
+
 #include "common/config.h"
 
 namespace bustub {
 
+/** The replacement policies a buffer pool can be configured with. */
+enum class ReplacerType { LRU, CLOCK, LRUK };
+
+/**
+ * How a page is being accessed. Scan marks pages that a sequential scan touches once and moves past, which the buffer
+ * pool and the replacers keep from crowding out everything else.
+ */
+enum class AccessType { Unknown = 0, Lookup, Scan, Index };
+
 /**
  * Replacer is an abstract class that tracks page usage.
  */
@@ -43,8 +54,37 @@ class Replacer {
    */
   virtual void Unpin(frame_id_t frame_id) = 0;
 
+  /**
+   * Records that the page in a frame was just accessed. Policies that only look at unpin order can ignore this, but
+   * should not let a Scan access make a frame look hotter than it was.
+   * @param frame_id the id of the frame that was accessed
+   * @param access_type how the page was accessed
+   */
+  virtual void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown) {}
+
+  /**
+   * Forgets a frame entirely, e.g. because its page was deleted. The frame must not be pinned by anyone.
+   * @param frame_id the id of the frame to remove
+   */
+  virtual void Remove(frame_id_t frame_id) { Pin(frame_id); }
+
+  /**
+   * Tells the replacer that only the frames below num_frames are in use, e.g. because the buffer pool grew or shrank.
+   * None of the frames from num_frames up may be evictable. Policies that only look at the frames they hold can
+   * ignore this.
+   * @param num_frames one more than the highest frame id in use, at most the number the replacer was created for
+   */
+  virtual void SetNumFrames(size_t num_frames) {}
+
   /** @return the number of elements in the replacer that can be victimized */
   virtual size_t Size() = 0;
+
+  /**
+   * Lists the frames that can be victimized in the order the policy values them: the frame it would keep the longest
+   * comes first, the next victim last.
+   * @return the evictable frames, hottest first
+   */
+  virtual std::vector<frame_id_t> GetRecencyOrder() = 0;
 };
 
 }  // namespace bustub
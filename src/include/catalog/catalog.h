@@ -10,6 +10,7 @@
 #include "catalog/schema.h"
 #include "storage/index/b_plus_tree_index.h"
 #include "storage/index/index.h"
+#include "storage/page/table_page.h"
 #include "storage/table/table_heap.h"
 
 namespace bustub {
@@ -21,6 +22,23 @@ using table_oid_t = uint32_t;
 using column_oid_t = uint32_t;
 using index_oid_t = uint32_t;
 
+/**
+ * Where a table or an index keeps its pages: in a tablespace it shares with others, the db file by default, or in a
+ * tablespace of its own, e.g. to put an index on a device of its own. A table or index with a tablespace of its own is
+ * dropped by unlinking the tablespace's file.
+ */
+struct Placement {
+  /** @return placement in a tablespace that exists already */
+  static Placement Shared(tablespace_id_t tablespace = DEFAULT_TABLESPACE) { return {tablespace, false, ""}; }
+
+  /** @return placement in a new tablespace kept in the given file, or in a file next to the db file if empty */
+  static Placement OwnFile(std::string file_name = "") { return {DEFAULT_TABLESPACE, true, std::move(file_name)}; }
+
+  tablespace_id_t tablespace_{DEFAULT_TABLESPACE};
+  bool own_file_{false};
+  std::string file_name_;
+};
+
 /**
  * Metadata about a table.
  */
@@ -31,6 +49,9 @@ struct TableMetadata {
   std::string name_;
   std::unique_ptr<TableHeap> table_;
   table_oid_t oid_;
+  /** The tablespace the table's pages are in, and whether it is the table's own. */
+  tablespace_id_t tablespace_{DEFAULT_TABLESPACE};
+  bool owns_tablespace_{false};
 };
 
 /**
@@ -51,6 +72,9 @@ struct IndexInfo {
   index_oid_t index_oid_;
   std::string table_name_;
   const size_t key_size_;
+  /** The tablespace the index's pages are in, and whether it is the index's own. */
+  tablespace_id_t tablespace_{DEFAULT_TABLESPACE};
+  bool owns_tablespace_{false};
 };
 
 /**
@@ -73,18 +97,86 @@ class Catalog {
    * @param txn the transaction in which the table is being created
    * @param table_name the name of the new table
    * @param schema the schema of the new table
+   * @param placement where to keep the pages of the table
    * @return a pointer to the metadata of the new table
    */
-  TableMetadata *CreateTable(Transaction *txn, const std::string &table_name, const Schema &schema) {
+  TableMetadata *CreateTable(Transaction *txn, const std::string &table_name, const Schema &schema,
+                             const Placement &placement = Placement::Shared()) {
     BUSTUB_ASSERT(names_.count(table_name) == 0, "Table names should be unique!");
-    return nullptr;
+    tablespace_id_t tablespace = PlaceOnDisk(placement);
+    table_oid_t table_oid = next_table_oid_++;
+    auto table = std::make_unique<TableHeap>(bpm_, lock_manager_, log_manager_, txn, tablespace);
+    auto metadata = std::make_unique<TableMetadata>(schema, table_name, std::move(table), table_oid);
+    metadata->tablespace_ = tablespace;
+    metadata->owns_tablespace_ = placement.own_file_;
+    auto *result = metadata.get();
+    tables_.emplace(table_oid, std::move(metadata));
+    names_.emplace(table_name, table_oid);
+    return result;
   }
 
-  /** @return table metadata by name */
-  TableMetadata *GetTable(const std::string &table_name) { return nullptr; }
+  /**
+   * @return table metadata by name
+   * @throws std::out_of_range if there is no such table
+   */
+  TableMetadata *GetTable(const std::string &table_name) { return GetTable(names_.at(table_name)); }
 
-  /** @return table metadata by oid */
-  TableMetadata *GetTable(table_oid_t table_oid) { return nullptr; }
+  /**
+   * @return table metadata by oid
+   * @throws std::out_of_range if there is no such table
+   */
+  TableMetadata *GetTable(table_oid_t table_oid) { return tables_.at(table_oid).get(); }
+
+  /**
+   * Drop a table and its indexes. Whatever has a tablespace of its own is dropped by unlinking the tablespace's file;
+   * the pages of a table heap in a shared tablespace are deleted one by one. An index in a shared tablespace leaves its
+   * pages behind, as they cannot be found without walking the tree.
+   * @param txn the transaction in which the table is being dropped
+   * @param table_name the name of the table
+   * @return false if pages of the table or its indexes are still pinned; call again once they have been unpinned. A
+   * tablespace that could not be dropped keeps all of its pages, and the indexes whose tablespaces have been dropped
+   * by then are gone from the catalog already.
+   * @throws std::out_of_range if there is no such table
+   */
+  bool DropTable(Transaction *txn, const std::string &table_name) {
+    TableMetadata *table = GetTable(table_name);
+    // An index goes as soon as its tablespace has, so that a call that gives up part way leaves none without one.
+    for (IndexInfo *index : GetTableIndexes(table_name)) {
+      if (index->owns_tablespace_) {
+        if (!bpm_->DropTablespace(index->tablespace_)) {
+          return false;
+        }
+        index_names_[table_name].erase(index->name_);
+        indexes_.erase(index->index_oid_);
+      }
+    }
+    if (table->owns_tablespace_) {
+      if (!bpm_->DropTablespace(table->tablespace_)) {
+        return false;
+      }
+    } else {
+      page_id_t page_id = table->table_->GetFirstPageId();
+      while (page_id != INVALID_PAGE_ID) {
+        page_id_t next_page_id;
+        {
+          auto guard = bpm_->FetchPageRead(page_id);
+          if (guard.AsPage<TablePage>() == nullptr) {
+            return false;
+          }
+          next_page_id = guard.AsPage<TablePage>()->GetNextPageId();
+        }
+        bpm_->DeletePage(page_id);
+        page_id = next_page_id;
+      }
+    }
+    for (IndexInfo *index : GetTableIndexes(table_name)) {
+      indexes_.erase(index->index_oid_);
+    }
+    index_names_.erase(table_name);
+    names_.erase(table_name);
+    tables_.erase(table->oid_);
+    return true;
+  }
 
   /**
    * Create a new index, populate existing data of the table and return its metadata.
@@ -95,25 +187,67 @@ class Catalog {
    * @param key_schema the schema of the key
    * @param key_attrs key attributes
    * @param keysize size of the key
+   * @param placement where to keep the pages of the index
    * @return a pointer to the metadata of the new table
    */
   template <class KeyType, class ValueType, class KeyComparator>
   IndexInfo *CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name,
                          const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs,
-                         size_t keysize) {
-    return nullptr;
+                         size_t keysize, const Placement &placement = Placement::Shared()) {
+    BUSTUB_ASSERT(index_names_[table_name].count(index_name) == 0, "Index names should be unique!");
+    TableMetadata *table = GetTable(table_name);
+    tablespace_id_t tablespace = PlaceOnDisk(placement);
+    index_oid_t index_oid = next_index_oid_++;
+    auto *index_metadata = new IndexMetadata(index_name, table_name, &schema, key_attrs);
+    auto index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(index_metadata, bpm_,
+                                                                                     INVALID_PAGE_ID, tablespace);
+    for (auto it = table->table_->Begin(txn); it != table->table_->End(); ++it) {
+      index->InsertEntry(it->KeyFromTuple(schema, key_schema, key_attrs), it->GetRid(), txn);
+    }
+    auto info = std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name, keysize);
+    info->tablespace_ = tablespace;
+    info->owns_tablespace_ = placement.own_file_;
+    auto *result = info.get();
+    indexes_.emplace(index_oid, std::move(info));
+    index_names_[table_name].emplace(index_name, index_oid);
+    return result;
   }
 
-  IndexInfo *GetIndex(const std::string &index_name, const std::string &table_name) { return nullptr; }
+  /**
+   * @return index metadata by index name and table name
+   * @throws std::out_of_range if there is no such index
+   */
+  IndexInfo *GetIndex(const std::string &index_name, const std::string &table_name) {
+    return GetIndex(index_names_.at(table_name).at(index_name));
+  }
 
-  IndexInfo *GetIndex(index_oid_t index_oid) { return nullptr; }
+  /**
+   * @return index metadata by oid
+   * @throws std::out_of_range if there is no such index
+   */
+  IndexInfo *GetIndex(index_oid_t index_oid) { return indexes_.at(index_oid).get(); }
 
-  std::vector<IndexInfo *> GetTableIndexes(const std::string &table_name) { return std::vector<IndexInfo *>(); }
+  /** @return the indexes of a table */
+  std::vector<IndexInfo *> GetTableIndexes(const std::string &table_name) {
+    std::vector<IndexInfo *> indexes;
+    auto table_indexes = index_names_.find(table_name);
+    if (table_indexes != index_names_.end()) {
+      for (const auto &[index_name, index_oid] : table_indexes->second) {
+        indexes.push_back(GetIndex(index_oid));
+      }
+    }
+    return indexes;
+  }
 
  private:
-  [[maybe_unused]] BufferPoolManager *bpm_;
-  [[maybe_unused]] LockManager *lock_manager_;
-  [[maybe_unused]] LogManager *log_manager_;
+  /** @return the tablespace to put a new table or index in, which is created if it is to be its own */
+  tablespace_id_t PlaceOnDisk(const Placement &placement) {
+    return placement.own_file_ ? bpm_->CreateTablespace(placement.file_name_) : placement.tablespace_;
+  }
+
+  BufferPoolManager *bpm_;
+  LockManager *lock_manager_;
+  LogManager *log_manager_;
 
   /** tables_ : table identifiers -> table metadata. Note that tables_ owns all table metadata. */
   std::unordered_map<table_oid_t, std::unique_ptr<TableMetadata>> tables_;
@@ -27,6 +27,15 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** If the background writer of a buffer pool is running, it wakes up every BGWRITER_INTERVAL milliseconds. */
+extern std::chrono::milliseconds bgwriter_interval;
+
+/** If a buffer pool has a hot set file, its background writer saves the hot set every HOT_SET_INTERVAL. */
+extern std::chrono::milliseconds hot_set_interval;
+
+/** A running page scrubber checks whether the disk is idle every SCRUBBER_INTERVAL. */
+extern std::chrono::milliseconds scrubber_interval;
+
 static constexpr int INVALID_PAGE_ID = -1;                                    // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                     // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                        // invalid log sequence number
@@ -35,6 +44,25 @@ static constexpr int PAGE_SIZE = 4096;                                        //
 static constexpr int BUFFER_POOL_SIZE = 10;                                   // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
+static constexpr int LRUK_REPLACER_K = 2;                                     // lookback window for lru-k replacer
+static constexpr int SCAN_RING_SIZE = 32;  // max frames a buffer pool instance recycles for sequential scans
+static constexpr int SCAN_PREFETCH_DEPTH = 4;  // pages iterators read ahead of their current page
+static constexpr double BGWRITER_CLEAN_FRACTION = 0.25;  // evictable frames the background writer keeps clean
+static constexpr int OPTIMISTIC_READ_RETRIES = 3;  // optimistic B+ tree descents tried before latching one
+static constexpr int BUFFER_POOL_MAX_CHUNKS = 16;  // a buffer pool instance grows to at most this many initial sizes
+static constexpr int HOT_SET_LOAD_THREADS = 4;  // threads a buffer pool instance reads its saved hot set back with
+static constexpr int ASYNC_IO_QUEUE_DEPTH = 64;  // page requests an async disk manager keeps in flight
+static constexpr int ASYNC_IO_THREADS = 4;  // workers an async disk manager uses when io_uring is not available
+static constexpr int PREFETCH_BATCH_SIZE = 16;  // queued single-page prefetches fetched with one FetchPages
+static constexpr int PREFETCH_QUEUE_SIZE = 1024;  // prefetch requests queued at most; further ones are dropped
+static constexpr int FREE_SPACE_MAP_INTERVAL = PAGE_SIZE * 8;  // db file pages tracked by one free-space map page
+static constexpr int SCRUB_PAGES_PER_ROUND = 64;  // pages a page scrubber verifies each time it finds the disk idle
+static constexpr int DOUBLE_WRITE_PAGES = 64;  // pages the double-write file journals at a time
+static constexpr size_t MEMORY_DISK_MAX_PAGES = 1 << 22;  // page ids an in-memory disk reserves address space for
+static constexpr int TABLESPACE_SHIFT = 24;  // page ids keep their tablespace in the bits from this one on
+static constexpr int MAX_TABLESPACES = 128;  // tablespaces a disk manager can manage, the db file included
+static constexpr int COMPRESSED_SLOT_SIZE = 256;  // unit a compressing disk manager stores page images in
+static constexpr int EXTENT_PAGES = 64;  // pages a disk manager preallocates, and reserves for a growing table, at once
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
@@ -42,5 +70,19 @@ using txn_id_t = int32_t;      // transaction id type
 using lsn_t = int32_t;         // log sequence number type
 using slot_offset_t = size_t;  // slot offset type
 using oid_t = uint16_t;
+using tablespace_id_t = int32_t;  // tablespace id type
+
+static constexpr tablespace_id_t DEFAULT_TABLESPACE = 0;  // the tablespace of the db file itself
+
+/** @return the tablespace a page belongs to */
+inline tablespace_id_t GetTablespace(page_id_t page_id) { return page_id >> TABLESPACE_SHIFT; }
+
+/** @return the number of a page within the file of its tablespace */
+inline page_id_t GetPageNumber(page_id_t page_id) { return page_id & ((1 << TABLESPACE_SHIFT) - 1); }
+
+/** @return the id of the page with the given number in a tablespace */
+inline page_id_t MakePageId(tablespace_id_t tablespace, page_id_t page_no) {
+  return (tablespace << TABLESPACE_SHIFT) | page_no;
+}
 
 }  // namespace bustub
@@ -47,6 +47,10 @@ enum class ExceptionType {
   OUT_OF_MEMORY = 9,
   /** Method not implemented. */
   NOT_IMPLEMENTED = 11,
+  /** Data read back from disk is not what was written. */
+  CORRUPTION = 12,
+  /** A data file could not be read or written. */
+  IO = 13,
 };
 
 class Exception : public std::runtime_error {
@@ -85,11 +89,18 @@ class Exception : public std::runtime_error {
         return "Out of Memory";
       case ExceptionType::NOT_IMPLEMENTED:
         return "Not implemented";
+      case ExceptionType::CORRUPTION:
+        return "Corruption";
+      case ExceptionType::IO:
+        return "I/O";
       default:
         return "Unknown";
     }
   }
 
+  /** @return the type of the exception */
+  ExceptionType GetType() const { return type_; }
+
  private:
   ExceptionType type_;
 };
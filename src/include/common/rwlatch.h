@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <climits>
 #include <condition_variable>  // NOLINT
 #include <mutex>               // NOLINT
@@ -22,6 +23,12 @@ namespace bustub {
 
 /**
  * Reader-Writer latch backed by std::mutex.
+ *
+ * The latch also keeps a version counter that is odd while a writer holds it and is bumped on every write unlock. A
+ * reader that cannot afford the mutex round trip may read optimistically instead: take a version with
+ * TryOptimisticRead, read, and keep the result only if Validate still sees the same version. Optimistic readers write
+ * nothing shared, so they neither block writers nor bounce the latch's cache line between each other; in exchange a
+ * read may have to be retried, and whatever was read must not be trusted until it has been validated.
  */
 class ReaderWriterLatch {
   using mutex_t = std::mutex;
@@ -46,6 +53,8 @@ class ReaderWriterLatch {
     while (reader_count_ > 0) {
       writer_.wait(latch);
     }
+    // Odd from here on; the acquire keeps the writer's stores from moving above the bump.
+    version_.fetch_add(1, std::memory_order_acq_rel);
   }
 
   /**
@@ -53,6 +62,7 @@ class ReaderWriterLatch {
    */
   void WUnlock() {
     std::lock_guard<mutex_t> guard(mutex_);
+    version_.fetch_add(1, std::memory_order_release);
     writer_entered_ = false;
     reader_.notify_all();
   }
@@ -85,12 +95,39 @@ class ReaderWriterLatch {
     }
   }
 
+  /**
+   * Start an optimistic read.
+   * @param[out] version the version to validate the read against
+   * @return false if a writer holds the latch, in which case reading is pointless
+   */
+  bool TryOptimisticRead(uint64_t *version) const {
+    *version = version_.load(std::memory_order_acquire);
+    return (*version & 1) == 0;
+  }
+
+  /**
+   * Finish an optimistic read.
+   * @param version the version TryOptimisticRead returned
+   * @return true if no writer has held the latch since, i.e. everything read in between is consistent
+   */
+  bool Validate(uint64_t version) const {
+#if defined(__SANITIZE_THREAD__)
+    // ThreadSanitizer does not model fences; a sequentially consistent load is enough for it to see the ordering.
+    return version_.load(std::memory_order_seq_cst) == version;
+#else
+    // The fence keeps the reads being validated from moving below the version check.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version_.load(std::memory_order_relaxed) == version;
+#endif
+  }
+
  private:
   mutex_t mutex_;
   cond_t writer_;
   cond_t reader_;
   uint32_t reader_count_{0};
   bool writer_entered_{false};
+  std::atomic<uint64_t> version_{0};
 };
 
 }  // namespace bustub
@@ -0,0 +1,54 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c.h
+//
+// Identification: src/include/common/util/crc32c.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * CRC32C (Castagnoli) checksums, as used to verify pages read back from disk.
+ *
+ * Compute uses the SSE4.2 crc32 instruction when the build targets a CPU that has it, and a table-driven software
+ * implementation otherwise. Both produce the same checksums.
+ */
+class Crc32c {
+ public:
+  /**
+   * @param data the bytes to checksum
+   * @param length the number of bytes
+   * @param crc the checksum of the bytes that come before data, to extend it
+   * @return the checksum of the bytes
+   */
+  static uint32_t Compute(const char *data, size_t length, uint32_t crc = 0) {
+    return IsHardwareAccelerated() ? ComputeHardware(data, length, crc) : ComputeSoftware(data, length, crc);
+  }
+
+  /** Compute with the software implementation, whatever the CPU. */
+  static uint32_t ComputeSoftware(const char *data, size_t length, uint32_t crc = 0);
+
+  /** Compute with the crc32 instruction. Falls back to the software implementation if the build does not have it. */
+  static uint32_t ComputeHardware(const char *data, size_t length, uint32_t crc = 0);
+
+  /** @return true if Compute uses the crc32 instruction */
+  static constexpr bool IsHardwareAccelerated() {
+#ifdef __SSE4_2__
+    return true;
+#else
+    return false;
+#endif
+  }
+};
+
+}  // namespace bustub
@@ -0,0 +1,242 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_disk_manager.h
+//
+// Identification: src/include/storage/disk/async_disk_manager.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <linux/io_uring.h>
+#include <sys/uio.h>
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * AsyncDiskManager reads and writes the pages of a DiskManager's database file without blocking the caller, keeping up
+ * to a queue depth of requests in flight at once.
+ *
+ * Requests go to the kernel through an io_uring. A batch is queued with a single system call, and a completion thread
+ * reaps the results. Each page's checksum goes through the ring with it: a write's checksum is linked behind the page,
+ * and a read's is read alongside the page and compared once both have arrived, so the completion thread does no I/O
+ * of its own. If the kernel does not support io_uring, a small pool of threads performs the requests with the
+ * DiskManager instead, so the interface works everywhere.
+ *
+ * Every request returns a future that becomes ready once all of its pages have been transferred, and that throws an
+ * Exception from get() if any of them failed: of type CORRUPTION if a page read does not match its checksum. Checksums
+ * are written and verified as with DiskManager, and pages beyond the end of the file read as zeros. If the DiskManager
+ * uses double write, writes are handed to DiskManager::WritePages, and are done by the time the future is returned.
+ * If it stores pages compressed, the thread pool is used, as only the DiskManager knows where each page is.
+ * The buffers must stay valid, and must not be touched, until the future is ready. The DiskManager's read and write
+ * counters include the pages transferred here.
+ */
+class AsyncDiskManager {
+ public:
+  /**
+   * Creates a new async disk manager. It must be destroyed before disk_manager is shut down.
+   * @param disk_manager the disk manager whose database file is read and written
+   * @param queue_depth the maximum number of page requests in flight
+   * @param use_io_uring false to always use the thread pool
+   */
+  explicit AsyncDiskManager(DiskManager *disk_manager, size_t queue_depth = ASYNC_IO_QUEUE_DEPTH,
+                            bool use_io_uring = true);
+
+  /**
+   * Waits for all requests in flight, then releases the ring or stops the threads.
+   */
+  ~AsyncDiskManager();
+
+  /**
+   * Read a page from the database file.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer
+   * @return a future that is ready once the page has been read
+   */
+  std::future<void> ReadPageAsync(page_id_t page_id, char *page_data);
+
+  /**
+   * Write a page to the database file.
+   * @param page_id id of the page
+   * @param page_data raw page data
+   * @return a future that is ready once the page has been written
+   */
+  std::future<void> WritePageAsync(page_id_t page_id, const char *page_data);
+
+  /**
+   * Read several pages from the database file, queueing them together.
+   * @param page_ids ids of the pages
+   * @param[out] page_data one output buffer per page
+   * @return a future that is ready once every page has been read
+   */
+  std::future<void> ReadPagesAsync(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data);
+
+  /**
+   * Write several pages to the database file, queueing them together. The ids must be distinct.
+   * @param page_ids ids of the pages
+   * @param page_data raw data of each page
+   * @return a future that is ready once every page has been written
+   */
+  std::future<void> WritePagesAsync(const std::vector<page_id_t> &page_ids, const std::vector<const char *> &page_data);
+
+  /** @return true if requests go through an io_uring, false if they go through the thread pool */
+  bool UsesIoUring() const { return ring_fd_ >= 0; }
+
+  /** @return the maximum number of page requests in flight */
+  size_t GetQueueDepth() const { return queue_depth_; }
+
+ private:
+  struct Batch;
+
+  /** One page to transfer. */
+  struct Request {
+    Batch *batch_;
+    page_id_t page_id_;
+    char *data_;
+    bool is_write_;
+    /** The page's data file, held so that dropping its tablespace cannot close the fd while the kernel uses it. */
+    std::shared_ptr<DiskManager::DataFile> file_;
+    /** The buffer handed to the kernel; it must live as long as the request is in flight. */
+    struct iovec iov_;
+    /** The page's checksum, to be written after the page or read along with it, and its buffer for the kernel. */
+    uint32_t checksum_;
+    struct iovec checksum_iov_;
+    /** Number of the request's submission queue entries that have not completed yet. */
+    std::atomic<int> entries_left_;
+    /** Results of the page's and the checksum's entries: bytes transferred, or a negative errno. */
+    int result_;
+    int checksum_result_;
+  };
+
+  /** Requests submitted together, which share one future. */
+  struct Batch {
+    std::unique_ptr<Request[]> requests_;
+    size_t num_requests_;
+    std::promise<void> done_;
+    std::atomic<size_t> remaining_;
+    std::atomic<bool> failed_{false};
+    std::atomic<bool> corrupt_{false};
+  };
+
+  /** Pointers into the memory the kernel shares with us for a ring. */
+  struct Ring {
+    unsigned *sq_head_;
+    unsigned *sq_tail_;
+    unsigned sq_mask_;
+    unsigned *cq_head_;
+    unsigned *cq_tail_;
+    unsigned cq_mask_;
+    io_uring_sqe *sqes_;
+    io_uring_cqe *cqes_;
+    void *sq_map_;
+    size_t sq_map_size_;
+    void *cq_map_;
+    size_t cq_map_size_;
+    size_t sqes_map_size_;
+  };
+
+  /**
+   * Set up the io_uring.
+   * @return false if the kernel refused, in which case nothing is left to clean up
+   */
+  bool SetUpRing();
+
+  /** Unmap and close the io_uring. */
+  void TearDownRing();
+
+  /** Allocate a batch of requests for the given pages and queue it. */
+  std::future<void> Submit(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data,
+                           bool is_write);
+
+  /** Submission queue entries per request: one for the page and one for its checksum. */
+  static constexpr size_t ENTRIES_PER_REQUEST = 2;
+  /** Set in the user data of a checksum's entry; the request's own pointer is the page's. */
+  static constexpr uint64_t CHECKSUM_ENTRY = 1;
+
+  /**
+   * Fill in the next submission queue entries. The caller holds submit_latch_.
+   * @param request the request to submit, nullptr for a no-op that only wakes the completion thread
+   * @return the number of entries filled in
+   */
+  unsigned PrepareEntries(Request *request);
+
+  /** Hand the batch's requests to the kernel, waiting for room whenever queue depth requests are in flight. */
+  void SubmitToRing(Batch *batch);
+
+  /**
+   * Tell the kernel about every queued submission queue entry. The caller holds submit_latch_.
+   * @param to_submit number of entries queued since the last call
+   * @param[out] taken_back the user data of the entries the kernel would not take, which the caller completes as
+   * cancelled once it has released submit_latch_
+   */
+  void EnterRing(unsigned to_submit, std::vector<uint64_t> *taken_back);
+
+  /** Main loop of the completion thread: reap completions until the wakeup entry submitted on shutdown arrives. */
+  void ReapCompletions();
+
+  /**
+   * Record the result of one submission queue entry, and finish its request if that was the last one.
+   * @param user_data the entry's user data
+   * @param result the number of bytes transferred, or a negative errno
+   */
+  void CompleteEntry(uint64_t user_data, int result);
+
+  /** Finish a request all of whose entries have completed, doing it again synchronously if they fell short. */
+  void CompleteRequest(Request *request);
+
+  /** Main loop of the thread pool workers. */
+  void RunWorker();
+
+  /** Perform a request with the DiskManager. */
+  void PerformRequest(Request *request);
+
+  /**
+   * Count one request of the batch as done, and fulfil its promise if it was the last one.
+   * @param request the request
+   * @param failed true if the transfer failed
+   * @param corrupt true if the page read does not match its checksum
+   */
+  void FinishRequest(Request *request, bool failed, bool corrupt);
+
+  DiskManager *disk_manager_;
+  size_t queue_depth_;
+
+  /** File descriptor of the io_uring, -1 if the thread pool is used instead. */
+  int ring_fd_{-1};
+  Ring ring_{};
+  /** Reaps completions from the ring. */
+  std::thread completion_thread_;
+  /** Number of submission queue entries handed to the kernel that have not completed yet. */
+  size_t in_flight_{0};
+  /** Protects the submission queue and in_flight_. */
+  std::mutex submit_latch_;
+  /** Signalled when a request completes. */
+  std::condition_variable submit_cv_;
+
+  /** Thread pool used when io_uring is not available. */
+  std::vector<std::thread> workers_;
+  /** Requests the workers have not picked up yet. */
+  std::deque<Request *> queue_;
+  bool stopped_{false};
+  /** Protects queue_ and stopped_. */
+  std::mutex queue_latch_;
+  /** Signalled when a request is queued or the workers are stopped. */
+  std::condition_variable queue_cv_;
+};
+
+}  // namespace bustub
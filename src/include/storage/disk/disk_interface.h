@@ -0,0 +1,173 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_interface.h
+//
+// Identification: src/include/storage/disk/disk_interface.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <future>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "common/exception.h"
+
+namespace bustub {
+
+/**
+ * DiskInterface is what the buffer pool and the log manager need from the storage below them: page and log I/O, and
+ * page allocation.
+ *
+ * Pages are grouped into tablespaces. A page id carries its tablespace in the bits from TABLESPACE_SHIFT on, so the
+ * ids of DEFAULT_TABLESPACE are the page numbers themselves. Backends that keep a single file or region only have the
+ * default tablespace.
+ *
+ * DiskManager keeps the database in a file. DiskManagerMemory keeps it in memory, which takes I/O out of a benchmark so
+ * that what is left is CPU cost. DiskManagerLatency wraps either of them and makes their I/O as slow as a given device.
+ */
+class DiskInterface {
+ public:
+  virtual ~DiskInterface() = default;
+
+  /**
+   * Shut down the disk and release its resources.
+   */
+  virtual void ShutDown() = 0;
+
+  /**
+   * Write a page.
+   * @param page_id id of the page
+   * @param page_data raw page data
+   */
+  virtual void WritePage(page_id_t page_id, const char *page_data) = 0;
+
+  /**
+   * Write several pages.
+   * @param page_ids ids of the pages, which must be distinct
+   * @param page_data raw data of each page
+   */
+  virtual void WritePages(const std::vector<page_id_t> &page_ids, const std::vector<const char *> &page_data) {
+    for (size_t i = 0; i < page_ids.size(); ++i) {
+      WritePage(page_ids[i], page_data[i]);
+    }
+  }
+
+  /**
+   * Read a page. A page that has never been written reads as zeros.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer
+   * @throws Exception of type CORRUPTION if the page is found to be corrupt; page_data holds what was read
+   */
+  virtual void ReadPage(page_id_t page_id, char *page_data) = 0;
+
+  /**
+   * Read several pages, which should be sorted by id.
+   * @param page_ids ids of the pages
+   * @param[out] page_data one output buffer per page
+   * @throws Exception of type CORRUPTION, once every page has been read, if any of them is found to be corrupt
+   */
+  virtual void ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data) {
+    for (size_t i = 0; i < page_ids.size(); ++i) {
+      ReadPage(page_ids[i], page_data[i]);
+    }
+  }
+
+  /**
+   * Check data that was read for a page, to find out which pages of a batch ReadPages complained about.
+   * @param page_id id of the page
+   * @param page_data the data read
+   * @return false if the data is corrupt
+   */
+  virtual bool VerifyPage(page_id_t page_id, const char *page_data) { return true; }
+
+  /**
+   * Append to the log and flush it.
+   * @param log_data raw log data
+   * @param size size of log entry
+   */
+  virtual void WriteLog(char *log_data, int size) = 0;
+
+  /**
+   * Read a log entry.
+   * @param[out] log_data output buffer
+   * @param size size of the log entry
+   * @param offset offset of the log entry in the log
+   * @return true if the read was successful, false if offset is past the end of the log
+   */
+  virtual bool ReadLog(char *log_data, int size, int offset) = 0;
+
+  /**
+   * Allocate a page, reusing the lowest free page id. Buffer pool instances that share the disk restrict themselves to
+   * the page ids congruent to their index modulo their number.
+   * @param num_instances the number of buffer pool instances sharing the disk
+   * @param instance_index the index of the instance asking
+   * @param tablespace the tablespace to allocate the page in
+   * @param near_page_id a page that the new one should be stored next to, e.g. the last page of the same table, so that
+   * reading them in page id order is sequential; INVALID_PAGE_ID for none. A backend may ignore it.
+   * @return the id of the allocated page
+   */
+  virtual page_id_t AllocatePage(uint32_t num_instances = 1, uint32_t instance_index = 0,
+                                 tablespace_id_t tablespace = DEFAULT_TABLESPACE,
+                                 page_id_t near_page_id = INVALID_PAGE_ID) = 0;
+
+  /**
+   * Deallocate a page, making its id free for reuse. Deallocating a free page does nothing.
+   * @param page_id id of the page to deallocate
+   */
+  virtual void DeallocatePage(page_id_t page_id) = 0;
+
+  /**
+   * @param page_id id of the page
+   * @return true if the page is allocated
+   */
+  virtual bool IsAllocated(page_id_t page_id) = 0;
+
+  /**
+   * Create a tablespace with no pages.
+   * @param file_name where to keep its pages; empty to let the disk choose
+   * @return the id of the new tablespace
+   * @throws Exception of type NOT_IMPLEMENTED if the disk only has the default tablespace
+   */
+  virtual tablespace_id_t CreateTablespace(const std::string &file_name) {
+    throw NotImplementedException("this disk only has the default tablespace");
+  }
+
+  /**
+   * Drop a tablespace and all of its pages at once. Nothing may use its pages any more.
+   * @param tablespace the tablespace to drop, which must not be DEFAULT_TABLESPACE
+   * @throws Exception of type NOT_IMPLEMENTED if the disk only has the default tablespace
+   */
+  virtual void DropTablespace(tablespace_id_t tablespace) {
+    throw NotImplementedException("this disk only has the default tablespace");
+  }
+
+  /** @return the number of log flushes */
+  virtual int GetNumFlushes() const = 0;
+
+  /** @return true iff the in-memory log content has not been flushed yet */
+  virtual bool GetFlushState() const = 0;
+
+  /** @return the number of page writes */
+  virtual int GetNumWrites() const = 0;
+
+  /** @return the number of page reads */
+  virtual int GetNumReads() const = 0;
+
+  /**
+   * Sets the future which is used to check for non-blocking flushes.
+   * @param f the non-blocking flush check
+   */
+  virtual void SetFlushLogFuture(std::future<void> *f) = 0;
+
+  /** Checks if the non-blocking flush future was set. */
+  virtual bool HasFlushLogFuture() = 0;
+};
+
+}  // namespace bustub
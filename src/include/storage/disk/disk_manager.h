@@ -12,54 +12,159 @@
 
 #pragma once
 
+#include <sys/types.h>
+#include <array>
 #include <atomic>
 #include <fstream>
 #include <future>  // NOLINT
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <shared_mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
+#include "storage/disk/disk_interface.h"
 
 namespace bustub {
 
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ * It is the file backend of DiskInterface.
+ *
+ * Page I/O is positional and does not take a latch, so concurrent reads and writes from many threads proceed in
+ * parallel. Writes to the same page from different threads must be ordered by the caller.
+ *
+ * Which pages are allocated is kept in free-space map pages stored in the db file itself: each run of
+ * FREE_SPACE_MAP_INTERVAL pages is preceded by a map page holding one bit per page. Page ids are unaffected, and a
+ * missing map page means its pages are all free. Map pages are written through on every allocation and deallocation.
+ *
+ * The map page is followed by checksum pages holding the CRC32C of every page of the run. WritePage stores the
+ * checksum after the data, and reads verify it, so a page that was corrupted or only partly written, e.g. by a crash,
+ * is reported with an Exception of type CORRUPTION rather than handed out. A checksum of 0 means that the page has not
+ * been written since it was allocated, and is not verified.
+ *
+ * A disk manager created with double_write set survives torn page writes rather than just reporting them. Pages are
+ * first journaled, up to DOUBLE_WRITE_PAGES at a time, to a double-write file next to the db file with one sequential
+ * write and one sync; then they are written in place and the db file is synced. If a crash tears an in-place write, the
+ * journaled copy is intact, and the next disk manager opened on the file writes it back. A torn journal write is
+ * recognized by its checksums and ignored, as the pages in place have not been touched yet. The double-write file is
+ * removed by ShutDown, so it is left behind only by a crash, and recovered from whether or not double_write is set.
+ *
+ * The db file holds DEFAULT_TABLESPACE. Every other tablespace has a data file of its own, laid out the same way, which
+ * may live on another device, e.g. to give an index its own disk. Dropping a tablespace just unlinks its file. Which
+ * tablespaces exist is kept in a tablespace file next to the db file, with one line of id and file name each, which is
+ * replaced whenever a tablespace is created or dropped.
+ *
+ * Page ids are grouped into extents of extent_pages consecutive pages. Disk space is preallocated with fallocate an
+ * extent at a time as pages are allocated in it, so a data file does not grow block by block as its pages are first
+ * written, and an extent's pages lie next to each other on the device. The file size is left alone, so unwritten pages
+ * still read as zeros and truncation works as before. An allocation near a page, e.g. the last page of a table,
+ * reserves the lowest extent with nothing allocated in it, and the allocations near the page handed out last there take
+ * the next free pages of the extent; all other allocations skip it until it is full or empty again. A table thus grows
+ * an extent at a time, and scanning it in page id order reads its data file sequentially, while its first page comes
+ * from wherever there is room, so that small tables do not take an extent each. Reservations are not persisted; after
+ * a restart, a table goes on in a fresh extent.
+ *
+ * A disk manager created with compress set stores pages compressed with LzCodec, which shrinks table heaps of mostly
+ * numeric columns several times over. Each data file gets a slot file, where every page image takes a slot of as many
+ * COMPRESSED_SLOT_SIZE units as it needs, and a slot map file, which says where in the slot file each page is. Writes
+ * go to a free slot and then repoint the map, so the previous image stays intact until the new one is complete. The
+ * freed slot is reused by later writes of the same size or smaller; the slot file never shrinks. The checksums still
+ * cover the uncompressed pages. A db file that has a slot file is opened compressed whether or not compress is set.
  */
-class DiskManager {
+class DiskManager : public DiskInterface {
  public:
   /**
-   * Creates a new disk manager that writes to the specified database file.
+   * Creates a new disk manager that writes to the specified database file, and opens the tablespaces listed in the
+   * tablespace file next to it. Pages that a crash left in a double-write file are restored first.
    * @param db_file the file name of the database file to write to
+   * @param double_write true to journal every page write to a double-write file first
+   * @param compress true to store pages compressed
+   * @param extent_pages the number of pages in an extent, a power of two no larger than FREE_SPACE_MAP_INTERVAL
    */
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file, bool double_write = false, bool compress = false,
+                       uint32_t extent_pages = EXTENT_PAGES);
 
-  ~DiskManager() = default;
+  ~DiskManager() override;
 
   /**
    * Shut down the disk manager and close all the file resources.
    */
-  void ShutDown();
+  void ShutDown() override;
 
   /**
    * Write a page to the database file.
    * @param page_id id of the page
    * @param page_data raw page data
+   * @throws Exception of type IO if the page cannot be written
    */
-  void WritePage(page_id_t page_id, const char *page_data);
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  /**
+   * Write several pages to the database file. With double write, they are journaled together rather than one by one,
+   * which saves a pair of syncs per page.
+   * @param page_ids ids of the pages, which must be distinct
+   * @param page_data raw data of each page
+   * @throws Exception of type IO if a page cannot be written; the pages after it are not written either
+   */
+  void WritePages(const std::vector<page_id_t> &page_ids, const std::vector<const char *> &page_data) override;
+
+  /** @return true if page writes are journaled to a double-write file first */
+  bool UsesDoubleWrite() const { return dwb_fd_ >= 0; }
+
+  /** @return the number of pages in an extent */
+  uint32_t GetExtentPages() const { return extent_pages_; }
+
+  /** @return true if pages are stored compressed */
+  bool UsesCompression() const { return compress_; }
+
+  /** @return the number of pages restored from the double-write file when the disk manager was created */
+  size_t GetNumRestoredPages() const { return num_restored_pages_; }
 
   /**
    * Read a page from the database file.
    * @param page_id id of the page
    * @param[out] page_data output buffer
+   * @throws Exception of type CORRUPTION if the page does not match its checksum; page_data holds what was read
+   * @throws Exception of type IO if the page cannot be read
    */
-  void ReadPage(page_id_t page_id, char *page_data);
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  /**
+   * Read several pages from the database file. Runs of consecutive page ids are read with a single request, so the
+   * ids should be sorted. Pages beyond the end of the file read as zeros.
+   * @param page_ids ids of the pages
+   * @param[out] page_data one output buffer per page
+   * @throws Exception of type CORRUPTION, once every page has been read, if any of them does not match its checksum
+   * @throws Exception of type IO if a page cannot be read; the pages after it are not read
+   */
+  void ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data) override;
+
+  /**
+   * Check data that was read for a page against the page's checksum.
+   * @param page_id id of the page
+   * @param page_data the data read
+   * @return false if the data does not match the checksum
+   */
+  bool VerifyPage(page_id_t page_id, const char *page_data) override;
+
+  /**
+   * Read a page and check it against its checksum, without counting it as a page read.
+   * @param page_id id of the page
+   * @return false if the page does not match its checksum
+   */
+  bool CheckPage(page_id_t page_id);
 
   /**
    * Flush the entire log buffer into disk.
    * @param log_data raw log data
    * @param size size of log entry
    */
-  void WriteLog(char *log_data, int size);
+  void WriteLog(char *log_data, int size) override;
 
   /**
    * Read a log entry from the log file.
@@ -68,51 +173,317 @@ class DiskManager {
    * @param offset offset of the log entry in the file
    * @return true if the read was successful, false otherwise
    */
-  bool ReadLog(char *log_data, int size, int offset);
+  bool ReadLog(char *log_data, int size, int offset) override;
 
   /**
-   * Allocate a page on disk.
+   * Allocate a page on disk, reusing the lowest free page id. Buffer pool instances that share the file restrict
+   * themselves to the page ids congruent to their index modulo their number.
+   * @param num_instances the number of buffer pool instances sharing the file
+   * @param instance_index the index of the instance asking
+   * @param tablespace the tablespace to allocate the page in
+   * @param near_page_id a page of the tablespace to follow in its reserved extent, or else in a fresh one;
+   * INVALID_PAGE_ID to take the lowest free page id outside the reserved extents
    * @return the id of the allocated page
+   * @throws Exception of type OUT_OF_RANGE if the tablespace does not exist or has no page ids left
    */
-  page_id_t AllocatePage();
+  page_id_t AllocatePage(uint32_t num_instances = 1, uint32_t instance_index = 0,
+                         tablespace_id_t tablespace = DEFAULT_TABLESPACE,
+                         page_id_t near_page_id = INVALID_PAGE_ID) override;
 
   /**
-   * Deallocate a page on disk.
+   * Deallocate a page on disk, making its id free for reuse. If it was the last allocated page, the file is truncated
+   * after the allocated page that is now last. Deallocating a free page does nothing.
    * @param page_id id of the page to deallocate
    */
-  void DeallocatePage(page_id_t page_id);
+  void DeallocatePage(page_id_t page_id) override;
+
+  /**
+   * @param page_id id of the page
+   * @return true if the page is allocated
+   */
+  bool IsAllocated(page_id_t page_id) override;
+
+  /**
+   * @param page_id id of the page to start looking at
+   * @return the lowest allocated page id that is at least page_id, in any tablespace, INVALID_PAGE_ID if there is none
+   */
+  page_id_t NextAllocatedPage(page_id_t page_id);
+
+  /**
+   * Create a tablespace with a data file of its own, and record it in the tablespace file.
+   * @param file_name the data file to create, which must not exist yet; empty for one next to the db file
+   * @return the id of the new tablespace
+   * @throws Exception if every tablespace id is taken or the file cannot be created
+   */
+  tablespace_id_t CreateTablespace(const std::string &file_name) override;
+
+  /**
+   * Drop a tablespace by unlinking its data file. Nothing may use its pages any more.
+   * @param tablespace the tablespace to drop
+   * @throws Exception of type OUT_OF_RANGE if the tablespace does not exist or is DEFAULT_TABLESPACE
+   */
+  void DropTablespace(tablespace_id_t tablespace) override;
+
+  /** @return the data file of a tablespace, empty if the tablespace does not exist */
+  std::string GetTablespaceFile(tablespace_id_t tablespace);
+
+  /**
+   * Truncate every data file after its last allocated page.
+   * @return the number of pages, free-space map pages included, that the files shrank by
+   */
+  size_t TruncateFreePages();
+
+  /** @return the size of the db file in bytes, free-space map pages included */
+  int64_t GetDbFileSize();
+
+  /** @return the bytes of disk space that the data files take up, slot files included, which may be sparse */
+  int64_t GetDiskUsage();
 
   /** @return the number of disk flushes */
-  int GetNumFlushes() const;
+  int GetNumFlushes() const override;
 
   /** @return true iff the in-memory content has not been flushed yet */
-  bool GetFlushState() const;
+  bool GetFlushState() const override;
 
   /** @return the number of disk writes */
-  int GetNumWrites() const;
+  int GetNumWrites() const override;
+
+  /** @return the number of page reads */
+  int GetNumReads() const override;
+
+  /**
+   * @return the number of writes of pages in place that have been started. Together with GetWritesFinished, it tells
+   * a reader of the data file whether a write overlapped what it read.
+   */
+  uint64_t GetWritesStarted() const { return writes_started_.load(); }
+
+  /** @return the number of writes of pages in place whose data and checksum have both been written */
+  uint64_t GetWritesFinished() const { return writes_finished_.load(); }
 
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
    */
-  inline void SetFlushLogFuture(std::future<void> *f) { flush_log_f_ = f; }
+  void SetFlushLogFuture(std::future<void> *f) override { flush_log_f_ = f; }
 
   /** Checks if the non-blocking flush future was set. */
-  inline bool HasFlushLogFuture() { return flush_log_f_ != nullptr; }
+  bool HasFlushLogFuture() override { return flush_log_f_ != nullptr; }
 
  private:
-  int GetFileSize(const std::string &file_name);
+  // submits I/O on the data files itself and keeps the counters up to date
+  friend class AsyncDiskManager;
+  // maps the data files read-only, and needs their layout
+  friend class MmapBufferPoolManager;
+
+  /** Suffixes of the slot file and the slot map file of a data file with compression. */
+  static constexpr const char *SLOT_FILE_SUFFIX = ".slots";
+  static constexpr const char *SLOT_MAP_FILE_SUFFIX = ".slotmap";
+
+  /** Where the image of a page is in the slot file. The slot map file is an array of these, indexed by page number. */
+  struct PageSlot {
+    // first COMPRESSED_SLOT_SIZE unit of the slot
+    uint32_t unit_;
+    // bytes in the image: PAGE_SIZE if the page is stored uncompressed, 0 if it has no image and reads as zeros
+    uint32_t length_;
+  };
+
+  /** Units in the largest slot, which holds a page stored uncompressed. */
+  static constexpr uint32_t MAX_SLOT_UNITS = PAGE_SIZE / COMPRESSED_SLOT_SIZE;
+
+  /** The data file of a tablespace, and which of its pages are allocated. Pages are addressed by page number. */
+  struct DataFile {
+    std::string file_name_;
+    // pages are read and written with pread/pwrite at 64-bit offsets, so any number of threads may do I/O at once
+    int fd_{-1};
+    // one page image per run of FREE_SPACE_MAP_INTERVAL pages, with a set bit for every allocated page
+    std::vector<char> free_space_map_;
+    // one past the highest allocated page number
+    page_id_t end_page_no_{0};
+    // for each (num_instances, instance_index) AllocatePage was called with, the lowest page number that may be free
+    std::map<std::pair<uint32_t, uint32_t>, page_id_t> free_page_hints_;
+    // the extents reserved for allocations near their pages, with the page number each last handed out
+    std::map<page_id_t, page_id_t> open_extents_;
+    // every extent below this one is reserved or has an allocated page, so a fresh extent is searched for from here
+    page_id_t empty_extent_hint_{0};
+    // the end of the space that has been preallocated for the file
+    off_t preallocated_end_{0};
+    // protects free_space_map_, end_page_no_, free_page_hints_, open_extents_, empty_extent_hint_, preallocated_end_
+    // and the file length
+    std::mutex free_space_latch_;
+    // with compression: the slot file holding the page images and the slot map file, -1 without
+    int slot_fd_{-1};
+    int slot_map_fd_{-1};
+    // the slot of each page number, as in the slot map file
+    std::vector<PageSlot> slots_;
+    // the first unit of each free slot, by its number of units
+    std::array<std::vector<uint32_t>, MAX_SLOT_UNITS + 1> free_slots_;
+    // one past the last unit of the slot file in use, and the end of the space preallocated for the slot file
+    uint32_t slot_end_{0};
+    off_t slot_preallocated_end_{0};
+    // protects slots_, free_slots_, slot_end_ and slot_preallocated_end_; held shared while an image is read, so that
+    // its slot is not reused meanwhile
+    std::shared_mutex slot_latch_;
+
+    // the files are closed once nobody uses the data file any more, so a descriptor is never reused under a reader
+    ~DataFile() { CloseDataFile(this); }
+  };
+
+  int64_t GetFileSize(const std::string &file_name);
+
+  /**
+   * @return the data file of a page's tablespace, nullptr if the tablespace does not exist. It stays open for as long
+   * as the caller holds on to it, even if the tablespace is dropped meanwhile.
+   */
+  std::shared_ptr<DataFile> FindFile(page_id_t page_id) const;
+
+  /**
+   * @return the data file of a page's tablespace
+   * @throws Exception of type OUT_OF_RANGE if the tablespace does not exist
+   */
+  std::shared_ptr<DataFile> GetFile(page_id_t page_id) const;
+
+  /**
+   * Open a data file and read its free-space map.
+   * @param file_name the file
+   * @param flags flags to open it with besides O_RDWR
+   * @return the data file, nullptr if it cannot be opened
+   */
+  std::shared_ptr<DataFile> OpenDataFile(const std::string &file_name, int flags);
+
+  /** Close every file of a data file. */
+  static void CloseDataFile(DataFile *file);
+
+  /** Sync every file of a data file. */
+  static void SyncDataFile(DataFile *file);
+
+  /** Open the tablespaces listed in the tablespace file. */
+  void LoadTablespaces();
+
+  /** Replace the tablespace file with one listing the tablespaces that exist now. Needs tablespace_latch_. */
+  void SaveTablespaces();
+
+  /** Pages in front of each run of FREE_SPACE_MAP_INTERVAL pages: the map page and the checksum pages. */
+  static constexpr int RUN_HEADER_PAGES = 1 + FREE_SPACE_MAP_INTERVAL * sizeof(uint32_t) / PAGE_SIZE;
+
+  /** @return the offset of a page in its data file, which accounts for the run header pages in front of it */
+  static off_t PageOffset(page_id_t page_no);
+
+  /** @return the offset of the checksum of a page in its data file */
+  static off_t ChecksumOffset(page_id_t page_no);
+
+  /** @return the checksum to store for a page, never 0 */
+  static uint32_t PageChecksum(const char *page_data);
+
+  /** Store the checksum of a page. */
+  void WriteChecksum(page_id_t page_id, uint32_t checksum);
+
+  /**
+   * Read the stored checksums of consecutive pages within one run; missing ones read as 0.
+   * @param first_page_id id of the first page
+   * @param num_pages number of pages
+   * @param[out] checksums one checksum per page
+   */
+  void ReadChecksums(page_id_t first_page_id, size_t num_pages, uint32_t *checksums);
+
+  /** @return the offset of the free-space map page that tracks the given run of FREE_SPACE_MAP_INTERVAL pages */
+  static off_t MapPageOffset(size_t interval);
+
+  /** Read the free-space map pages of an existing file. */
+  void LoadFreeSpaceMap(DataFile *file);
+
+  /** Set or clear the bit of a page in the free-space map and write its map page. Needs the file's latch. */
+  void SetAllocated(DataFile *file, page_id_t page_no, bool allocated);
+
+  /** @return true if the page's bit is set. Needs the file's latch. */
+  static bool TestAllocated(const DataFile &file, page_id_t page_no);
+
+  /**
+   * @return true if any page of an extent is allocated, or with allocated false, if any is free. Needs the file's
+   * latch.
+   */
+  bool ExtentHas(const DataFile &file, page_id_t extent, bool allocated) const;
+
+  /**
+   * Stop reserving an extent for allocations near its pages, and lower the free page hints to its start, as
+   * allocations without a near page skipped its free pages while it was reserved. Needs the file's latch.
+   */
+  void CloseExtent(DataFile *file, tablespace_id_t tablespace, page_id_t extent);
+
+  /** Preallocate the space of the extent of a page, unless it has been already. Needs the file's latch. */
+  void PreallocateExtent(DataFile *file, page_id_t page_no);
+
+  /** Truncate the file after page end_page_no_ - 1. Needs the file's latch. */
+  size_t TruncateAfterLastPage(DataFile *file);
+
+  /**
+   * Write the data of a page to its data file, or to a new slot in its slot file with compression.
+   * @return false on an I/O error
+   */
+  bool WritePageData(DataFile *file, page_id_t page_no, const char *page_data);
+
+  /**
+   * Read the data of a page from its data file, or from its slot with compression. An image that cannot be decompressed
+   * reads as zeros, so that it fails the checksum.
+   * @return the number of bytes read, which is short only at the end of the file, or -1 on error
+   */
+  ssize_t ReadPageData(DataFile *file, page_id_t page_no, char *page_data);
+
+  /** Read the slot map file of an existing data file, and collect the free slots between the slots in use. */
+  void LoadSlotMap(DataFile *file);
+
+  /** @return the first unit of a free slot of the given size, split off a larger one or at the end of the file */
+  uint32_t AllocateSlot(DataFile *file, uint32_t units);
+
+  /** Make a slot free for reuse; a slot with no image is ignored. Needs the file's slot latch. */
+  static void FreeSlot(DataFile *file, const PageSlot &slot);
+
+  /** Point a page at a new slot, write its slot map entry and free its previous slot. Needs the file's slot latch. */
+  void SetSlot(DataFile *file, page_id_t page_no, const PageSlot &slot);
+
+  /** Write a page and then its checksum in place, without journaling it. Throws an IO Exception if the write fails. */
+  void WritePageInPlace(page_id_t page_id, const char *page_data);
+
+  /**
+   * Journal pages to the double-write file and sync it, then write them in place and sync their data files.
+   * @param page_ids ids of the pages, at most DOUBLE_WRITE_PAGES
+   * @param page_data raw data of each page
+   * @param num_pages the number of pages
+   */
+  void DoubleWritePages(const page_id_t *page_ids, const char *const *page_data, size_t num_pages);
+
+  /** Write back the intact journaled pages of a double-write file left behind by a crash, then remove the file. */
+  void RecoverDoubleWriteFile();
+
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
   std::string file_name_;
-  std::atomic<page_id_t> next_page_id_;
+  // the data file of each tablespace that exists; the db file is files_[DEFAULT_TABLESPACE]. I/O looks the files up
+  // without a latch, so they are only replaced with std::atomic_store and friends, and read with std::atomic_load
+  // outside tablespace_latch_.
+  std::array<std::shared_ptr<DataFile>, MAX_TABLESPACES> files_;
+  // file that lists the tablespaces other than the default one
+  std::string tablespace_file_name_;
+  // serializes creating and dropping tablespaces against each other and against walks over all of them
+  std::mutex tablespace_latch_;
   int num_flushes_;
-  int num_writes_;
+  std::atomic<int> num_writes_;
+  std::atomic<int> num_reads_;
+  // bumped before a page's data is written and after its checksum is, including by the async disk manager
+  std::atomic<uint64_t> writes_started_{0};
+  std::atomic<uint64_t> writes_finished_{0};
   bool flush_log_;
   std::future<void> *flush_log_f_;
+  // double-write file: a header page with the ids and checksums of the journaled pages, followed by the pages
+  std::string dwb_name_;
+  // descriptor of the double-write file, -1 without double write
+  int dwb_fd_{-1};
+  // serializes double writes, which all go through the one journal
+  std::mutex dwb_latch_;
+  size_t num_restored_pages_{0};
+  // whether pages are stored compressed in slot files
+  bool compress_{false};
+  const uint32_t extent_pages_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,121 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_latency.h
+//
+// Identification: src/include/storage/disk/disk_manager_latency.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <chrono>  // NOLINT
+#include <future>  // NOLINT
+#include <mutex>   // NOLINT
+#include <string>
+#include <vector>
+
+#include "storage/disk/disk_interface.h"
+
+namespace bustub {
+
+/**
+ * How fast a simulated device is. A request waits for the device to transfer its bytes, one request after another at
+ * the bandwidth, and then for the latency, which requests in flight at the same time sit out together.
+ */
+struct DiskProfile {
+  std::chrono::microseconds read_latency_{0};
+  std::chrono::microseconds write_latency_{0};
+  /** Bytes per second, 0 for no limit. */
+  size_t read_bandwidth_{0};
+  size_t write_bandwidth_{0};
+
+  /** @return a local NVMe SSD */
+  static DiskProfile Ssd() {
+    return {std::chrono::microseconds(80), std::chrono::microseconds(20), size_t{3} << 30, size_t{2} << 30};
+  }
+
+  /** @return a network-attached block volume of the kind cloud providers offer */
+  static DiskProfile NetworkVolume() {
+    return {std::chrono::microseconds(600), std::chrono::microseconds(800), size_t{250} << 20, size_t{250} << 20};
+  }
+};
+
+/**
+ * DiskManagerLatency makes the page and log I/O of another DiskInterface as slow as a device with the given profile,
+ * e.g. to reproduce a production SSD or network volume on a laptop. Batched reads and writes count as one request
+ * each. Allocation is passed through as is.
+ */
+class DiskManagerLatency : public DiskInterface {
+ public:
+  /**
+   * Creates a new wrapper.
+   * @param disk the disk that does the I/O; it must outlive the wrapper
+   * @param profile how fast the simulated device is
+   */
+  DiskManagerLatency(DiskInterface *disk, const DiskProfile &profile) : disk_(disk), profile_(profile) {}
+
+  void ShutDown() override { disk_->ShutDown(); }
+
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  void WritePages(const std::vector<page_id_t> &page_ids, const std::vector<const char *> &page_data) override;
+
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  void ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data) override;
+
+  bool VerifyPage(page_id_t page_id, const char *page_data) override { return disk_->VerifyPage(page_id, page_data); }
+
+  void WriteLog(char *log_data, int size) override;
+
+  bool ReadLog(char *log_data, int size, int offset) override;
+
+  page_id_t AllocatePage(uint32_t num_instances = 1, uint32_t instance_index = 0,
+                         tablespace_id_t tablespace = DEFAULT_TABLESPACE,
+                         page_id_t near_page_id = INVALID_PAGE_ID) override {
+    return disk_->AllocatePage(num_instances, instance_index, tablespace, near_page_id);
+  }
+
+  void DeallocatePage(page_id_t page_id) override { disk_->DeallocatePage(page_id); }
+
+  bool IsAllocated(page_id_t page_id) override { return disk_->IsAllocated(page_id); }
+
+  tablespace_id_t CreateTablespace(const std::string &file_name) override {
+    return disk_->CreateTablespace(file_name);
+  }
+
+  void DropTablespace(tablespace_id_t tablespace) override { disk_->DropTablespace(tablespace); }
+
+  int GetNumFlushes() const override { return disk_->GetNumFlushes(); }
+
+  bool GetFlushState() const override { return disk_->GetFlushState(); }
+
+  int GetNumWrites() const override { return disk_->GetNumWrites(); }
+
+  int GetNumReads() const override { return disk_->GetNumReads(); }
+
+  void SetFlushLogFuture(std::future<void> *f) override { disk_->SetFlushLogFuture(f); }
+
+  bool HasFlushLogFuture() override { return disk_->HasFlushLogFuture(); }
+
+ private:
+  /**
+   * Wait as long as the device would take for a request.
+   * @param bytes the number of bytes transferred
+   * @param is_write true for a write, false for a read
+   */
+  void Delay(size_t bytes, bool is_write);
+
+  DiskInterface *disk_;
+  const DiskProfile profile_;
+  /** When the device is done transferring the bytes of the requests so far. */
+  std::chrono::steady_clock::time_point busy_until_;
+  /** Protects busy_until_. */
+  std::mutex latch_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,110 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_memory.h
+//
+// Identification: src/include/storage/disk/disk_manager_memory.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <future>  // NOLINT
+#include <map>
+#include <mutex>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "storage/disk/disk_interface.h"
+
+namespace bustub {
+
+/**
+ * DiskManagerMemory keeps the pages and the log of a database in memory, and loses them when it is destroyed.
+ *
+ * The pages live in one anonymous mapping that is reserved up front but only backed by memory once pages are written,
+ * so page I/O is a copy that takes no latch, and a page that was never written reads as zeros. Deallocating a page
+ * gives its memory back.
+ */
+class DiskManagerMemory : public DiskInterface {
+ public:
+  /**
+   * Creates a new in-memory disk.
+   * @param max_pages the number of page ids the disk can hold; page ids from max_pages on are out of range
+   * @throws Exception OUT_OF_MEMORY if the address space cannot be reserved
+   */
+  explicit DiskManagerMemory(size_t max_pages = MEMORY_DISK_MAX_PAGES);
+
+  ~DiskManagerMemory() override;
+
+  DiskManagerMemory(const DiskManagerMemory &) = delete;
+  DiskManagerMemory &operator=(const DiskManagerMemory &) = delete;
+
+  void ShutDown() override {}
+
+  /** @throws Exception OUT_OF_RANGE if the page id is out of range */
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  /** @throws Exception OUT_OF_RANGE if the page id is out of range */
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  void WriteLog(char *log_data, int size) override;
+
+  bool ReadLog(char *log_data, int size, int offset) override;
+
+  /**
+   * near_page_id is ignored, as there is no reading order to keep in memory.
+   * @throws Exception OUT_OF_MEMORY if every page id the instance may use is taken
+   * @throws Exception NOT_IMPLEMENTED for a tablespace other than the default one
+   */
+  page_id_t AllocatePage(uint32_t num_instances = 1, uint32_t instance_index = 0,
+                         tablespace_id_t tablespace = DEFAULT_TABLESPACE,
+                         page_id_t near_page_id = INVALID_PAGE_ID) override;
+
+  void DeallocatePage(page_id_t page_id) override;
+
+  bool IsAllocated(page_id_t page_id) override;
+
+  int GetNumFlushes() const override { return num_flushes_; }
+
+  bool GetFlushState() const override { return false; }
+
+  int GetNumWrites() const override { return num_writes_; }
+
+  int GetNumReads() const override { return num_reads_; }
+
+  void SetFlushLogFuture(std::future<void> *f) override { flush_log_f_ = f; }
+
+  bool HasFlushLogFuture() override { return flush_log_f_ != nullptr; }
+
+ private:
+  /** @return the data of a page, after checking that its id is in range */
+  char *GetPageData(page_id_t page_id) const;
+
+  const size_t max_pages_;
+  /** Start of the mapping that holds the pages. */
+  char *data_ = nullptr;
+
+  std::vector<char> log_;
+  /** Protects log_. */
+  std::mutex log_latch_;
+
+  /** Whether each page id below allocated_.size() is allocated. */
+  std::vector<bool> allocated_;
+  /** For each (num_instances, instance_index) AllocatePage was called with, the lowest page id that may be free. */
+  std::map<std::pair<uint32_t, uint32_t>, page_id_t> free_page_hints_;
+  /** Protects allocated_ and free_page_hints_. */
+  std::mutex allocation_latch_;
+
+  std::atomic<int> num_flushes_{0};
+  std::atomic<int> num_writes_{0};
+  std::atomic<int> num_reads_{0};
+  std::future<void> *flush_log_f_{nullptr};
+};
+
+}  // namespace bustub
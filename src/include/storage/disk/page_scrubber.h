@@ -0,0 +1,81 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_scrubber.h
+//
+// Identification: src/include/storage/disk/page_scrubber.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <functional>
+#include <mutex>  // NOLINT
+#include <set>
+#include <thread>  // NOLINT
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * PageScrubber verifies the checksums of a DiskManager's pages on a background thread, so that corruption of pages that
+ * are rarely read is found before somebody needs them.
+ *
+ * Every scrubber_interval the scrubber looks at the disk manager's read and write counters. Only if they have not moved
+ * since the last look, i.e. the disk was idle, does it check the next SCRUB_PAGES_PER_ROUND allocated pages, going
+ * through the file in page id order and starting over at the end. Pages the caller reports as hot, e.g. because they
+ * are resident in a buffer pool, are skipped. A page that fails is checked a second time, and left for the next pass
+ * if the disk manager wrote anything meanwhile, since it may just have been caught between its data and its checksum.
+ */
+class PageScrubber {
+ public:
+  /**
+   * Creates a new page scrubber and starts its thread.
+   * @param disk_manager the disk manager whose pages are checked; it must outlive the scrubber
+   * @param is_hot returns true for pages that should not be checked; nullptr to check every page
+   */
+  explicit PageScrubber(DiskManager *disk_manager, std::function<bool(page_id_t)> is_hot = nullptr);
+
+  /**
+   * Stops the thread.
+   */
+  ~PageScrubber();
+
+  /** @return the number of pages checked so far */
+  size_t GetNumScrubbed();
+
+  /** @return the pages whose last check found them not matching their checksums */
+  std::set<page_id_t> GetCorruptPages();
+
+ private:
+  /** Main loop of the scrubber thread. */
+  void Run();
+
+  /** Check up to SCRUB_PAGES_PER_ROUND pages, starting at next_page_id_. */
+  void ScrubRound();
+
+  DiskManager *disk_manager_;
+  std::function<bool(page_id_t)> is_hot_;
+  /** Page the next round starts at. Only touched by the scrubber thread. */
+  page_id_t next_page_id_ = 0;
+  /** Counters of the disk manager at the last tick, -1 before the first one. Only touched by the scrubber thread. */
+  int last_num_reads_ = -1;
+  int last_num_writes_ = -1;
+
+  size_t num_scrubbed_ = 0;
+  std::set<page_id_t> corrupt_pages_;
+  bool running_ = true;
+  std::thread thread_;
+  /** Protects num_scrubbed_, corrupt_pages_ and running_. */
+  std::mutex latch_;
+  /** Signalled when the scrubber is stopped. */
+  std::condition_variable cv_;
+};
+
+}  // namespace bustub
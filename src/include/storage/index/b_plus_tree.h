@@ -10,6 +10,8 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <atomic>
+#include <fstream>
 #include <queue>
 #include <string>
 #include <vector>
@@ -42,9 +44,10 @@ class BPlusTree {
 
  public:
   
+  // new pages of the tree are allocated in the given tablespace
   explicit BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager,
                      const KeyComparator &comparator,
-                      page_id_t root_page_id = INVALID_PAGE_ID);
+                      page_id_t root_page_id = INVALID_PAGE_ID, tablespace_id_t tablespace = DEFAULT_TABLESPACE);
 
   // Returns true if this B+ tree has no keys and values.
   bool IsEmpty() const;
@@ -58,6 +61,9 @@ class BPlusTree {
   // return the value associated with a given key
   bool GetValue(const KeyType &key, std::vector<ValueType> &result, Transaction *transaction = nullptr);
 
+  // let point lookups and iterators descend without read-latching inner nodes, validating page versions instead
+  void SetOptimisticLatching(bool enabled) { optimistic_latching_ = enabled; }
+
 
   int leaf_max_size_;
   int internal_max_size_;
@@ -94,6 +100,10 @@ class BPlusTree {
                Transaction *transaction = nullptr);
 
  private:
+  // read-only descent: returns the leaf for key (or the left most leaf) pinned and read-latched
+  ReadPageGuard FindLeafPageRead(const KeyType &key, bool left_most);
+  // one optimistic attempt at the same; false if a writer got in the way and the descent has to be redone
+  bool FindLeafPageOptimistic(const KeyType &key, bool left_most, ReadPageGuard *leaf);
  /*
   class Checker {
   public:
@@ -153,9 +163,11 @@ class BPlusTree {
   std::string index_name_;
   std::mutex mutex_;                       // protect `root_page_id_` from concurrent modification
   static thread_local bool root_is_locked; // root is locked?
-  page_id_t root_page_id_;
+  std::atomic<page_id_t> root_page_id_;    // atomic, as optimistic descents read it without mutex_
   BufferPoolManager *buffer_pool_manager_;
+  tablespace_id_t tablespace_;
   KeyComparator comparator_;
+  std::atomic<bool> optimistic_latching_{false};
   
 };
 
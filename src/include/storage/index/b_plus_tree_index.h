@@ -25,15 +25,16 @@ namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeIndex : public Index {
  public:
-  BPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager,page_id_t root_page_id = INVALID_PAGE_ID);
+  BPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager,
+                 page_id_t root_page_id = INVALID_PAGE_ID, tablespace_id_t tablespace = DEFAULT_TABLESPACE);
 
   ~BPlusTreeIndex() {}
   
-  void InsertEntry(const Tuple &key, RID rid, Transaction *transaction = nullptr) /*override*/;
+  void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
-  void DeleteEntry(const Tuple &key,Transaction *transaction = nullptr) /*override*/;
+  void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
-  void ScanKey(const Tuple &key, std::vector<RID> &result, Transaction *transaction = nullptr) /*override*/;
+  void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
   INDEXITERATOR_TYPE GetBeginIterator();
 
@@ -24,9 +24,10 @@ INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
  public:
   // you may define your own constructor based on your member variables
-  IndexIterator(BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *,
-                int, BufferPoolManager *);
-  ~IndexIterator();
+  // takes over the pin and read latch on the leaf the iterator starts from; an invalid guard means an empty tree
+  IndexIterator(ReadPageGuard guard, int index, BufferPoolManager *buff_pool_manager);
+  IndexIterator(IndexIterator &&that) noexcept = default;
+  ~IndexIterator() = default;
 
   bool isEnd();
 
@@ -39,8 +40,13 @@ class IndexIterator {
   bool operator!=(const IndexIterator &itr) const;
 
  private:
+  // start reading the leaves to the right of the current one, beginning with page_id
+  void PrefetchLeaves(page_id_t page_id);
+
   // add your own private member variables here
-  BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *leaf_;
+  // holds the pin and read latch on leaf_, released when the iterator moves on or goes away
+  ReadPageGuard guard_;
+  const BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *leaf_;
   int index_;
   BufferPoolManager *buff_pool_manager_;
 };
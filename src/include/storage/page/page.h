@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <iostream>
 
@@ -24,14 +26,18 @@ namespace bustub {
  * Page is the basic unit of storage within the database system. Page provides a wrapper for actual data pages being
  * held in main memory. Page also contains book-keeping information that is used by the buffer pool manager, e.g.
  * pin count, dirty flag, page id, etc.
+ *
+ * The data itself lives in the buffer pool's frame arena, or in a read-only mapping of the data file; a Page only
+ * points at it, so that the book-keeping of all frames stays packed together.
  */
 class Page {
   // There is book-keeping information inside the page that should only be relevant to the buffer pool manager.
-  friend class BufferPoolManager;
+  friend class BufferPoolManagerInstance;
+  friend class MmapBufferPoolManager;
 
  public:
-  /** Constructor. Zeros out the page data. */
-  Page() { ResetMemory(); }
+  /** Constructor. The buffer pool manager points the page at its data. */
+  Page() = default;
 
   /** Default destructor. */
   ~Page() = default;
@@ -39,11 +45,14 @@ class Page {
   /** @return the actual data contained within this page */
   inline char *GetData() { return data_; }
 
+  /** @return the actual data contained within this page, for reading */
+  inline const char *GetData() const { return data_; }
+
   /** @return the page id of this page */
   inline page_id_t GetPageId() { return page_id_; }
 
   /** @return the pin count of this page */
-  inline int GetPinCount() { return pin_count_; }
+  inline int GetPinCount() { return std::max(0, pin_count_.load()); }
 
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
   inline bool IsDirty() { return is_dirty_; }
@@ -60,6 +69,19 @@ class Page {
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /**
+   * Start reading the page without latching it; see ReaderWriterLatch::TryOptimisticRead. The page must be pinned.
+   * @param[out] version the version to validate the read against
+   * @return false if the page is write-latched
+   */
+  inline bool TryOptimisticRead(uint64_t *version) const { return rwlatch_.TryOptimisticRead(version); }
+
+  /**
+   * @param version the version TryOptimisticRead returned
+   * @return true if the page has not been write-latched since the version was taken
+   */
+  inline bool ValidateRead(uint64_t version) const { return rwlatch_.Validate(version); }
+
   /** @return the page LSN. */
   inline lsn_t GetLSN() { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
@@ -78,14 +100,17 @@ class Page {
   /** Zeroes out the data that is held within the page. */
   inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }
 
-  /** The actual data that is stored within a page. */
-  char data_[PAGE_SIZE]{};
-  /** The ID of this page. */
-  page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
+  /** The actual data that is stored within a page, PAGE_SIZE bytes in the frame arena. */
+  char *data_ = nullptr;
+  /** The ID of this page. Read without the buffer pool latch by lookups that bypass it. */
+  std::atomic<page_id_t> page_id_{INVALID_PAGE_ID};
+  /**
+   * The pin count of this page. -1 while the frame is free or being handed to another page; such a frame cannot be
+   * pinned. Lookups that bypass the buffer pool latch pin with a compare-and-swap.
+   */
+  std::atomic<int> pin_count_{0};
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_{false};
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
 };
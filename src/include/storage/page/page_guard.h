@@ -0,0 +1,255 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_guard.h
+//
+// Identification: src/include/storage/page/page_guard.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "storage/page/page.h"
+
+namespace bustub {
+
+class BufferPoolManager;
+class ReadPageGuard;
+class WritePageGuard;
+
+/**
+ * BasicPageGuard owns one pin on a page and unpins it when it goes out of scope, when it is dropped or when another
+ * guard is moved into it. It does not latch the page; ReadPageGuard and WritePageGuard do.
+ *
+ * The guard remembers whether the page was handed out for writing (GetDataMut, AsMut, AsPageMut) and tells UnpinPage
+ * so. A default-constructed guard, or one for a page the buffer pool could not fetch, guards nothing.
+ */
+class BasicPageGuard {
+ public:
+  BasicPageGuard() = default;
+
+  /**
+   * Take over a pin on a page.
+   * @param bpm the buffer pool the page was fetched from
+   * @param page the pinned page, or nullptr
+   */
+  BasicPageGuard(BufferPoolManager *bpm, Page *page) : bpm_(bpm), page_(page) {}
+
+  BasicPageGuard(const BasicPageGuard &) = delete;
+  BasicPageGuard &operator=(const BasicPageGuard &) = delete;
+
+  /** Take over the pin of another guard, which guards nothing afterwards. */
+  BasicPageGuard(BasicPageGuard &&that) noexcept;
+
+  /** Unpin the page this guard holds and take over the pin of another guard, which guards nothing afterwards. */
+  BasicPageGuard &operator=(BasicPageGuard &&that) noexcept;
+
+  ~BasicPageGuard();
+
+  /** Unpin the page now rather than at the end of the scope. The guard guards nothing afterwards. */
+  void Drop();
+
+  /**
+   * Read-latch the page and hand the pin over to a ReadPageGuard. This guard guards nothing afterwards.
+   * @return a guard holding the pin and the read latch
+   */
+  ReadPageGuard UpgradeRead();
+
+  /**
+   * Write-latch the page and hand the pin over to a WritePageGuard. This guard guards nothing afterwards.
+   * @return a guard holding the pin and the write latch
+   */
+  WritePageGuard UpgradeWrite();
+
+  /**
+   * Start reading the page without latching it. Everything read must be checked with Validate before it is used.
+   * @param[out] version the version to validate against
+   * @return false if the page is write-latched
+   */
+  bool TryOptimisticRead(uint64_t *version) const { return page_->TryOptimisticRead(version); }
+
+  /**
+   * @param version the version TryOptimisticRead returned
+   * @return true if the page has not been write-latched since the version was taken
+   */
+  bool Validate(uint64_t version) const { return page_->ValidateRead(version); }
+
+  /** @return true if the guard holds a page */
+  bool IsValid() const { return page_ != nullptr; }
+
+  /** @return the id of the guarded page */
+  page_id_t PageId() const { return page_->GetPageId(); }
+
+  /** @return the data of the guarded page, for reading */
+  const char *GetData() const { return page_->GetData(); }
+
+  /** @return the data of the guarded page viewed as T, e.g. a B+ tree page, for reading */
+  template <class T>
+  const T *As() const {
+    return reinterpret_cast<const T *>(GetData());
+  }
+
+  /** @return the data of the guarded page, for writing; the page is unpinned dirty */
+  char *GetDataMut() {
+    is_dirty_ = true;
+    return page_->GetData();
+  }
+
+  /** @return the data of the guarded page viewed as T, for writing; the page is unpinned dirty */
+  template <class T>
+  T *AsMut() {
+    return reinterpret_cast<T *>(GetDataMut());
+  }
+
+  /** @return the guarded page viewed as T, a subclass of Page such as TablePage, for reading */
+  template <class T>
+  const T *AsPage() const {
+    return static_cast<const T *>(page_);
+  }
+
+  /** @return the guarded page viewed as T, a subclass of Page such as TablePage, for writing */
+  template <class T>
+  T *AsPageMut() {
+    is_dirty_ = true;
+    return static_cast<T *>(page_);
+  }
+
+ private:
+  friend class ReadPageGuard;
+  friend class WritePageGuard;
+
+  BufferPoolManager *bpm_{nullptr};
+  Page *page_{nullptr};
+  bool is_dirty_{false};
+};
+
+/**
+ * ReadPageGuard owns one pin and the read latch on a page, and releases both, latch first, when it goes out of scope
+ * or is dropped. Assigning a new guard to it releases the old page only after the new one is latched, which is what
+ * latch crabbing down a tree needs.
+ */
+class ReadPageGuard {
+ public:
+  ReadPageGuard() = default;
+
+  /**
+   * Take over a pin and a read latch on a page.
+   * @param bpm the buffer pool the page was fetched from
+   * @param page the pinned and read-latched page, or nullptr
+   */
+  ReadPageGuard(BufferPoolManager *bpm, Page *page) : guard_(bpm, page) {}
+
+  ReadPageGuard(const ReadPageGuard &) = delete;
+  ReadPageGuard &operator=(const ReadPageGuard &) = delete;
+  ReadPageGuard(ReadPageGuard &&that) noexcept = default;
+  ReadPageGuard &operator=(ReadPageGuard &&that) noexcept;
+  ~ReadPageGuard();
+
+  /** Unlatch and unpin the page now rather than at the end of the scope. The guard guards nothing afterwards. */
+  void Drop();
+
+  /**
+   * Check that the page was not written between an optimistic read and the read latch this guard took, e.g. after
+   * BasicPageGuard::UpgradeRead.
+   * @param version the version BasicPageGuard::TryOptimisticRead returned
+   * @return true if the page has not been write-latched since the version was taken
+   */
+  bool Validate(uint64_t version) const { return guard_.Validate(version); }
+
+  /** @return true if the guard holds a page */
+  bool IsValid() const { return guard_.IsValid(); }
+
+  /** @return the id of the guarded page */
+  page_id_t PageId() const { return guard_.PageId(); }
+
+  /** @return the data of the guarded page */
+  const char *GetData() const { return guard_.GetData(); }
+
+  /** @return the data of the guarded page viewed as T, e.g. a B+ tree page */
+  template <class T>
+  const T *As() const {
+    return guard_.As<T>();
+  }
+
+  /** @return the guarded page viewed as T, a subclass of Page such as TablePage */
+  template <class T>
+  const T *AsPage() const {
+    return guard_.AsPage<T>();
+  }
+
+ private:
+  friend class BasicPageGuard;
+
+  BasicPageGuard guard_;
+};
+
+/**
+ * WritePageGuard owns one pin and the write latch on a page, and releases both, latch first, when it goes out of
+ * scope or is dropped.
+ */
+class WritePageGuard {
+ public:
+  WritePageGuard() = default;
+
+  /**
+   * Take over a pin and a write latch on a page.
+   * @param bpm the buffer pool the page was fetched from
+   * @param page the pinned and write-latched page, or nullptr
+   */
+  WritePageGuard(BufferPoolManager *bpm, Page *page) : guard_(bpm, page) {}
+
+  WritePageGuard(const WritePageGuard &) = delete;
+  WritePageGuard &operator=(const WritePageGuard &) = delete;
+  WritePageGuard(WritePageGuard &&that) noexcept = default;
+  WritePageGuard &operator=(WritePageGuard &&that) noexcept;
+  ~WritePageGuard();
+
+  /** Unlatch and unpin the page now rather than at the end of the scope. The guard guards nothing afterwards. */
+  void Drop();
+
+  /** @return true if the guard holds a page */
+  bool IsValid() const { return guard_.IsValid(); }
+
+  /** @return the id of the guarded page */
+  page_id_t PageId() const { return guard_.PageId(); }
+
+  /** @return the data of the guarded page, for reading */
+  const char *GetData() const { return guard_.GetData(); }
+
+  /** @return the data of the guarded page viewed as T, for reading */
+  template <class T>
+  const T *As() const {
+    return guard_.As<T>();
+  }
+
+  /** @return the data of the guarded page, for writing; the page is unpinned dirty */
+  char *GetDataMut() { return guard_.GetDataMut(); }
+
+  /** @return the data of the guarded page viewed as T, for writing; the page is unpinned dirty */
+  template <class T>
+  T *AsMut() {
+    return guard_.AsMut<T>();
+  }
+
+  /** @return the guarded page viewed as T, a subclass of Page such as TablePage, for reading */
+  template <class T>
+  const T *AsPage() const {
+    return guard_.AsPage<T>();
+  }
+
+  /** @return the guarded page viewed as T, a subclass of Page such as TablePage, for writing */
+  template <class T>
+  T *AsPageMut() {
+    return guard_.AsPageMut<T>();
+  }
+
+ private:
+  friend class BasicPageGuard;
+
+  BasicPageGuard guard_;
+};
+
+}  // namespace bustub
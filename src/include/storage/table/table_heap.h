@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
 #include "recovery/log_manager.h"
 #include "storage/page/table_page.h"
@@ -46,9 +48,10 @@ class TableHeap {
    * @param lock_manager the lock manager
    * @param log_manager the log manager
    * @param txn the creating transaction
+   * @param tablespace the tablespace to keep the pages of the table heap in
    */
   TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
-            Transaction *txn);
+            Transaction *txn, tablespace_id_t tablespace = DEFAULT_TABLESPACE);
 
   /**
    * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
@@ -99,6 +102,16 @@ class TableHeap {
    */
   bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn);
 
+  /**
+   * Read several tuples, e.g. the RIDs an index scan returned. Their pages are fetched in a few batches, in page id
+   * order, and each page is latched once for all of its tuples.
+   * @param rids the rids of the tuples to read, in any order
+   * @param[out] tuples the tuples, one per rid; a tuple that does not exist is left unallocated
+   * @param txn transaction performing the read
+   * @return false if some page could not be fetched, in which case the transaction is aborted
+   */
+  bool GetTuples(const std::vector<RID> &rids, std::vector<Tuple> *tuples, Transaction *txn);
+
   /** @return the begin iterator of this table */
   TableIterator Begin(Transaction *txn);
 
@@ -108,6 +121,9 @@ class TableHeap {
   /** @return the id of the first page of this table */
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+  /** @return the tablespace the pages of the table heap are in */
+  inline tablespace_id_t GetTablespaceId() const { return GetTablespace(first_page_id_); }
+
  private:
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
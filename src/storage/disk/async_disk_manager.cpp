@@ -0,0 +1,439 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_disk_manager.cpp
+//
+// Identification: src/storage/disk/async_disk_manager.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/async_disk_manager.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+AsyncDiskManager::AsyncDiskManager(DiskManager *disk_manager, size_t queue_depth, bool use_io_uring)
+    : disk_manager_(disk_manager), queue_depth_(std::max<size_t>(queue_depth, 1)) {
+  // compressed pages are not at fixed offsets the kernel could be handed, so only the disk manager can transfer them
+  if (use_io_uring && !disk_manager_->UsesCompression() && SetUpRing()) {
+    completion_thread_ = std::thread(&AsyncDiskManager::ReapCompletions, this);
+    return;
+  }
+  for (int i = 0; i < ASYNC_IO_THREADS; ++i) {
+    workers_.emplace_back(&AsyncDiskManager::RunWorker, this);
+  }
+}
+
+AsyncDiskManager::~AsyncDiskManager() {
+  if (UsesIoUring()) {
+    std::unique_lock submit_lk{submit_latch_};
+    submit_cv_.wait(submit_lk, [&] { return in_flight_ == 0; });
+    std::vector<uint64_t> taken_back;
+    EnterRing(PrepareEntries(nullptr), &taken_back);
+    submit_lk.unlock();
+    completion_thread_.join();
+    TearDownRing();
+    return;
+  }
+  {
+    std::scoped_lock queue_lk{queue_latch_};
+    stopped_ = true;
+  }
+  queue_cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+std::future<void> AsyncDiskManager::ReadPageAsync(page_id_t page_id, char *page_data) {
+  return Submit({page_id}, {page_data}, false);
+}
+
+std::future<void> AsyncDiskManager::WritePageAsync(page_id_t page_id, const char *page_data) {
+  return Submit({page_id}, {const_cast<char *>(page_data)}, true);
+}
+
+std::future<void> AsyncDiskManager::ReadPagesAsync(const std::vector<page_id_t> &page_ids,
+                                                   const std::vector<char *> &page_data) {
+  return Submit(page_ids, page_data, false);
+}
+
+std::future<void> AsyncDiskManager::WritePagesAsync(const std::vector<page_id_t> &page_ids,
+                                                    const std::vector<const char *> &page_data) {
+  std::vector<char *> data;
+  data.reserve(page_data.size());
+  for (const char *page : page_data) {
+    data.push_back(const_cast<char *>(page));
+  }
+  return Submit(page_ids, data, true);
+}
+
+bool AsyncDiskManager::SetUpRing() {
+  io_uring_params params{};
+  int fd = static_cast<int>(syscall(__NR_io_uring_setup, queue_depth_ * ENTRIES_PER_REQUEST, &params));
+  if (fd < 0) {
+    LOG_DEBUG("io_uring is not available, falling back to a thread pool");
+    return false;
+  }
+  // Checksums are linked behind their pages, which older kernels do not support; stable submissions came later.
+  if ((params.features & IORING_FEAT_SUBMIT_STABLE) == 0) {
+    LOG_DEBUG("io_uring is too old, falling back to a thread pool");
+    close(fd);
+    return false;
+  }
+
+  // The submission and completion rings may share one mapping; the submission queue entries always get their own.
+  size_t sq_map_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  size_t cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  bool single_map = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_map) {
+    sq_map_size = cq_map_size = std::max(sq_map_size, cq_map_size);
+  }
+  void *sq_map = mmap(nullptr, sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  if (sq_map == MAP_FAILED) {
+    close(fd);
+    return false;
+  }
+  void *cq_map = sq_map;
+  if (!single_map) {
+    cq_map = mmap(nullptr, cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    if (cq_map == MAP_FAILED) {
+      munmap(sq_map, sq_map_size);
+      close(fd);
+      return false;
+    }
+  }
+  size_t sqes_map_size = params.sq_entries * sizeof(io_uring_sqe);
+  void *sqes = mmap(nullptr, sqes_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    if (!single_map) {
+      munmap(cq_map, cq_map_size);
+    }
+    munmap(sq_map, sq_map_size);
+    close(fd);
+    return false;
+  }
+
+  auto *sq = static_cast<char *>(sq_map);
+  auto *cq = static_cast<char *>(cq_map);
+  ring_.sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+  ring_.sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  ring_.sq_mask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  ring_.cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  ring_.cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  ring_.cq_mask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  ring_.sqes_ = static_cast<io_uring_sqe *>(sqes);
+  ring_.cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+  ring_.sq_map_ = sq_map;
+  ring_.sq_map_size_ = sq_map_size;
+  ring_.cq_map_ = single_map ? nullptr : cq_map;
+  ring_.cq_map_size_ = cq_map_size;
+  ring_.sqes_map_size_ = sqes_map_size;
+  // Slot i of the submission queue always holds entry i, so the indirection array never changes.
+  auto *array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  for (unsigned i = 0; i < params.sq_entries; ++i) {
+    array[i] = i;
+  }
+  // At most queue depth requests are queued between two system calls; the kernel may have rounded the size up.
+  queue_depth_ = std::min<size_t>(queue_depth_, params.sq_entries / ENTRIES_PER_REQUEST);
+  ring_fd_ = fd;
+  return true;
+}
+
+void AsyncDiskManager::TearDownRing() {
+  munmap(ring_.sqes_, ring_.sqes_map_size_);
+  if (ring_.cq_map_ != nullptr) {
+    munmap(ring_.cq_map_, ring_.cq_map_size_);
+  }
+  munmap(ring_.sq_map_, ring_.sq_map_size_);
+  close(ring_fd_);
+  ring_fd_ = -1;
+}
+
+std::future<void> AsyncDiskManager::Submit(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data,
+                                           bool is_write) {
+  if (is_write && disk_manager_->UsesDoubleWrite()) {
+    // Writes must go through the double-write file first, which only the disk manager knows how to do.
+    std::promise<void> written;
+    disk_manager_->WritePages(page_ids, std::vector<const char *>(page_data.begin(), page_data.end()));
+    written.set_value();
+    return written.get_future();
+  }
+  auto *batch = new Batch;
+  std::future<void> done = batch->done_.get_future();
+  if (page_ids.empty()) {
+    batch->done_.set_value();
+    delete batch;
+    return done;
+  }
+  batch->remaining_ = page_ids.size();
+  batch->num_requests_ = page_ids.size();
+  batch->requests_ = std::make_unique<Request[]>(page_ids.size());
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    Request &request = batch->requests_[i];
+    request.batch_ = batch;
+    request.page_id_ = page_ids[i];
+    request.data_ = page_data[i];
+    request.is_write_ = is_write;
+    request.iov_ = {page_data[i], PAGE_SIZE};
+    request.checksum_iov_ = {&request.checksum_, sizeof(request.checksum_)};
+  }
+
+  // The batch may be gone as soon as its last request is handed over.
+  if (UsesIoUring()) {
+    SubmitToRing(batch);
+    return done;
+  }
+  {
+    std::scoped_lock queue_lk{queue_latch_};
+    for (size_t i = 0; i < batch->num_requests_; ++i) {
+      queue_.push_back(&batch->requests_[i]);
+    }
+  }
+  queue_cv_.notify_all();
+  return done;
+}
+
+unsigned AsyncDiskManager::PrepareEntries(Request *request) {
+  unsigned tail = *ring_.sq_tail_;
+  io_uring_sqe *sqe = &ring_.sqes_[tail & ring_.sq_mask_];
+  memset(sqe, 0, sizeof(*sqe));
+  if (request == nullptr) {
+    sqe->opcode = IORING_OP_NOP;
+    sqe->user_data = 0;
+    // Publish the entry before the tail that makes it visible to the kernel.
+    __atomic_store_n(ring_.sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    return 1;
+  }
+
+  // a page of a tablespace that does not exist fails with EBADF, like any other I/O error
+  request->file_ = disk_manager_->FindFile(request->page_id_);
+  int fd = request->file_ == nullptr ? -1 : request->file_->fd_;
+  page_id_t page_no = GetPageNumber(request->page_id_);
+  int opcode = request->is_write_ ? IORING_OP_WRITEV : IORING_OP_READV;
+  request->entries_left_ = ENTRIES_PER_REQUEST;
+  sqe->opcode = opcode;
+  sqe->fd = fd;
+  sqe->off = DiskManager::PageOffset(page_no);
+  sqe->addr = reinterpret_cast<uint64_t>(&request->iov_);
+  sqe->len = 1;
+  sqe->user_data = reinterpret_cast<uint64_t>(request);
+  if (request->is_write_) {
+    // As in DiskManager::WritePage, the checksum follows the data: the link keeps the kernel from starting it before
+    // the page has been written, and cancels it if the page's write fails.
+    sqe->flags = IOSQE_IO_LINK;
+    request->checksum_ = DiskManager::PageChecksum(request->data_);
+    // finished in CompleteRequest
+    disk_manager_->writes_started_ += 1;
+  } else {
+    // a checksum beyond the end of the file reads as 0, which matches any page
+    request->checksum_ = 0;
+  }
+
+  io_uring_sqe *checksum_sqe = &ring_.sqes_[(tail + 1) & ring_.sq_mask_];
+  memset(checksum_sqe, 0, sizeof(*checksum_sqe));
+  checksum_sqe->opcode = opcode;
+  checksum_sqe->fd = fd;
+  checksum_sqe->off = DiskManager::ChecksumOffset(page_no);
+  checksum_sqe->addr = reinterpret_cast<uint64_t>(&request->checksum_iov_);
+  checksum_sqe->len = 1;
+  checksum_sqe->user_data = reinterpret_cast<uint64_t>(request) | CHECKSUM_ENTRY;
+  __atomic_store_n(ring_.sq_tail_, tail + ENTRIES_PER_REQUEST, __ATOMIC_RELEASE);
+  return ENTRIES_PER_REQUEST;
+}
+
+void AsyncDiskManager::SubmitToRing(Batch *batch) {
+  size_t max_in_flight = queue_depth_ * ENTRIES_PER_REQUEST;
+  std::unique_lock submit_lk{submit_latch_};
+  unsigned to_submit = 0;
+  std::vector<uint64_t> taken_back;
+  for (size_t i = 0; i < batch->num_requests_; ++i) {
+    if (in_flight_ + ENTRIES_PER_REQUEST > max_in_flight) {
+      // Hand over what we have, then wait for completions to make room.
+      EnterRing(to_submit, &taken_back);
+      to_submit = 0;
+      submit_cv_.wait(submit_lk, [&] { return in_flight_ + ENTRIES_PER_REQUEST <= max_in_flight; });
+    }
+    unsigned prepared = PrepareEntries(&batch->requests_[i]);
+    in_flight_ += prepared;
+    to_submit += prepared;
+  }
+  EnterRing(to_submit, &taken_back);
+  submit_lk.unlock();
+
+  // The kernel would not take these. Completing them as cancelled performs their requests here instead, once the
+  // kernel is done with any other entry of theirs, without holding up other submitters.
+  for (uint64_t user_data : taken_back) {
+    CompleteEntry(user_data, -ECANCELED);
+  }
+}
+
+void AsyncDiskManager::EnterRing(unsigned to_submit, std::vector<uint64_t> *taken_back) {
+  while (to_submit > 0) {
+    int submitted = static_cast<int>(syscall(__NR_io_uring_enter, ring_fd_, to_submit, 0, 0, nullptr, 0));
+    if (submitted >= 0) {
+      to_submit -= submitted;
+      continue;
+    }
+    if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+      continue;
+    }
+    // The kernel took none of the remaining entries. Take them back for the caller to perform.
+    LOG_DEBUG("io_uring_enter failed");
+    unsigned tail = *ring_.sq_tail_;
+    for (unsigned i = tail - to_submit; i != tail; ++i) {
+      uint64_t user_data = ring_.sqes_[i & ring_.sq_mask_].user_data;
+      if (user_data != 0) {
+        in_flight_--;
+        taken_back->push_back(user_data);
+      }
+    }
+    __atomic_store_n(ring_.sq_tail_, tail - to_submit, __ATOMIC_RELEASE);
+    return;
+  }
+}
+
+void AsyncDiskManager::ReapCompletions() {
+  while (true) {
+    // Only this thread moves the head of the completion queue; the kernel moves its tail.
+    unsigned head = *ring_.cq_head_;
+    if (head == __atomic_load_n(ring_.cq_tail_, __ATOMIC_ACQUIRE)) {
+      syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+      continue;
+    }
+    io_uring_cqe *cqe = &ring_.cqes_[head & ring_.cq_mask_];
+    uint64_t user_data = cqe->user_data;
+    int result = cqe->res;
+    __atomic_store_n(ring_.cq_head_, head + 1, __ATOMIC_RELEASE);
+    if (user_data == 0) {
+      return;
+    }
+    {
+      std::scoped_lock submit_lk{submit_latch_};
+      in_flight_--;
+    }
+    submit_cv_.notify_all();
+    CompleteEntry(user_data, result);
+  }
+}
+
+void AsyncDiskManager::CompleteEntry(uint64_t user_data, int result) {
+  auto *request = reinterpret_cast<Request *>(user_data & ~CHECKSUM_ENTRY);
+  if ((user_data & CHECKSUM_ENTRY) != 0) {
+    request->checksum_result_ = result;
+  } else {
+    request->result_ = result;
+  }
+  if (request->entries_left_.fetch_sub(1) == 1) {
+    CompleteRequest(request);
+  }
+}
+
+void AsyncDiskManager::CompleteRequest(Request *request) {
+  // A write only finishes once its page is whole again, after a retry has rewritten it; the request may be gone by
+  // then.
+  bool is_write = request->is_write_;
+  int result = request->result_;
+  // A write's checksum must have been written in full. A read's may lie beyond the end of the file, and then reads
+  // nothing and stays 0.
+  int checksum_result = request->checksum_result_;
+  bool checksum_done = checksum_result == sizeof(uint32_t) || (!is_write && checksum_result == 0);
+  // A short read may stop anywhere, not just at the end of the file, so it is done again synchronously too: ReadPage
+  // reads on to the end of the file and only pads the page with zeros from there. So is a request whose entries the
+  // kernel did not take, or whose checksum did not make it.
+  if (result == -EINTR || result == -EAGAIN || result == -ECANCELED || (result >= 0 && result < PAGE_SIZE) ||
+      (result >= 0 && !checksum_done)) {
+    // Rare enough that simply doing the whole page again synchronously is fine.
+    PerformRequest(request);
+    if (is_write) {
+      disk_manager_->writes_finished_ += 1;
+    }
+    return;
+  }
+  if (result < 0) {
+    LOG_DEBUG("I/O error in async request for page %d: %s", request->page_id_, strerror(-result));
+    if (is_write) {
+      disk_manager_->writes_finished_ += 1;
+    }
+    FinishRequest(request, true, false);
+    return;
+  }
+  if (is_write) {
+    disk_manager_->num_writes_ += 1;
+    disk_manager_->writes_finished_ += 1;
+    FinishRequest(request, false, false);
+    return;
+  }
+  disk_manager_->num_reads_ += 1;
+  uint32_t checksum = request->checksum_;
+  FinishRequest(request, false, checksum != 0 && checksum != DiskManager::PageChecksum(request->data_));
+}
+
+void AsyncDiskManager::RunWorker() {
+  while (true) {
+    Request *request;
+    {
+      std::unique_lock queue_lk{queue_latch_};
+      queue_cv_.wait(queue_lk, [&] { return stopped_ || !queue_.empty(); });
+      // Everything queued before the stop is still performed.
+      if (queue_.empty()) {
+        return;
+      }
+      request = queue_.front();
+      queue_.pop_front();
+    }
+    PerformRequest(request);
+  }
+}
+
+void AsyncDiskManager::PerformRequest(Request *request) {
+  try {
+    if (request->is_write_) {
+      disk_manager_->WritePage(request->page_id_, request->data_);
+    } else {
+      disk_manager_->ReadPage(request->page_id_, request->data_);
+    }
+  } catch (const Exception &e) {
+    // a failed pread or pwrite, like a page of a tablespace that does not exist, is an I/O error rather than corruption
+    bool corrupt = e.GetType() == ExceptionType::CORRUPTION;
+    FinishRequest(request, !corrupt, corrupt);
+    return;
+  }
+  FinishRequest(request, false, false);
+}
+
+void AsyncDiskManager::FinishRequest(Request *request, bool failed, bool corrupt) {
+  Batch *batch = request->batch_;
+  if (failed) {
+    batch->failed_ = true;
+  }
+  if (corrupt) {
+    batch->corrupt_ = true;
+  }
+  if (batch->remaining_.fetch_sub(1) != 1) {
+    return;
+  }
+  if (batch->corrupt_) {
+    batch->done_.set_exception(std::make_exception_ptr(
+        Exception(ExceptionType::CORRUPTION, "a page read by an async disk request does not match its checksum")));
+  } else if (batch->failed_) {
+    batch->done_.set_exception(std::make_exception_ptr(Exception(ExceptionType::IO, "I/O error in async disk request")));
+  } else {
+    batch->done_.set_value();
+  }
+  delete batch;
+}
+
+}  // namespace bustub
@@ -10,33 +10,132 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <unistd.h>
 #include <cassert>
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
 #include <cstring>
+#include <fstream>
 #include <iostream>
 #include <string>
 #include <thread>  // NOLINT
+#include <vector>
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/macros.h"
+#include "common/util/crc32c.h"
+#include "common/util/lz_codec.h"
 #include "storage/disk/disk_manager.h"
 
 namespace bustub {
 
 static char *buffer_used;
 
+/** Marks the header page of a double-write file. */
+static constexpr uint32_t DOUBLE_WRITE_MAGIC = 0x44574231;
+
+/** Header page of a double-write file. The checksum covers the rest of the page, from num_pages_ on. */
+struct DoubleWriteHeader {
+  uint32_t magic_;
+  uint32_t checksum_;
+  uint32_t num_pages_;
+  /** Id and checksum of each journaled page, in the order the pages follow the header. */
+  struct {
+    page_id_t page_id_;
+    uint32_t checksum_;
+  } entries_[DOUBLE_WRITE_PAGES];
+};
+static_assert(sizeof(DoubleWriteHeader) <= PAGE_SIZE, "the double-write header must fit in a page");
+
+/** @return the checksum of a double-write header page */
+static uint32_t HeaderChecksum(const char *header_page) {
+  size_t offset = offsetof(DoubleWriteHeader, num_pages_);
+  return Crc32c::Compute(header_page + offset, PAGE_SIZE - offset);
+}
+
+/**
+ * Read up to size bytes at offset, retrying interrupted and partial reads.
+ * @return the number of bytes read, which is short only at the end of the file, or -1 on error
+ */
+static ssize_t PreadFully(int fd, char *buf, size_t size, off_t offset) {
+  size_t done = 0;
+  while (done < size) {
+    ssize_t n = pread(fd, buf + done, size - done, offset + static_cast<off_t>(done));
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return -1;
+    }
+    if (n == 0) {
+      break;
+    }
+    done += n;
+  }
+  return static_cast<ssize_t>(done);
+}
+
+/**
+ * Write size bytes at offset, retrying interrupted and partial writes.
+ * @return false on error
+ */
+static bool PwriteFully(int fd, const char *buf, size_t size, off_t offset) {
+  size_t done = 0;
+  while (done < size) {
+    ssize_t n = pwrite(fd, buf + done, size - done, offset + static_cast<off_t>(done));
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    done += n;
+  }
+  return true;
+}
+
+/** @return the number of COMPRESSED_SLOT_SIZE units an image of length bytes takes */
+static uint32_t SlotUnits(uint32_t length) { return (length + COMPRESSED_SLOT_SIZE - 1) / COMPRESSED_SLOT_SIZE; }
+
+/** @return the offset of a slot in the slot file */
+static off_t SlotOffset(uint32_t unit) { return static_cast<off_t>(unit) * COMPRESSED_SLOT_SIZE; }
+
+/** @return the bytes of disk space a file takes up, 0 for no file */
+static int64_t DiskUsage(int fd) {
+  struct stat stat_buf;
+  return fd >= 0 && fstat(fd, &stat_buf) == 0 ? static_cast<int64_t>(stat_buf.st_blocks) * 512 : 0;
+}
+
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
+ * @input double_write: whether to journal page writes to a double-write file
+ * @input compress: whether to store pages compressed
+ * @input extent_pages: number of pages in an extent
  */
-DiskManager::DiskManager(const std::string &db_file)
-    : file_name_(db_file), next_page_id_(0), num_flushes_(0), num_writes_(0), flush_log_(false), flush_log_f_(nullptr) {
+DiskManager::DiskManager(const std::string &db_file, bool double_write, bool compress, uint32_t extent_pages)
+    : file_name_(db_file),
+      num_flushes_(0),
+      num_writes_(0),
+      num_reads_(0),
+      flush_log_(false),
+      flush_log_f_(nullptr),
+      extent_pages_(extent_pages) {
+  BUSTUB_ASSERT(extent_pages_ > 0 && (extent_pages_ & (extent_pages_ - 1)) == 0 &&
+                    extent_pages_ <= static_cast<uint32_t>(FREE_SPACE_MAP_INTERVAL),
+                "extent size must be a power of two no larger than a free-space map interval");
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
     return;
   }
   log_name_ = file_name_.substr(0, n) + ".log";
+  dwb_name_ = file_name_.substr(0, n) + ".dwb";
+  tablespace_file_name_ = file_name_.substr(0, n) + ".tablespaces";
 
   log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
   // directory or file does not exist
@@ -52,27 +151,46 @@ DiskManager::DiskManager(const std::string &db_file)
     }
   }
 
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-    if (!db_io_.is_open()) {
-      throw Exception("can't open db file");
+  // a database that was created compressed stays compressed
+  compress_ = compress || GetFileSize(db_file + SLOT_FILE_SUFFIX) >= 0;
+  // creates the file if it does not exist
+  files_[DEFAULT_TABLESPACE] = OpenDataFile(db_file, O_CREAT);
+  if (files_[DEFAULT_TABLESPACE] == nullptr) {
+    throw Exception("can't open db file");
+  }
+  LoadTablespaces();
+  RecoverDoubleWriteFile();
+  if (double_write) {
+    dwb_fd_ = open(dwb_name_.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (dwb_fd_ < 0) {
+      throw Exception("can't open double-write file");
     }
   }
   buffer_used = nullptr;
 }
 
+DiskManager::~DiskManager() {
+  // the data files close themselves; without a shutdown, the double-write file is left behind as after a crash
+  if (dwb_fd_ >= 0) {
+    close(dwb_fd_);
+  }
+}
+
 /**
  * Close all file streams
  */
 void DiskManager::ShutDown() {
-  db_io_.close();
+  for (auto &file : files_) {
+    if (file != nullptr) {
+      CloseDataFile(file.get());
+    }
+  }
+  // every journaled page has been written in place and synced, so there is nothing left to recover
+  if (dwb_fd_ >= 0) {
+    close(dwb_fd_);
+    dwb_fd_ = -1;
+    unlink(dwb_name_.c_str());
+  }
   log_io_.close();
 }
 
@@ -80,48 +198,148 @@ void DiskManager::ShutDown() {
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
-  // set write cursor to offset
-  num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
-    LOG_DEBUG("I/O error while writing");
+  if (dwb_fd_ >= 0) {
+    DoubleWritePages(&page_id, &page_data, 1);
     return;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  WritePageInPlace(page_id, page_data);
+}
+
+/**
+ * Write the contents of several pages into disk file, journaling them together
+ */
+void DiskManager::WritePages(const std::vector<page_id_t> &page_ids, const std::vector<const char *> &page_data) {
+  for (size_t i = 0; i < page_ids.size(); i += DOUBLE_WRITE_PAGES) {
+    size_t num_pages = std::min<size_t>(DOUBLE_WRITE_PAGES, page_ids.size() - i);
+    if (dwb_fd_ >= 0) {
+      DoubleWritePages(&page_ids[i], &page_data[i], num_pages);
+      continue;
+    }
+    for (size_t j = i; j < i + num_pages; ++j) {
+      WritePageInPlace(page_ids[j], page_data[j]);
+    }
+  }
+}
+
+void DiskManager::WritePageInPlace(page_id_t page_id, const char *page_data) {
+  std::shared_ptr<DataFile> file = GetFile(page_id);
+  num_writes_ += 1;
+  writes_started_ += 1;
+  if (!WritePageData(file.get(), GetPageNumber(page_id), page_data)) {
+    writes_finished_ += 1;
+    throw Exception(ExceptionType::IO, "I/O error while writing page " + std::to_string(page_id));
+  }
+  // the checksum goes second, so that a write torn by a crash shows up as a mismatch
+  WriteChecksum(page_id, PageChecksum(page_data));
+  writes_finished_ += 1;
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  int offset = page_id * PAGE_SIZE;
-  // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
-    LOG_DEBUG("I/O error reading past end of file");
-    // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    if (db_io_.bad()) {
-      LOG_DEBUG("I/O error while reading");
-      return;
+  std::shared_ptr<DataFile> file = GetFile(page_id);
+  num_reads_ += 1;
+  ssize_t read_count = ReadPageData(file.get(), GetPageNumber(page_id), page_data);
+  if (read_count < 0) {
+    throw Exception(ExceptionType::IO, "I/O error while reading page " + std::to_string(page_id));
+  }
+  // if file ends before reading PAGE_SIZE
+  if (read_count < PAGE_SIZE) {
+    LOG_DEBUG("Read less than a page");
+    memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+  }
+  if (!VerifyPage(page_id, page_data)) {
+    throw Exception(ExceptionType::CORRUPTION, "page " + std::to_string(page_id) + " does not match its checksum");
+  }
+}
+
+/**
+ * Read the contents of several pages into their buffers, one request per run of consecutive pages
+ */
+void DiskManager::ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data) {
+  std::vector<char> run_data;
+  std::vector<uint32_t> checksums;
+  page_id_t corrupt_page_id = INVALID_PAGE_ID;
+  size_t begin = 0;
+  while (begin < page_ids.size()) {
+    size_t end = begin + 1;
+    // A run stops in front of a free-space map page, and so at the end of a tablespace.
+    while (end < page_ids.size() && page_ids[end] == page_ids[end - 1] + 1 &&
+           page_ids[end] % FREE_SPACE_MAP_INTERVAL != 0) {
+      end++;
+    }
+    num_reads_ += static_cast<int>(end - begin);
+
+    std::shared_ptr<DataFile> file = GetFile(page_ids[begin]);
+    if (compress_) {
+      // the images of a run lie wherever their slots are, so they are read one by one
+      for (size_t i = begin; i < end; ++i) {
+        ssize_t read_count = ReadPageData(file.get(), GetPageNumber(page_ids[i]), page_data[i]);
+        if (read_count < 0) {
+          throw Exception(ExceptionType::IO, "I/O error while reading page " + std::to_string(page_ids[i]));
+        }
+        memset(page_data[i] + read_count, 0, PAGE_SIZE - read_count);
+      }
+    } else {
+      // Read the whole run at once, then hand each page its part; whatever lies beyond the end of the file is zeros.
+      off_t offset = PageOffset(GetPageNumber(page_ids[begin]));
+      size_t run_size = (end - begin) * PAGE_SIZE;
+      run_data.resize(run_size);
+      ssize_t read_count = PreadFully(file->fd_, run_data.data(), run_size, offset);
+      if (read_count < 0) {
+        throw Exception(ExceptionType::IO, "I/O error while reading page " + std::to_string(page_ids[begin]));
+      }
+      memset(run_data.data() + read_count, 0, run_size - read_count);
+      for (size_t i = begin; i < end; ++i) {
+        memcpy(page_data[i], run_data.data() + (i - begin) * PAGE_SIZE, PAGE_SIZE);
+      }
     }
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+    // The checksums of a run are adjacent too.
+    checksums.resize(end - begin);
+    ReadChecksums(page_ids[begin], end - begin, checksums.data());
+    for (size_t i = begin; i < end; ++i) {
+      uint32_t checksum = checksums[i - begin];
+      if (checksum != 0 && checksum != PageChecksum(page_data[i]) && corrupt_page_id == INVALID_PAGE_ID) {
+        corrupt_page_id = page_ids[i];
+      }
     }
+    begin = end;
+  }
+  if (corrupt_page_id != INVALID_PAGE_ID) {
+    throw Exception(ExceptionType::CORRUPTION,
+                    "page " + std::to_string(corrupt_page_id) + " does not match its checksum");
   }
 }
 
+/**
+ * Check the data read for a page against its checksum
+ */
+bool DiskManager::VerifyPage(page_id_t page_id, const char *page_data) {
+  uint32_t checksum;
+  ReadChecksums(page_id, 1, &checksum);
+  return checksum == 0 || checksum == PageChecksum(page_data);
+}
+
+/**
+ * Read a page and check it against its checksum, for scrubbing
+ */
+bool DiskManager::CheckPage(page_id_t page_id) {
+  // the scrubber runs alongside everything else; a tablespace dropped under it keeps its file open until it is done
+  std::shared_ptr<DataFile> file = FindFile(page_id);
+  if (file == nullptr) {
+    return true;
+  }
+  char page_data[PAGE_SIZE];
+  ssize_t read_count = ReadPageData(file.get(), GetPageNumber(page_id), page_data);
+  if (read_count < 0) {
+    LOG_DEBUG("I/O error while reading");
+    return true;
+  }
+  memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+  return VerifyPage(page_id, page_data);
+}
+
 /**
  * Write the contents of the log into disk file
  * Only return when sync is done, and only perform sequence write
@@ -186,16 +404,231 @@ bool DiskManager::ReadLog(char *log_data, int size, int offset) {
 
 /**
  * Allocate new page (operations like create index/table)
- * For now just keep an increasing counter
+ * Take the next free page of the extent of near_page_id, or else reuse the lowest free page id among those the caller
+ * may use
  */
-page_id_t DiskManager::AllocatePage() { return next_page_id_++; }
+page_id_t DiskManager::AllocatePage(uint32_t num_instances, uint32_t instance_index, tablespace_id_t tablespace,
+                                    page_id_t near_page_id) {
+  BUSTUB_ASSERT(instance_index < num_instances, "instance index out of range");
+  std::shared_ptr<DataFile> file = GetFile(MakePageId(tablespace, 0));
+  std::scoped_lock free_space_lk{file->free_space_latch_};
+  // the tablespace bits count towards the residue too, so skip ahead to the first page number that makes up for them
+  auto base = static_cast<uint32_t>(MakePageId(tablespace, 0)) % num_instances;
+  auto own_page_no = [&](page_id_t page_no) {
+    auto residue = (base + static_cast<uint32_t>(page_no)) % num_instances;
+    return page_no + static_cast<page_id_t>((instance_index + num_instances - residue) % num_instances);
+  };
+  page_id_t page_no;
+  auto extent_pages = static_cast<page_id_t>(extent_pages_);
+  if (near_page_id != INVALID_PAGE_ID && GetTablespace(near_page_id) == tablespace && extent_pages_ >= num_instances) {
+    // go on after the near page if it is the last one handed out in its reserved extent, or else reserve a fresh one
+    page_id_t near_page_no = GetPageNumber(near_page_id);
+    auto open_extent = file->open_extents_.find(near_page_no / extent_pages);
+    page_no = INVALID_PAGE_ID;
+    if (open_extent != file->open_extents_.end() && open_extent->second == near_page_no) {
+      page_id_t extent_end = (open_extent->first + 1) * extent_pages;
+      page_no = own_page_no(near_page_no + 1);
+      while (page_no < extent_end && TestAllocated(*file, page_no)) {
+        page_no += num_instances;
+      }
+      if (page_no >= extent_end) {
+        // moving on leaves whatever is free in the extent to everybody else
+        CloseExtent(file.get(), tablespace, open_extent->first);
+        page_no = INVALID_PAGE_ID;
+      }
+    }
+    if (page_no == INVALID_PAGE_ID) {
+      page_id_t extent = file->empty_extent_hint_;
+      while (file->open_extents_.count(extent) != 0 || ExtentHas(*file, extent, true)) {
+        extent++;
+      }
+      file->empty_extent_hint_ = extent + 1;
+      page_no = own_page_no(extent * extent_pages);
+    }
+    file->open_extents_[page_no / extent_pages] = page_no;
+  } else {
+    auto hint = file->free_page_hints_.emplace(std::make_pair(num_instances, instance_index), own_page_no(0)).first;
+    page_no = hint->second;
+    while (TestAllocated(*file, page_no) || file->open_extents_.count(page_no / extent_pages) != 0) {
+      page_no += num_instances;
+    }
+    hint->second = page_no + num_instances;
+  }
+  if (page_no >= (1 << TABLESPACE_SHIFT)) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "tablespace " + std::to_string(tablespace) + " is full");
+  }
+  SetAllocated(file.get(), page_no, true);
+  file->end_page_no_ = std::max(file->end_page_no_, page_no + 1);
+  // a full extent has nothing left to reserve
+  if (file->open_extents_.count(page_no / extent_pages) != 0 && !ExtentHas(*file, page_no / extent_pages, false)) {
+    CloseExtent(file.get(), tablespace, page_no / extent_pages);
+  }
+  PreallocateExtent(file.get(), page_no);
+  return MakePageId(tablespace, page_no);
+}
 
 /**
  * Deallocate page (operations like drop index/table)
- * Need bitmap in header page for tracking pages
- * This does not actually need to do anything for now.
+ * Clear its bit in the free-space map, and give the space back if it was the last page
  */
-void DiskManager::DeallocatePage(__attribute__((unused)) page_id_t page_id) {}
+void DiskManager::DeallocatePage(page_id_t page_id) {
+  std::shared_ptr<DataFile> file = page_id < 0 ? nullptr : FindFile(page_id);
+  if (file == nullptr) {
+    return;
+  }
+  page_id_t page_no = GetPageNumber(page_id);
+  std::scoped_lock free_space_lk{file->free_space_latch_};
+  if (!TestAllocated(*file, page_no)) {
+    return;
+  }
+  SetAllocated(file.get(), page_no, false);
+  // an empty extent is free for anyone again
+  page_id_t extent = page_no / static_cast<page_id_t>(extent_pages_);
+  if (!ExtentHas(*file, extent, true)) {
+    if (file->open_extents_.count(extent) != 0) {
+      CloseExtent(file.get(), GetTablespace(page_id), extent);
+    }
+    file->empty_extent_hint_ = std::min(file->empty_extent_hint_, extent);
+  }
+  for (auto &[instances, hint] : file->free_page_hints_) {
+    if (static_cast<uint32_t>(page_id) % instances.first == instances.second) {
+      hint = std::min(hint, page_no);
+    }
+  }
+  if (page_no + 1 == file->end_page_no_) {
+    while (file->end_page_no_ > 0 && !TestAllocated(*file, file->end_page_no_ - 1)) {
+      file->end_page_no_--;
+    }
+    TruncateAfterLastPage(file.get());
+  }
+}
+
+/**
+ * Returns true if the page is allocated
+ */
+bool DiskManager::IsAllocated(page_id_t page_id) {
+  std::shared_ptr<DataFile> file = page_id < 0 ? nullptr : FindFile(page_id);
+  if (file == nullptr) {
+    return false;
+  }
+  std::scoped_lock free_space_lk{file->free_space_latch_};
+  return TestAllocated(*file, GetPageNumber(page_id));
+}
+
+/**
+ * Returns the first allocated page at or after page_id, going on to the tablespaces after its own
+ */
+page_id_t DiskManager::NextAllocatedPage(page_id_t page_id) {
+  page_id = std::max(page_id, 0);
+  std::scoped_lock tablespace_lk{tablespace_latch_};
+  for (tablespace_id_t tablespace = GetTablespace(page_id); tablespace < MAX_TABLESPACES; ++tablespace) {
+    DataFile *file = files_[tablespace].get();
+    if (file == nullptr) {
+      continue;
+    }
+    page_id_t page_no = tablespace == GetTablespace(page_id) ? GetPageNumber(page_id) : 0;
+    std::scoped_lock free_space_lk{file->free_space_latch_};
+    for (; page_no < file->end_page_no_; ++page_no) {
+      if (TestAllocated(*file, page_no)) {
+        return MakePageId(tablespace, page_no);
+      }
+    }
+  }
+  return INVALID_PAGE_ID;
+}
+
+/**
+ * Create a tablespace and its data file
+ */
+tablespace_id_t DiskManager::CreateTablespace(const std::string &file_name) {
+  std::scoped_lock tablespace_lk{tablespace_latch_};
+  tablespace_id_t tablespace = DEFAULT_TABLESPACE + 1;
+  while (tablespace < MAX_TABLESPACES && files_[tablespace] != nullptr) {
+    tablespace++;
+  }
+  if (tablespace == MAX_TABLESPACES) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "no tablespace ids left");
+  }
+  std::string data_file_name = file_name;
+  if (data_file_name.empty()) {
+    data_file_name = file_name_.substr(0, file_name_.rfind('.')) + "." + std::to_string(tablespace) + ".db";
+  }
+  // refuse to take over a file that is already there, which may well be somebody else's
+  std::shared_ptr<DataFile> file = OpenDataFile(data_file_name, O_CREAT | O_EXCL);
+  if (file == nullptr) {
+    throw Exception("can't create tablespace file " + data_file_name);
+  }
+  std::atomic_store(&files_[tablespace], std::move(file));
+  SaveTablespaces();
+  return tablespace;
+}
+
+/**
+ * Drop a tablespace by unlinking its data file
+ */
+void DiskManager::DropTablespace(tablespace_id_t tablespace) {
+  std::scoped_lock tablespace_lk{tablespace_latch_};
+  if (tablespace <= DEFAULT_TABLESPACE || tablespace >= MAX_TABLESPACES || files_[tablespace] == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "tablespace " + std::to_string(tablespace) + " cannot be dropped");
+  }
+  // I/O that looked the file up already holds on to it and finishes against the unlinked file; the last of it closes
+  // the file
+  std::shared_ptr<DataFile> file = std::atomic_exchange(&files_[tablespace], std::shared_ptr<DataFile>());
+  // the file goes first: a crash in between leaves a listed tablespace without a file, which is recreated empty
+  if (unlink(file->file_name_.c_str()) != 0) {
+    LOG_DEBUG("I/O error while removing tablespace file");
+  }
+  if (compress_) {
+    unlink((file->file_name_ + SLOT_FILE_SUFFIX).c_str());
+    unlink((file->file_name_ + SLOT_MAP_FILE_SUFFIX).c_str());
+  }
+  SaveTablespaces();
+}
+
+/**
+ * Returns the data file of a tablespace
+ */
+std::string DiskManager::GetTablespaceFile(tablespace_id_t tablespace) {
+  std::scoped_lock tablespace_lk{tablespace_latch_};
+  if (tablespace < 0 || tablespace >= MAX_TABLESPACES || files_[tablespace] == nullptr) {
+    return "";
+  }
+  return files_[tablespace]->file_name_;
+}
+
+/**
+ * Truncate every data file after its last allocated page
+ */
+size_t DiskManager::TruncateFreePages() {
+  std::scoped_lock tablespace_lk{tablespace_latch_};
+  size_t num_pages = 0;
+  for (auto &file : files_) {
+    if (file != nullptr) {
+      std::scoped_lock free_space_lk{file->free_space_latch_};
+      num_pages += TruncateAfterLastPage(file.get());
+    }
+  }
+  return num_pages;
+}
+
+/**
+ * Returns the size of the db file
+ */
+int64_t DiskManager::GetDbFileSize() { return GetFileSize(file_name_); }
+
+/**
+ * Returns the disk space taken up by the data files
+ */
+int64_t DiskManager::GetDiskUsage() {
+  std::scoped_lock tablespace_lk{tablespace_latch_};
+  int64_t usage = 0;
+  for (auto &file : files_) {
+    if (file != nullptr) {
+      usage += DiskUsage(file->fd_) + DiskUsage(file->slot_fd_) + DiskUsage(file->slot_map_fd_);
+    }
+  }
+  return usage;
+}
 
 /**
  * Returns number of flushes made so far
@@ -207,18 +640,485 @@ int DiskManager::GetNumFlushes() const { return num_flushes_; }
  */
 int DiskManager::GetNumWrites() const { return num_writes_; }
 
+/**
+ * Returns number of page reads made so far
+ */
+int DiskManager::GetNumReads() const { return num_reads_; }
+
 /**
  * Returns true if the log is currently being flushed
  */
 bool DiskManager::GetFlushState() const { return flush_log_; }
 
+/**
+ * Private helper functions for the data files of the tablespaces
+ */
+std::shared_ptr<DiskManager::DataFile> DiskManager::FindFile(page_id_t page_id) const {
+  tablespace_id_t tablespace = GetTablespace(page_id);
+  return tablespace < 0 || tablespace >= MAX_TABLESPACES ? nullptr : std::atomic_load(&files_[tablespace]);
+}
+
+std::shared_ptr<DiskManager::DataFile> DiskManager::GetFile(page_id_t page_id) const {
+  std::shared_ptr<DataFile> file = FindFile(page_id);
+  if (file == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_RANGE,
+                    "page " + std::to_string(page_id) + " is in a tablespace that does not exist");
+  }
+  return file;
+}
+
+std::shared_ptr<DiskManager::DataFile> DiskManager::OpenDataFile(const std::string &file_name, int flags) {
+  int fd = open(file_name.c_str(), O_RDWR | flags, 0644);
+  if (fd < 0) {
+    return nullptr;
+  }
+  auto file = std::make_shared<DataFile>();
+  file->file_name_ = file_name;
+  file->fd_ = fd;
+  if (compress_) {
+    // the slot files of a data file that was just created can only be left over from an earlier one
+    int slot_flags = O_RDWR | O_CREAT | ((flags & O_EXCL) != 0 ? O_TRUNC : 0);
+    file->slot_fd_ = open((file_name + SLOT_FILE_SUFFIX).c_str(), slot_flags, 0644);
+    file->slot_map_fd_ = open((file_name + SLOT_MAP_FILE_SUFFIX).c_str(), slot_flags, 0644);
+    if (file->slot_fd_ < 0 || file->slot_map_fd_ < 0) {
+      return nullptr;
+    }
+    LoadSlotMap(file.get());
+  }
+  LoadFreeSpaceMap(file.get());
+  return file;
+}
+
+void DiskManager::CloseDataFile(DataFile *file) {
+  for (int *fd : {&file->fd_, &file->slot_fd_, &file->slot_map_fd_}) {
+    if (*fd >= 0) {
+      close(*fd);
+      *fd = -1;
+    }
+  }
+}
+
+void DiskManager::SyncDataFile(DataFile *file) {
+  for (int fd : {file->fd_, file->slot_fd_, file->slot_map_fd_}) {
+    if (fd >= 0 && fdatasync(fd) != 0) {
+      LOG_DEBUG("I/O error while syncing data file");
+    }
+  }
+}
+
+void DiskManager::LoadTablespaces() {
+  std::ifstream in(tablespace_file_name_);
+  tablespace_id_t tablespace;
+  std::string data_file_name;
+  while (in >> tablespace && std::getline(in >> std::ws, data_file_name)) {
+    if (tablespace <= DEFAULT_TABLESPACE || tablespace >= MAX_TABLESPACES) {
+      LOG_DEBUG("bad tablespace file");
+      continue;
+    }
+    // a file lost to a crash while its tablespace was created or dropped comes back empty
+    files_[tablespace] = OpenDataFile(data_file_name, O_CREAT);
+    if (files_[tablespace] == nullptr) {
+      throw Exception("can't open tablespace file " + data_file_name);
+    }
+  }
+}
+
+void DiskManager::SaveTablespaces() {
+  // write the new list next to the old one and swap it in, so that a crash leaves one or the other
+  std::string tmp_name = tablespace_file_name_ + ".tmp";
+  {
+    std::ofstream out(tmp_name, std::ios::trunc);
+    for (tablespace_id_t tablespace = DEFAULT_TABLESPACE + 1; tablespace < MAX_TABLESPACES; ++tablespace) {
+      if (files_[tablespace] != nullptr) {
+        out << tablespace << ' ' << files_[tablespace]->file_name_ << '\n';
+      }
+    }
+    if (!out.flush()) {
+      LOG_DEBUG("I/O error while writing tablespace file");
+      return;
+    }
+  }
+  if (rename(tmp_name.c_str(), tablespace_file_name_.c_str()) != 0) {
+    LOG_DEBUG("I/O error while replacing tablespace file");
+  }
+}
+
+/**
+ * Private helper functions for the data of pages, in place or in the slot files
+ */
+bool DiskManager::WritePageData(DataFile *file, page_id_t page_no, const char *page_data) {
+  if (file->slot_fd_ < 0) {
+    // positional writes do not share a cursor, so concurrent writers need no latch; the data reaches the OS right away
+    return PwriteFully(file->fd_, page_data, PAGE_SIZE, PageOffset(page_no));
+  }
+  // An image that does not save at least a unit is not worth decompressing, so the page is stored as is.
+  char image[PAGE_SIZE];
+  const char *data = image;
+  size_t length = LzCodec::Compress(page_data, PAGE_SIZE, image, PAGE_SIZE - COMPRESSED_SLOT_SIZE);
+  PageSlot slot{0, static_cast<uint32_t>(length)};
+  if (slot.length_ == 0) {
+    data = page_data;
+    slot.length_ = PAGE_SIZE;
+  }
+  {
+    std::unique_lock slot_lk{file->slot_latch_};
+    slot.unit_ = AllocateSlot(file, SlotUnits(slot.length_));
+  }
+  // nothing points at the new slot yet, so it is written without the latch, and the old image stays valid meanwhile
+  bool written = PwriteFully(file->slot_fd_, data, slot.length_, SlotOffset(slot.unit_));
+  std::unique_lock slot_lk{file->slot_latch_};
+  if (!written) {
+    FreeSlot(file, slot);
+    return false;
+  }
+  SetSlot(file, page_no, slot);
+  return true;
+}
+
+ssize_t DiskManager::ReadPageData(DataFile *file, page_id_t page_no, char *page_data) {
+  if (file->slot_fd_ < 0) {
+    return PreadFully(file->fd_, page_data, PAGE_SIZE, PageOffset(page_no));
+  }
+  char image[PAGE_SIZE];
+  std::shared_lock slot_lk{file->slot_latch_};
+  PageSlot slot = static_cast<size_t>(page_no) < file->slots_.size() ? file->slots_[page_no] : PageSlot{0, 0};
+  if (slot.length_ == 0) {
+    memset(page_data, 0, PAGE_SIZE);
+    return PAGE_SIZE;
+  }
+  if (slot.length_ == PAGE_SIZE) {
+    return PreadFully(file->slot_fd_, page_data, PAGE_SIZE, SlotOffset(slot.unit_));
+  }
+  ssize_t read_count = PreadFully(file->slot_fd_, image, slot.length_, SlotOffset(slot.unit_));
+  slot_lk.unlock();
+  if (read_count < 0) {
+    return -1;
+  }
+  if (read_count != slot.length_ || !LzCodec::Decompress(image, slot.length_, page_data, PAGE_SIZE)) {
+    LOG_DEBUG("compressed page cannot be decompressed");
+    memset(page_data, 0, PAGE_SIZE);
+  }
+  return PAGE_SIZE;
+}
+
+void DiskManager::LoadSlotMap(DataFile *file) {
+  int64_t map_size = GetFileSize(file->file_name_ + SLOT_MAP_FILE_SUFFIX);
+  file->slots_.assign(std::max<int64_t>(map_size, 0) / sizeof(PageSlot), PageSlot{0, 0});
+  auto *data = reinterpret_cast<char *>(file->slots_.data());
+  size_t size = file->slots_.size() * sizeof(PageSlot);
+  ssize_t read_count = PreadFully(file->slot_map_fd_, data, size, 0);
+  if (read_count < 0) {
+    LOG_DEBUG("I/O error while reading slot map");
+    read_count = 0;
+  }
+  memset(data + read_count, 0, size - read_count);
+
+  // Everything between the slots in use is free, in pieces no larger than a slot.
+  std::vector<std::pair<uint32_t, uint32_t>> used;
+  for (auto &slot : file->slots_) {
+    if (slot.length_ > PAGE_SIZE) {
+      LOG_DEBUG("bad slot map entry");
+      slot = PageSlot{0, 0};
+    }
+    if (slot.length_ != 0) {
+      used.emplace_back(slot.unit_, slot.unit_ + SlotUnits(slot.length_));
+    }
+  }
+  std::sort(used.begin(), used.end());
+  uint32_t end = 0;
+  for (auto [begin, slot_end] : used) {
+    for (; end < begin; end += std::min(begin - end, MAX_SLOT_UNITS)) {
+      file->free_slots_[std::min(begin - end, MAX_SLOT_UNITS)].push_back(end);
+    }
+    end = std::max(end, slot_end);
+  }
+  file->slot_end_ = end;
+  file->slot_preallocated_end_ = SlotOffset(end);
+}
+
+uint32_t DiskManager::AllocateSlot(DataFile *file, uint32_t units) {
+  for (uint32_t size = units; size <= MAX_SLOT_UNITS; ++size) {
+    auto &free_slots = file->free_slots_[size];
+    if (free_slots.empty()) {
+      continue;
+    }
+    uint32_t unit = free_slots.back();
+    free_slots.pop_back();
+    if (size > units) {
+      file->free_slots_[size - units].push_back(unit + units);
+    }
+    return unit;
+  }
+  uint32_t unit = file->slot_end_;
+  file->slot_end_ += units;
+  // the slot file is what grows with compression, so its space is the one preallocated, an extent's worth at a time
+  if (SlotOffset(file->slot_end_) > file->slot_preallocated_end_) {
+    off_t extent_size = static_cast<off_t>(extent_pages_) * PAGE_SIZE;
+    if (fallocate(file->slot_fd_, FALLOC_FL_KEEP_SIZE, file->slot_preallocated_end_, extent_size) != 0) {
+      LOG_DEBUG("cannot preallocate slot file");
+    }
+    file->slot_preallocated_end_ += extent_size;
+  }
+  return unit;
+}
+
+void DiskManager::FreeSlot(DataFile *file, const PageSlot &slot) {
+  if (slot.length_ != 0) {
+    file->free_slots_[SlotUnits(slot.length_)].push_back(slot.unit_);
+  }
+}
+
+void DiskManager::SetSlot(DataFile *file, page_id_t page_no, const PageSlot &slot) {
+  if (static_cast<size_t>(page_no) >= file->slots_.size()) {
+    if (slot.length_ == 0) {
+      return;
+    }
+    file->slots_.resize(page_no + 1, PageSlot{0, 0});
+  }
+  PageSlot old_slot = file->slots_[page_no];
+  file->slots_[page_no] = slot;
+  // the entry is written whole with one small write, so a crash leaves it pointing at the old image or the new one
+  if (!PwriteFully(file->slot_map_fd_, reinterpret_cast<const char *>(&slot), sizeof(slot),
+                   static_cast<off_t>(page_no) * sizeof(PageSlot))) {
+    LOG_DEBUG("I/O error while writing slot map");
+  }
+  FreeSlot(file, old_slot);
+}
+
+/**
+ * Private helper functions for the free-space map
+ */
+off_t DiskManager::PageOffset(page_id_t page_no) {
+  // Every run of pages is preceded by its header pages, so page p has p / FREE_SPACE_MAP_INTERVAL + 1 runs' worth.
+  return (static_cast<off_t>(page_no) + (page_no / FREE_SPACE_MAP_INTERVAL + 1) * RUN_HEADER_PAGES) * PAGE_SIZE;
+}
+
+off_t DiskManager::MapPageOffset(size_t interval) {
+  return static_cast<off_t>(interval) * (FREE_SPACE_MAP_INTERVAL + RUN_HEADER_PAGES) * PAGE_SIZE;
+}
+
+off_t DiskManager::ChecksumOffset(page_id_t page_no) {
+  return MapPageOffset(page_no / FREE_SPACE_MAP_INTERVAL) + PAGE_SIZE +
+         static_cast<off_t>(page_no % FREE_SPACE_MAP_INTERVAL) * sizeof(uint32_t);
+}
+
+uint32_t DiskManager::PageChecksum(const char *page_data) {
+  uint32_t checksum = Crc32c::Compute(page_data, PAGE_SIZE);
+  return checksum == 0 ? 1 : checksum;
+}
+
+void DiskManager::WriteChecksum(page_id_t page_id, uint32_t checksum) {
+  std::shared_ptr<DataFile> file = FindFile(page_id);
+  if (file == nullptr || !PwriteFully(file->fd_, reinterpret_cast<const char *>(&checksum), sizeof(checksum),
+                                      ChecksumOffset(GetPageNumber(page_id)))) {
+    LOG_DEBUG("I/O error while writing checksum");
+  }
+}
+
+void DiskManager::ReadChecksums(page_id_t first_page_id, size_t num_pages, uint32_t *checksums) {
+  auto *data = reinterpret_cast<char *>(checksums);
+  size_t size = num_pages * sizeof(uint32_t);
+  std::shared_ptr<DataFile> file = FindFile(first_page_id);
+  ssize_t read_count =
+      file == nullptr ? 0 : PreadFully(file->fd_, data, size, ChecksumOffset(GetPageNumber(first_page_id)));
+  if (read_count < 0) {
+    LOG_DEBUG("I/O error while reading checksums");
+    read_count = 0;
+  }
+  memset(data + read_count, 0, size - read_count);
+}
+
+void DiskManager::LoadFreeSpaceMap(DataFile *file) {
+  int64_t file_size = GetFileSize(file->file_name_);
+  off_t interval_size = static_cast<off_t>(FREE_SPACE_MAP_INTERVAL + RUN_HEADER_PAGES) * PAGE_SIZE;
+  size_t num_intervals = file_size <= 0 ? 0 : (file_size + interval_size - 1) / interval_size;
+  file->free_space_map_.assign(num_intervals * PAGE_SIZE, 0);
+  for (size_t i = 0; i < num_intervals; ++i) {
+    if (PreadFully(file->fd_, file->free_space_map_.data() + i * PAGE_SIZE, PAGE_SIZE, MapPageOffset(i)) < 0) {
+      LOG_DEBUG("I/O error while reading free-space map");
+    }
+  }
+  file->end_page_no_ = static_cast<page_id_t>(num_intervals * FREE_SPACE_MAP_INTERVAL);
+  while (file->end_page_no_ > 0 && !TestAllocated(*file, file->end_page_no_ - 1)) {
+    file->end_page_no_--;
+  }
+}
+
+bool DiskManager::TestAllocated(const DataFile &file, page_id_t page_no) {
+  size_t byte = page_no / 8;
+  return byte < file.free_space_map_.size() && (file.free_space_map_[byte] & (1 << (page_no % 8))) != 0;
+}
+
+void DiskManager::SetAllocated(DataFile *file, page_id_t page_no, bool allocated) {
+  size_t interval = page_no / FREE_SPACE_MAP_INTERVAL;
+  if (file->free_space_map_.size() < (interval + 1) * PAGE_SIZE) {
+    file->free_space_map_.resize((interval + 1) * PAGE_SIZE, 0);
+  }
+  char &byte = file->free_space_map_[page_no / 8];
+  byte = allocated ? (byte | (1 << (page_no % 8))) : (byte & ~(1 << (page_no % 8)));
+  if (!PwriteFully(file->fd_, file->free_space_map_.data() + interval * PAGE_SIZE, PAGE_SIZE,
+                   MapPageOffset(interval))) {
+    LOG_DEBUG("I/O error while writing free-space map");
+  }
+  if (!allocated && file->slot_fd_ >= 0) {
+    std::unique_lock slot_lk{file->slot_latch_};
+    SetSlot(file, page_no, PageSlot{0, 0});
+  }
+  // A freed page may come back shorter or not at all once the file is truncated; it is not verified until rewritten.
+  if (!allocated) {
+    uint32_t checksum = 0;
+    if (!PwriteFully(file->fd_, reinterpret_cast<const char *>(&checksum), sizeof(checksum),
+                     ChecksumOffset(page_no))) {
+      LOG_DEBUG("I/O error while writing checksum");
+    }
+  }
+}
+
+bool DiskManager::ExtentHas(const DataFile &file, page_id_t extent, bool allocated) const {
+  auto extent_pages = static_cast<page_id_t>(extent_pages_);
+  for (page_id_t page_no = extent * extent_pages; page_no < (extent + 1) * extent_pages; ++page_no) {
+    if (TestAllocated(file, page_no) == allocated) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void DiskManager::CloseExtent(DataFile *file, tablespace_id_t tablespace, page_id_t extent) {
+  file->open_extents_.erase(extent);
+  page_id_t first_page_no = extent * static_cast<page_id_t>(extent_pages_);
+  auto base = static_cast<uint32_t>(MakePageId(tablespace, 0));
+  for (auto &[instances, hint] : file->free_page_hints_) {
+    // the first page number in the extent that the hint's instance may use, as in AllocatePage
+    auto residue = (base + static_cast<uint32_t>(first_page_no)) % instances.first;
+    auto own_page_no = first_page_no + static_cast<page_id_t>((instances.second + instances.first - residue) %
+                                                              instances.first);
+    hint = std::min(hint, own_page_no);
+  }
+}
+
+void DiskManager::PreallocateExtent(DataFile *file, page_id_t page_no) {
+  // with compression, the data file holds header pages only
+  if (file->slot_fd_ >= 0) {
+    return;
+  }
+  auto extent_pages = static_cast<page_id_t>(extent_pages_);
+  page_id_t first_page_no = page_no / extent_pages * extent_pages;
+  off_t end = PageOffset(first_page_no + extent_pages - 1) + PAGE_SIZE;
+  if (end <= file->preallocated_end_) {
+    return;
+  }
+  // keep the size, so that the pages still read as zeros and the end of the file is where the last page was written
+  off_t begin = PageOffset(first_page_no);
+  if (fallocate(file->fd_, FALLOC_FL_KEEP_SIZE, begin, end - begin) != 0) {
+    LOG_DEBUG("cannot preallocate extent");
+  }
+  file->preallocated_end_ = end;
+}
+
+size_t DiskManager::TruncateAfterLastPage(DataFile *file) {
+  // Pages past the end of the file read as zeros, and header pages that are gone read as all free and unchecked, so
+  // cutting them off loses nothing.
+  off_t end = file->end_page_no_ == 0 ? 0 : PageOffset(file->end_page_no_ - 1) + PAGE_SIZE;
+  int64_t file_size = GetFileSize(file->file_name_);
+  if (file_size <= end) {
+    return 0;
+  }
+  if (ftruncate(file->fd_, end) != 0) {
+    LOG_DEBUG("I/O error while truncating");
+    return 0;
+  }
+  // truncation gives back the preallocated space past the end too
+  file->preallocated_end_ = std::min(file->preallocated_end_, end);
+  return (file_size - end) / PAGE_SIZE;
+}
+
 /**
  * Private helper function to get disk file size
  */
-int DiskManager::GetFileSize(const std::string &file_name) {
+int64_t DiskManager::GetFileSize(const std::string &file_name) {
   struct stat stat_buf;
   int rc = stat(file_name.c_str(), &stat_buf);
-  return rc == 0 ? static_cast<int>(stat_buf.st_size) : -1;
+  return rc == 0 ? static_cast<int64_t>(stat_buf.st_size) : -1;
+}
+
+void DiskManager::DoubleWritePages(const page_id_t *page_ids, const char *const *page_data, size_t num_pages) {
+  // Lay out the header and the pages back to back, so that they go to the journal in a single write.
+  std::vector<char> journal((num_pages + 1) * PAGE_SIZE, 0);
+  DoubleWriteHeader header{};
+  header.magic_ = DOUBLE_WRITE_MAGIC;
+  header.num_pages_ = num_pages;
+  for (size_t i = 0; i < num_pages; ++i) {
+    header.entries_[i].page_id_ = page_ids[i];
+    header.entries_[i].checksum_ = PageChecksum(page_data[i]);
+    memcpy(journal.data() + (i + 1) * PAGE_SIZE, page_data[i], PAGE_SIZE);
+  }
+  memcpy(journal.data(), &header, sizeof(header));
+  uint32_t header_checksum = HeaderChecksum(journal.data());
+  memcpy(journal.data() + offsetof(DoubleWriteHeader, checksum_), &header_checksum, sizeof(header_checksum));
+
+  std::scoped_lock dwb_lk{dwb_latch_};
+  // if the journal cannot be written, the pages are still written in place, only without the protection
+  if (!PwriteFully(dwb_fd_, journal.data(), journal.size(), 0) || fdatasync(dwb_fd_) != 0) {
+    LOG_DEBUG("I/O error while journaling pages");
+  }
+  std::vector<std::shared_ptr<DataFile>> files;
+  for (size_t i = 0; i < num_pages; ++i) {
+    WritePageInPlace(page_ids[i], page_data[i]);
+    std::shared_ptr<DataFile> file = GetFile(page_ids[i]);
+    if (std::find(files.begin(), files.end(), file) == files.end()) {
+      files.push_back(file);
+    }
+  }
+  // the journal may only be reused once the pages in place are durable, in whichever data files they are
+  for (const auto &file : files) {
+    SyncDataFile(file.get());
+  }
+}
+
+void DiskManager::RecoverDoubleWriteFile() {
+  int fd = open(dwb_name_.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return;
+  }
+  char header_page[PAGE_SIZE];
+  DoubleWriteHeader header{};
+  if (PreadFully(fd, header_page, PAGE_SIZE, 0) == PAGE_SIZE) {
+    memcpy(&header, header_page, sizeof(header));
+  }
+  // A torn header means that the journal write was interrupted, before anything was written in place.
+  if (header.magic_ == DOUBLE_WRITE_MAGIC && header.num_pages_ <= DOUBLE_WRITE_PAGES &&
+      header.checksum_ == HeaderChecksum(header_page)) {
+    char journaled[PAGE_SIZE];
+    char in_place[PAGE_SIZE];
+    for (size_t i = 0; i < header.num_pages_; ++i) {
+      page_id_t page_id = header.entries_[i].page_id_;
+      uint32_t checksum = header.entries_[i].checksum_;
+      // Skip pages whose journal copy is torn, and pages that have been deallocated since, tablespace and all.
+      if (PreadFully(fd, journaled, PAGE_SIZE, static_cast<off_t>(i + 1) * PAGE_SIZE) != PAGE_SIZE ||
+          PageChecksum(journaled) != checksum || !IsAllocated(page_id)) {
+        continue;
+      }
+      std::shared_ptr<DataFile> file = GetFile(page_id);
+      ssize_t read_count = std::max<ssize_t>(ReadPageData(file.get(), GetPageNumber(page_id), in_place), 0);
+      memset(in_place + read_count, 0, PAGE_SIZE - read_count);
+      uint32_t stored_checksum;
+      ReadChecksums(page_id, 1, &stored_checksum);
+      if (read_count == PAGE_SIZE && stored_checksum == checksum && memcmp(in_place, journaled, PAGE_SIZE) == 0) {
+        continue;
+      }
+      if (WritePageData(file.get(), GetPageNumber(page_id), journaled)) {
+        WriteChecksum(page_id, checksum);
+        SyncDataFile(file.get());
+        num_restored_pages_++;
+      }
+    }
+    if (num_restored_pages_ > 0) {
+      LOG_INFO("restored %zu pages from %s", num_restored_pages_, dwb_name_.c_str());
+    }
+  }
+  close(fd);
+  unlink(dwb_name_.c_str());
 }
 
 }  // namespace bustub
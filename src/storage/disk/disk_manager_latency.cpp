@@ -0,0 +1,66 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_latency.cpp
+//
+// Identification: src/storage/disk/disk_manager_latency.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_latency.h"
+
+#include <algorithm>
+#include <thread>  // NOLINT
+
+namespace bustub {
+
+void DiskManagerLatency::WritePage(page_id_t page_id, const char *page_data) {
+  Delay(PAGE_SIZE, true);
+  disk_->WritePage(page_id, page_data);
+}
+
+void DiskManagerLatency::WritePages(const std::vector<page_id_t> &page_ids,
+                                    const std::vector<const char *> &page_data) {
+  Delay(page_ids.size() * PAGE_SIZE, true);
+  disk_->WritePages(page_ids, page_data);
+}
+
+void DiskManagerLatency::ReadPage(page_id_t page_id, char *page_data) {
+  Delay(PAGE_SIZE, false);
+  disk_->ReadPage(page_id, page_data);
+}
+
+void DiskManagerLatency::ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data) {
+  Delay(page_ids.size() * PAGE_SIZE, false);
+  disk_->ReadPages(page_ids, page_data);
+}
+
+void DiskManagerLatency::WriteLog(char *log_data, int size) {
+  Delay(size, true);
+  disk_->WriteLog(log_data, size);
+}
+
+bool DiskManagerLatency::ReadLog(char *log_data, int size, int offset) {
+  Delay(size, false);
+  return disk_->ReadLog(log_data, size, offset);
+}
+
+void DiskManagerLatency::Delay(size_t bytes, bool is_write) {
+  using std::chrono::steady_clock;
+  size_t bandwidth = is_write ? profile_.write_bandwidth_ : profile_.read_bandwidth_;
+  auto done = steady_clock::now();
+  if (bandwidth != 0) {
+    // Queue up behind the transfers of the requests before this one.
+    auto transfer = std::chrono::duration_cast<steady_clock::duration>(std::chrono::duration<double>(
+        static_cast<double>(bytes) / static_cast<double>(bandwidth)));
+    std::scoped_lock latency_lk{latch_};
+    busy_until_ = std::max(busy_until_, done) + transfer;
+    done = busy_until_;
+  }
+  std::this_thread::sleep_until(done + (is_write ? profile_.write_latency_ : profile_.read_latency_));
+}
+
+}  // namespace bustub
@@ -0,0 +1,123 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_memory.cpp
+//
+// Identification: src/storage/disk/disk_manager_memory.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_memory.h"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include "common/exception.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+DiskManagerMemory::DiskManagerMemory(size_t max_pages) : max_pages_(max_pages) {
+  // Only address space is reserved; the kernel backs pages with memory as they are first written.
+  void *mapped =
+      mmap(nullptr, max_pages_ * PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (mapped == MAP_FAILED) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot reserve the in-memory disk");
+  }
+  data_ = static_cast<char *>(mapped);
+}
+
+DiskManagerMemory::~DiskManagerMemory() { munmap(data_, max_pages_ * PAGE_SIZE); }
+
+char *DiskManagerMemory::GetPageData(page_id_t page_id) const {
+  if (page_id < 0 || static_cast<size_t>(page_id) >= max_pages_) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "page " + std::to_string(page_id) + " is out of range");
+  }
+  return data_ + static_cast<size_t>(page_id) * PAGE_SIZE;
+}
+
+void DiskManagerMemory::WritePage(page_id_t page_id, const char *page_data) {
+  memcpy(GetPageData(page_id), page_data, PAGE_SIZE);
+  num_writes_ += 1;
+}
+
+void DiskManagerMemory::ReadPage(page_id_t page_id, char *page_data) {
+  memcpy(page_data, GetPageData(page_id), PAGE_SIZE);
+  num_reads_ += 1;
+}
+
+void DiskManagerMemory::WriteLog(char *log_data, int size) {
+  if (size == 0) {
+    return;
+  }
+  if (flush_log_f_ != nullptr) {
+    // used for checking non-blocking flushing
+    BUSTUB_ASSERT(flush_log_f_->wait_for(std::chrono::seconds(10)) == std::future_status::ready,
+                  "non-blocking flush did not finish");
+  }
+  std::scoped_lock log_lk{log_latch_};
+  log_.insert(log_.end(), log_data, log_data + size);
+  num_flushes_ += 1;
+}
+
+bool DiskManagerMemory::ReadLog(char *log_data, int size, int offset) {
+  std::scoped_lock log_lk{log_latch_};
+  if (offset < 0 || static_cast<size_t>(offset) >= log_.size()) {
+    return false;
+  }
+  size_t read_count = std::min(static_cast<size_t>(size), log_.size() - offset);
+  memcpy(log_data, log_.data() + offset, read_count);
+  memset(log_data + read_count, 0, size - read_count);
+  return true;
+}
+
+page_id_t DiskManagerMemory::AllocatePage(uint32_t num_instances, uint32_t instance_index, tablespace_id_t tablespace,
+                                          page_id_t /* near_page_id */) {
+  BUSTUB_ASSERT(instance_index < num_instances, "instance index out of range");
+  if (tablespace != DEFAULT_TABLESPACE) {
+    throw NotImplementedException("the in-memory disk only has the default tablespace");
+  }
+  std::scoped_lock allocation_lk{allocation_latch_};
+  auto hint = free_page_hints_.emplace(std::make_pair(num_instances, instance_index), instance_index).first;
+  auto page_id = static_cast<size_t>(hint->second);
+  while (page_id < allocated_.size() && allocated_[page_id]) {
+    page_id += num_instances;
+  }
+  if (page_id >= max_pages_) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "the in-memory disk is full");
+  }
+  if (page_id >= allocated_.size()) {
+    allocated_.resize(page_id + 1);
+  }
+  allocated_[page_id] = true;
+  hint->second = static_cast<page_id_t>(page_id + num_instances);
+  return static_cast<page_id_t>(page_id);
+}
+
+void DiskManagerMemory::DeallocatePage(page_id_t page_id) {
+  std::scoped_lock allocation_lk{allocation_latch_};
+  if (page_id < 0 || static_cast<size_t>(page_id) >= allocated_.size() || !allocated_[page_id]) {
+    return;
+  }
+  allocated_[page_id] = false;
+  for (auto &[instances, hint] : free_page_hints_) {
+    if (static_cast<uint32_t>(page_id) % instances.first == instances.second) {
+      hint = std::min(hint, page_id);
+    }
+  }
+  // Give the memory back; the page reads as zeros from now on.
+  madvise(GetPageData(page_id), PAGE_SIZE, MADV_DONTNEED);
+}
+
+bool DiskManagerMemory::IsAllocated(page_id_t page_id) {
+  std::scoped_lock allocation_lk{allocation_latch_};
+  return page_id >= 0 && static_cast<size_t>(page_id) < allocated_.size() && allocated_[page_id];
+}
+
+}  // namespace bustub
@@ -0,0 +1,94 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_scrubber.cpp
+//
+// Identification: src/storage/disk/page_scrubber.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/page_scrubber.h"
+
+#include <utility>
+
+#include "common/logger.h"
+
+namespace bustub {
+
+PageScrubber::PageScrubber(DiskManager *disk_manager, std::function<bool(page_id_t)> is_hot)
+    : disk_manager_(disk_manager), is_hot_(std::move(is_hot)) {
+  thread_ = std::thread(&PageScrubber::Run, this);
+}
+
+PageScrubber::~PageScrubber() {
+  {
+    std::scoped_lock scrubber_lk{latch_};
+    running_ = false;
+  }
+  cv_.notify_one();
+  thread_.join();
+}
+
+size_t PageScrubber::GetNumScrubbed() {
+  std::scoped_lock scrubber_lk{latch_};
+  return num_scrubbed_;
+}
+
+std::set<page_id_t> PageScrubber::GetCorruptPages() {
+  std::scoped_lock scrubber_lk{latch_};
+  return corrupt_pages_;
+}
+
+void PageScrubber::Run() {
+  std::unique_lock scrubber_lk{latch_};
+  while (!cv_.wait_for(scrubber_lk, scrubber_interval, [&] { return !running_; })) {
+    scrubber_lk.unlock();
+    int num_reads = disk_manager_->GetNumReads();
+    int num_writes = disk_manager_->GetNumWrites();
+    if (num_reads == last_num_reads_ && num_writes == last_num_writes_) {
+      ScrubRound();
+    }
+    last_num_reads_ = num_reads;
+    last_num_writes_ = num_writes;
+    scrubber_lk.lock();
+  }
+}
+
+void PageScrubber::ScrubRound() {
+  for (int i = 0; i < SCRUB_PAGES_PER_ROUND; ++i) {
+    page_id_t page_id = disk_manager_->NextAllocatedPage(next_page_id_);
+    if (page_id == INVALID_PAGE_ID) {
+      // Start over at the beginning of the file next round.
+      next_page_id_ = 0;
+      return;
+    }
+    next_page_id_ = page_id + 1;
+    if (is_hot_ != nullptr && is_hot_(page_id)) {
+      continue;
+    }
+
+    uint64_t writes_started = disk_manager_->GetWritesStarted();
+    bool intact = disk_manager_->CheckPage(page_id);
+    if (!intact) {
+      // A write that was under way may have been caught between its data and its checksum. Look once more, and only
+      // believe the mismatch if no write was under way at any point in between.
+      intact = disk_manager_->CheckPage(page_id);
+      if (!intact && (disk_manager_->GetWritesFinished() != writes_started ||
+                      disk_manager_->GetWritesStarted() != writes_started)) {
+        continue;
+      }
+    }
+    std::scoped_lock scrubber_lk{latch_};
+    num_scrubbed_++;
+    if (intact) {
+      corrupt_pages_.erase(page_id);
+    } else if (corrupt_pages_.insert(page_id).second) {
+      LOG_WARN("page %d does not match its checksum", page_id);
+    }
+  }
+}
+
+}  // namespace bustub
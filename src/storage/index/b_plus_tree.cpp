@@ -9,8 +9,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <cstring>
 #include <iostream>
 #include <string>
+#include <utility>
 
 #include "common/exception.h"
 #include "common/logger.h"
@@ -21,10 +23,11 @@
 namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                           page_id_t root_page_id)
+                           page_id_t root_page_id, tablespace_id_t tablespace)
     : index_name_(std::move(name)),
       root_page_id_(INVALID_PAGE_ID),
       buffer_pool_manager_(buffer_pool_manager),
+      tablespace_(tablespace),
       comparator_(comparator) {}
 
 
@@ -50,27 +53,16 @@ IsEmpty() const {
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::
 GetValue(const KeyType &key, std::vector<ValueType> &result, Transaction *transaction) {
-  auto *leaf = FindLeafPage(key, false, Operation::READONLY, transaction);
-  bool ret = false;
-  if (leaf != nullptr) {
-    ValueType value;
-    if (leaf->Lookup(key, value, comparator_)) {
-      result.push_back(value);
-      ret = true;
-    }
-    UnlockUnpinPages(Operation::READONLY, transaction);
-
-    // in case of `transaction` is nullptr
-    if (transaction == nullptr) {
-      auto page_id = leaf->GetPageId();
-      // unlock and unpin
-      buffer_pool_manager_->FetchPage(page_id)->RUnlatch();
-      buffer_pool_manager_->UnpinPage(page_id, false);
-      // unpin again
-      buffer_pool_manager_->UnpinPage(page_id, false);
-    }
+  ReadPageGuard guard = FindLeafPageRead(key, false);
+  if (!guard.IsValid()) {
+    return false;
   }
-  return ret;
+  ValueType value;
+  if (guard.As<LeafPage>()->Lookup(key, value, comparator_)) {
+    result.push_back(value);
+    return true;
+  }
+  return false;
 }
 
 /*****************************************************************************
@@ -87,6 +79,8 @@ INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::
 Insert(const KeyType &key, const ValueType &value, Transaction *transaction) { 
   
+  {
+    // released before descending, as FindLeafPage takes the same mutex to guard the root
     std::lock_guard<std::mutex> lock(mutex_);
     if (IsEmpty()) {
       //std::cerr << "thread: " << transaction->GetThreadId()
@@ -94,6 +88,7 @@ Insert(const KeyType &key, const ValueType &value, Transaction *transaction) {
       StartNewTree(key, value);
       return true;
     }
+  }
   return InsertIntoLeaf(key, value, transaction);
 }
 /*
@@ -105,18 +100,19 @@ Insert(const KeyType &key, const ValueType &value, Transaction *transaction) {
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::
 StartNewTree(const KeyType &key, const ValueType &value) {
-  page_id_t *root_page_id_ptr = new page_id_t;
-        *root_page_id_ptr = root_page_id_;
-  auto *page = buffer_pool_manager_->NewPageImpl(root_page_id_ptr);
+  page_id_t root_page_id;
+  auto *page = buffer_pool_manager_->NewPageImpl(&root_page_id, tablespace_);
   if (page == nullptr) {
     //throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned while StartNewTree");
   }
   auto root =
       reinterpret_cast<BPlusTreeLeafPage<KeyType, ValueType,
                                          KeyComparator> *>(page->GetData());
-  UpdateRootPageId(true);
-  root->Init(root_page_id_, INVALID_PAGE_ID);
+  root->Init(root_page_id, INVALID_PAGE_ID);
   root->Insert(key, value, comparator_);
+  // published only once it is filled in, as optimistic lookups read it without the mutex
+  root_page_id_ = root_page_id;
+  UpdateRootPageId(true);
 
   // unpin root
   buffer_pool_manager_->UnpinPage(root->GetPageId(), true);
@@ -136,7 +132,8 @@ InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transact
   // find the leaf node
   auto *leaf = FindLeafPage(key, false, Operation::INSERT, transaction);
   if (leaf == nullptr) {
-    return false;
+    // the tree was emptied after Insert looked at it
+    return Insert(key, value, transaction);
   }
 
   // if already in the tree, return false
@@ -191,9 +188,8 @@ InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transact
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 N *BPLUSTREE_TYPE::Split(N *node) {
-    page_id_t *page_id_temp = new page_id_t;
-    page_id_t page_id = *page_id_temp;
-  auto *page = buffer_pool_manager_->NewPageImpl(page_id_temp);
+  page_id_t page_id;
+  auto *page = buffer_pool_manager_->NewPageImpl(&page_id, tablespace_);
   if (page == nullptr) {
     //throw Exception(EXCEPTION_TYPE_INDEX,"all page are pinned while Split");
   }
@@ -218,9 +214,8 @@ void BPLUSTREE_TYPE::
 InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
                 Transaction *transaction) {
       if (old_node->IsRootPage()) {
-        page_id_t *root_page_id_ptr = new page_id_t;
-        *root_page_id_ptr = root_page_id_;
-    auto *page = buffer_pool_manager_->NewPageImpl(root_page_id_ptr);
+    page_id_t root_page_id;
+    auto *page = buffer_pool_manager_->NewPageImpl(&root_page_id, tablespace_);
     if (page == nullptr) {
       //throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned while InsertIntoParent");
     }
@@ -228,13 +223,14 @@ InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new
     auto root =
         reinterpret_cast<BPlusTreeInternalPage<KeyType, page_id_t,
                                                KeyComparator> *>(page->GetData());
-    root->Init(root_page_id_);
+    root->Init(root_page_id);
     root->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
 
-    old_node->SetParentPageId(root_page_id_);
-    new_node->SetParentPageId(root_page_id_);
+    old_node->SetParentPageId(root_page_id);
+    new_node->SetParentPageId(root_page_id);
 
     // update to new 'root_page_id'
+    root_page_id_ = root_page_id;
     UpdateRootPageId(false);
 
     buffer_pool_manager_->UnpinPage(new_node->GetPageId(), true);
@@ -261,10 +257,8 @@ InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new
     } else {
       // internal have no space and have to split
       // first make a copy of internal node, simplify split process
-      page_id_t *page_id_temp = new page_id_t;
-      page_id_t page_id = *page_id_temp;
-
-      auto *page = buffer_pool_manager_->NewPageImpl(page_id_temp);
+      page_id_t page_id;
+      auto *page = buffer_pool_manager_->NewPageImpl(&page_id, tablespace_);
       if (page == nullptr) {
         //throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned while InsertIntoParent");
       }
@@ -578,8 +572,7 @@ INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::
 begin() { 
   KeyType key{};
-  return IndexIterator<KeyType, ValueType, KeyComparator>(
-      FindLeafPage(key, true), 0, buffer_pool_manager_);
+  return IndexIterator<KeyType, ValueType, KeyComparator>(FindLeafPageRead(key, true), 0, buffer_pool_manager_);
  }
 
 /*
@@ -590,12 +583,12 @@ begin() {
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::
 Begin(const KeyType &key) { 
-  auto *leaf = FindLeafPage(key, false);
+  ReadPageGuard guard = FindLeafPageRead(key, false);
   int index = 0;
-  if (leaf != nullptr) {
-    index = leaf->KeyIndex(key, comparator_);
+  if (guard.IsValid()) {
+    index = guard.As<LeafPage>()->KeyIndex(key, comparator_);
   }
-  return IndexIterator<KeyType, ValueType, KeyComparator>(leaf, index, buffer_pool_manager_);
+  return IndexIterator<KeyType, ValueType, KeyComparator>(std::move(guard), index, buffer_pool_manager_);
  }
 
 /*
@@ -683,6 +676,10 @@ FindLeafPage (const KeyType &key, bool leftMost,  Operation op, Transaction *tra
 
   // empty B+ tree?
   if (IsEmpty()) {
+    if (root_is_locked) {
+      root_is_locked = false;
+      unlockRoot();
+    }
     return nullptr;
   }
 
@@ -758,6 +755,82 @@ FindLeafPage (const KeyType &key, bool leftMost,  Operation op, Transaction *tra
   return reinterpret_cast<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *>(node);
 }
 
+/*
+ * Read-only descent used by point lookups and index iterators: latch-crab down from the root with read guards, so
+ * that each child is latched before its parent is released, and hand back the leaf still latched and pinned. An
+ * empty tree gives back an invalid guard. With optimistic latching enabled a few optimistic descents are tried first.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+ReadPageGuard BPLUSTREE_TYPE::FindLeafPageRead(const KeyType &key, bool left_most) {
+  if (optimistic_latching_) {
+    ReadPageGuard leaf;
+    for (int attempt = 0; attempt < OPTIMISTIC_READ_RETRIES; ++attempt) {
+      if (FindLeafPageOptimistic(key, left_most, &leaf)) {
+        return leaf;
+      }
+    }
+  }
+  if (IsEmpty()) {
+    return {};
+  }
+  auto guard = buffer_pool_manager_->FetchPageRead(root_page_id_, AccessType::Index);
+  while (guard.IsValid() && !guard.As<BPlusTreePage>()->IsLeafPage()) {
+    auto *internal = guard.As<InternalPage>();
+    page_id_t child_page_id = left_most ? internal->ValueAt(0) : internal->Lookup(key, comparator_);
+    guard = buffer_pool_manager_->FetchPageRead(child_page_id, AccessType::Index);
+  }
+  return guard;
+}
+
+/*
+ * Optimistic descent: inner nodes are only pinned, never latched. Each node's version is taken before it is read and
+ * validated before anything read from it is used, and a parent is validated again once its child's version has been
+ * taken, so a child pointer is only followed while the parent still holds it. An inner node is copied out and the copy
+ * validated before it is searched, as a search of a node that a writer is halfway through could run off its end. Only
+ * the leaf is read-latched, and only after checking that nobody wrote it since its version was taken.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::FindLeafPageOptimistic(const KeyType &key, bool left_most, ReadPageGuard *leaf) {
+  page_id_t root_page_id = root_page_id_;
+  if (root_page_id == INVALID_PAGE_ID) {
+    *leaf = ReadPageGuard();
+    return true;
+  }
+  auto guard = buffer_pool_manager_->FetchPageBasic(root_page_id, AccessType::Index);
+  uint64_t version;
+  if (!guard.IsValid() || !guard.TryOptimisticRead(&version)) {
+    return false;
+  }
+  // the page may have stopped being the root before its version was taken
+  if (!guard.As<BPlusTreePage>()->IsRootPage() || !guard.Validate(version)) {
+    return false;
+  }
+  while (true) {
+    bool is_leaf = guard.As<BPlusTreePage>()->IsLeafPage();
+    if (!guard.Validate(version)) {
+      return false;
+    }
+    if (is_leaf) {
+      *leaf = guard.UpgradeRead();
+      return leaf->Validate(version);
+    }
+    alignas(InternalPage) char copy[PAGE_SIZE];
+    memcpy(copy, guard.GetData(), PAGE_SIZE);
+    if (!guard.Validate(version)) {
+      return false;
+    }
+    auto *internal = reinterpret_cast<const InternalPage *>(copy);
+    page_id_t child_page_id = left_most ? internal->ValueAt(0) : internal->Lookup(key, comparator_);
+    auto child = buffer_pool_manager_->FetchPageBasic(child_page_id, AccessType::Index);
+    uint64_t child_version;
+    if (!child.IsValid() || !child.TryOptimisticRead(&child_version) || !guard.Validate(version)) {
+      return false;
+    }
+    guard = std::move(child);
+    version = child_version;
+  }
+}
+
 /*
  * Update/Insert root page id in header page(where page_id = 0, header_page is
  * defined under include/page/header_page.h)
@@ -772,7 +845,7 @@ void BPLUSTREE_TYPE::UpdateRootPageId(bool insert_record) {
   if (page == nullptr) {
    // throw Exception(EXCEPTION_TYPE_INDEX,"all page are pinned while UpdateRootPageId");
   }
-  auto *header_page = reinterpret_cast<HeaderPage *>(page->GetData());
+  auto *header_page = static_cast<HeaderPage *>(page);
 
   if (insert_record) {
     // create a new record<index_name + root_page_id> in header_page
@@ -17,10 +17,11 @@ namespace bustub {
  */
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_INDEX_TYPE::
-BPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager,page_id_t root_page_id)
+BPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager,page_id_t root_page_id,
+               tablespace_id_t tablespace)
     : Index(metadata),
       comparator_(metadata->GetKeySchema()),
-      container_(metadata->GetName(), buffer_pool_manager, comparator_,root_page_id) {}
+      container_(metadata->GetName(), buffer_pool_manager, comparator_,root_page_id, tablespace) {}
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
@@ -32,7 +33,7 @@ void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *t
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, Transaction *transaction) {
+void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct delete index key
   KeyType index_key;
   index_key.SetFromKey(key);
@@ -41,12 +42,12 @@ void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, Transaction *transactio
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> &result, Transaction *transaction) {
+void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
   // construct scan index key
   KeyType index_key;
   index_key.SetFromKey(key);
 
-  container_.GetValue(index_key, result, transaction);
+  container_.GetValue(index_key, *result, transaction);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
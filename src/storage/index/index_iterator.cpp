@@ -2,7 +2,9 @@
  * index_iterator.cpp
  */
 #include <cassert>
+#include <utility>
 
+#include "common/exception.h"
 #include "storage/index/index_iterator.h"
 
 namespace bustub {
@@ -12,16 +14,13 @@ namespace bustub {
  * set your own input parameters
  */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::IndexIterator(BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *leaf,
-              int index_, BufferPoolManager *buff_pool_manager) :
-    leaf_(leaf), index_(index_), buff_pool_manager_(buff_pool_manager) {}
-
-INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::~IndexIterator() {
-    buff_pool_manager_->FetchPage(leaf_->GetPageId())->RUnlatch();
-  buff_pool_manager_->UnpinPage(leaf_->GetPageId(), false);
-  buff_pool_manager_->UnpinPage(leaf_->GetPageId(), false);
-};
+INDEXITERATOR_TYPE::IndexIterator(ReadPageGuard guard, int index, BufferPoolManager *buff_pool_manager)
+    : guard_(std::move(guard)), leaf_(nullptr), index_(index), buff_pool_manager_(buff_pool_manager) {
+  if (guard_.IsValid()) {
+    leaf_ = guard_.As<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>>();
+    PrefetchLeaves(leaf_->GetNextPageId());
+  }
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 bool INDEXITERATOR_TYPE::isEnd() { 
@@ -40,30 +39,28 @@ INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() { 
      ++index_;
   if (index_ == leaf_->GetSize() && leaf_->GetNextPageId() != INVALID_PAGE_ID) {
-    // first unpin leaf_, then get the next leaf
-    page_id_t next_page_id = leaf_->GetNextPageId();
-
-    auto *page = buff_pool_manager_->FetchPage(next_page_id);
-    if (page == nullptr) {
-      //throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned while IndexIterator(operator++)");
+    // the next leaf is latched before the assignment releases the current one
+    guard_ = buff_pool_manager_->FetchPageRead(leaf_->GetNextPageId(), AccessType::Index);
+    if (!guard_.IsValid()) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "IndexIterator: all pages are pinned");
     }
-    // first acquire next page, then release previous page
-    page->RLatch();
-
-    buff_pool_manager_->FetchPage(leaf_->GetPageId())->RUnlatch();
-    buff_pool_manager_->UnpinPage(leaf_->GetPageId(), false);
-    buff_pool_manager_->UnpinPage(leaf_->GetPageId(), false);
-
-    auto next_leaf =
-        reinterpret_cast<BPlusTreeLeafPage<KeyType, ValueType,
-                                           KeyComparator> *>(page->GetData());
+    auto next_leaf = guard_.As<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>>();
     assert(next_leaf->IsLeafPage());
     index_ = 0;
     leaf_ = next_leaf;
+    PrefetchLeaves(leaf_->GetNextPageId());
   }
   return *this;
  }
 
+ INDEX_TEMPLATE_ARGUMENTS
+ void INDEXITERATOR_TYPE::PrefetchLeaves(page_id_t page_id) {
+  auto next_leaf_page_id = [](Page *page) {
+    return reinterpret_cast<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *>(page->GetData())->GetNextPageId();
+  };
+  buff_pool_manager_->PrefetchChain(page_id, SCAN_PREFETCH_DEPTH, next_leaf_page_id, AccessType::Index);
+ }
+
  INDEX_TEMPLATE_ARGUMENTS
  bool INDEXITERATOR_TYPE::operator==(const IndexIterator &itr) const {
    if(itr.index_ == index_)return true;
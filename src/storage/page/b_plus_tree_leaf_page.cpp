@@ -100,7 +100,7 @@ KeyAt(int index) const {
  */
 INDEX_TEMPLATE_ARGUMENTS
 const MappingType &B_PLUS_TREE_LEAF_PAGE_TYPE::
-GetItem(int index) {
+GetItem(int index) const {
   // replace with your own code
   assert(0 <= index && index < GetSize());
   return array[index];
@@ -16,10 +16,32 @@
 
 namespace bustub {
 
+/** Reads the id of the next page of a table heap out of a table page. */
+static page_id_t NextTablePageId(Page *page) { return static_cast<TablePage *>(page)->GetNextPageId(); }
+
+/** A page of the heap could not be fetched: end the scan there and abort the transaction, as TableHeap does. */
+static void AbortScan(RID *rid, Transaction *txn) {
+  *rid = RID(INVALID_PAGE_ID, 0);
+  if (txn != nullptr) {
+    txn->SetState(TransactionState::ABORTED);
+  }
+}
+
 TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn)
     : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn) {
   if (rid.GetPageId() != INVALID_PAGE_ID) {
-    table_heap_->GetTuple(tuple_->rid_, tuple_, txn_);
+    BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+    auto page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(rid.GetPageId(), AccessType::Scan));
+    if (page == nullptr) {
+      AbortScan(&tuple_->rid_, txn_);
+      return;
+    }
+    page->RLatch();
+    page->GetTuple(tuple_->rid_, tuple_, txn_, table_heap_->lock_manager_);
+    // Start reading the rest of the heap before we get there.
+    buffer_pool_manager->PrefetchChain(page->GetNextPageId(), SCAN_PREFETCH_DEPTH, NextTablePageId, AccessType::Scan);
+    page->RUnlatch();
+    buffer_pool_manager->UnpinPage(rid.GetPageId(), false);
   }
 }
 
@@ -35,19 +57,30 @@ Tuple *TableIterator::operator->() {
 
 TableIterator &TableIterator::operator++() {
   BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId()));
+  auto cur_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId(), AccessType::Scan));
+  if (cur_page == nullptr) {
+    AbortScan(&tuple_->rid_, txn_);
+    return *this;
+  }
   cur_page->RLatch();
-  assert(cur_page != nullptr);  // all pages are pinned
 
   RID next_tuple_rid;
   if (!cur_page->GetNextTupleRid(tuple_->rid_,
                                  &next_tuple_rid)) {  // end of this page
     while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
+      auto next_page =
+          static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId(), AccessType::Scan));
       cur_page->RUnlatch();
       buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
+      if (next_page == nullptr) {
+        AbortScan(&tuple_->rid_, txn_);
+        return *this;
+      }
       cur_page = next_page;
       cur_page->RLatch();
+      // Keep the next few pages of the chain on their way in while we work through this one.
+      buffer_pool_manager->PrefetchChain(cur_page->GetNextPageId(), SCAN_PREFETCH_DEPTH, NextTablePageId,
+                                         AccessType::Scan);
       if (cur_page->GetFirstTupleRid(&next_tuple_rid)) {
         break;
       }
@@ -55,8 +88,9 @@ TableIterator &TableIterator::operator++() {
   }
   tuple_->rid_ = next_tuple_rid;
 
+  // The tuple lives on cur_page, which is still pinned and latched; no need to go through the buffer pool again.
   if (*this != table_heap_->End()) {
-    table_heap_->GetTuple(tuple_->rid_, tuple_, txn_);
+    cur_page->GetTuple(tuple_->rid_, tuple_, txn_, table_heap_->lock_manager_);
   }
   // release until copy the tuple
   cur_page->RUnlatch();
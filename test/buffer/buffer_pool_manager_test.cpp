@@ -10,10 +10,19 @@
 //
 //===----------------------------------------------------------------------===//
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <fstream>
+#include <iterator>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "common/exception.h"
 #include "gtest/gtest.h"
 
 namespace bustub {
@@ -29,7 +38,7 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
   std::uniform_int_distribution<char> uniform_dist(0);
 
   auto *disk_manager = new DiskManager(db_name);
-  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
 
   page_id_t page_id_temp;
   auto *page0 = bpm->NewPage(&page_id_temp);
@@ -91,7 +100,7 @@ TEST(BufferPoolManagerTest,SampleTest) {
   const size_t buffer_pool_size = 10;
 
   auto *disk_manager = new DiskManager(db_name);
-  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
 
   page_id_t page_id_temp;
   auto *page0 = bpm->NewPage(&page_id_temp);
@@ -133,6 +142,15 @@ TEST(BufferPoolManagerTest,SampleTest) {
   EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
   EXPECT_EQ(nullptr, bpm->FetchPage(0));
 
+  // Scenario: Flushing every page neither drops the pins on them nor leaves pins behind.
+  bpm->FlushAllPages();
+  EXPECT_EQ(nullptr, bpm->FetchPage(0));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  bpm->FlushAllPages();
+  page0 = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
+
   // Shutdown the disk manager and remove the temporary file we created.
   disk_manager->ShutDown();
   remove("test.db");
@@ -141,4 +159,1077 @@ TEST(BufferPoolManagerTest,SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+// Many threads miss on the same page at the same time while other threads keep evicting dirty pages
+TEST(BufferPoolManagerTest, ConcurrentMissTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  const int num_pages = 32;
+  const int num_threads = 16;
+  const int num_rounds = 50;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Every page starts out holding its own id, and more pages exist than fit in the pool.
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  for (int round = 0; round < num_rounds; ++round) {
+    const page_id_t target = round % num_pages;
+    std::atomic<bool> go{false};
+    std::atomic<int> fetched{0};
+    std::vector<Page *> results(num_threads, nullptr);
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads; ++tid) {
+      threads.emplace_back([&, tid] {
+        while (!go) {
+          std::this_thread::yield();
+        }
+        if (tid % 4 == 0) {
+          // Churn: dirty a different page so that misses have to write back their victims.
+          page_id_t other = (target + 1 + tid) % num_pages;
+          auto *page = bpm->FetchPage(other);
+          if (page != nullptr) {
+            page->WLatch();
+            EXPECT_EQ(std::to_string(other), std::string(page->GetData()));
+            page->WUnlatch();
+            EXPECT_TRUE(bpm->UnpinPage(other, true));
+          }
+          return;
+        }
+        results[tid] = bpm->FetchPage(target);
+        fetched++;
+        // Hold the pin until every reader of the target has its page.
+        while (fetched < num_threads - num_threads / 4) {
+          std::this_thread::yield();
+        }
+      });
+    }
+    go = true;
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    // Everyone that asked for the target got the same frame, with the data that was written to disk.
+    Page *expected = nullptr;
+    for (int tid = 0; tid < num_threads; ++tid) {
+      if (tid % 4 == 0) {
+        continue;
+      }
+      ASSERT_NE(nullptr, results[tid]);
+      if (expected == nullptr) {
+        expected = results[tid];
+      }
+      EXPECT_EQ(expected, results[tid]);
+      EXPECT_EQ(target, results[tid]->GetPageId());
+      EXPECT_EQ(std::to_string(target), std::string(results[tid]->GetData()));
+      EXPECT_TRUE(bpm->UnpinPage(target, false));
+    }
+    EXPECT_EQ(0, expected->GetPinCount());
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ScanRingTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 64;
+  const int num_hot_pages = 32;
+  const int num_scan_pages = 256;
+
+  auto *disk_manager = new DiskManager(db_name);
+  {
+    BufferPoolManagerInstance bpm(buffer_pool_size, disk_manager);
+    for (int i = 0; i < num_hot_pages + num_scan_pages; ++i) {
+      page_id_t page_id;
+      ASSERT_NE(nullptr, bpm.NewPage(&page_id));
+      snprintf(bpm.FetchPage(page_id)->GetData(), PAGE_SIZE, "%d", page_id);
+      bpm.UnpinPage(page_id, true);
+      bpm.UnpinPage(page_id, true);
+    }
+    bpm.FlushAllPages();
+  }
+
+  for (auto replacer_type : {ReplacerType::LRU, ReplacerType::CLOCK, ReplacerType::LRUK}) {
+    for (auto scan_access_type : {AccessType::Unknown, AccessType::Scan}) {
+      BufferPoolManagerInstance bpm(buffer_pool_size, disk_manager, nullptr, replacer_type);
+      for (page_id_t page_id = 0; page_id < num_hot_pages; ++page_id) {
+        ASSERT_NE(nullptr, bpm.FetchPage(page_id));
+        bpm.UnpinPage(page_id, false);
+      }
+
+      // Scan a table four times the size of the pool.
+      for (page_id_t page_id = num_hot_pages; page_id < num_hot_pages + num_scan_pages; ++page_id) {
+        auto *page = bpm.FetchPage(page_id, scan_access_type);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(std::to_string(page_id), std::string(page->GetData()));
+        bpm.UnpinPage(page_id, false);
+      }
+
+      // Scenario: without the hint the scan flushes the hot pages out of the pool. With it, the scan stays in its ring
+      // and every hot page is still resident.
+      int reads = disk_manager->GetNumReads();
+      for (page_id_t page_id = 0; page_id < num_hot_pages; ++page_id) {
+        auto *page = bpm.FetchPage(page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(std::to_string(page_id), std::string(page->GetData()));
+        bpm.UnpinPage(page_id, false);
+      }
+      if (scan_access_type == AccessType::Scan) {
+        EXPECT_EQ(reads, disk_manager->GetNumReads());
+      } else {
+        EXPECT_LT(reads, disk_manager->GetNumReads());
+      }
+    }
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, PrefetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 32;
+  const int num_pages = 16;
+
+  // Page i holds the id of the page that follows it in a chain running backwards through the file.
+  auto *disk_manager = new DiskManager(db_name);
+  {
+    BufferPoolManagerInstance bpm(buffer_pool_size, disk_manager);
+    for (int i = 0; i < num_pages; ++i) {
+      page_id_t page_id;
+      auto *page = bpm.NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      *reinterpret_cast<page_id_t *>(page->GetData()) = page_id == 0 ? INVALID_PAGE_ID : page_id - 1;
+      bpm.UnpinPage(page_id, true);
+    }
+    bpm.FlushAllPages();
+  }
+
+  auto wait_for_reads = [disk_manager](int reads) {
+    for (int i = 0; i < 1000 && disk_manager->GetNumReads() < reads; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return disk_manager->GetNumReads();
+  };
+  auto fetch_all = [disk_manager](BufferPoolManager *bpm, page_id_t first, page_id_t last) {
+    int reads = disk_manager->GetNumReads();
+    for (page_id_t page_id = first; page_id <= last; ++page_id) {
+      ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+      bpm->UnpinPage(page_id, false);
+    }
+    EXPECT_EQ(reads, disk_manager->GetNumReads());
+  };
+
+  // Scenario: a prefetched range is resident by the time it is fetched, and stays unpinned until then.
+  {
+    BufferPoolManagerInstance bpm(buffer_pool_size, disk_manager);
+    int reads = disk_manager->GetNumReads();
+    bpm.PrefetchRange(0, 4);
+    EXPECT_EQ(reads + 4, wait_for_reads(reads + 4));
+    // The prefetcher may still be holding the last page for a moment after reading it.
+    bool deleted = false;
+    for (int i = 0; i < 1000 && !deleted; ++i) {
+      deleted = bpm.DeletePage(3);
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_TRUE(deleted);
+    fetch_all(&bpm, 0, 2);
+  }
+
+  // Scenario: a chain is followed from one page to the next, but no further than asked.
+  auto next_page = [](Page *page) { return *reinterpret_cast<page_id_t *>(page->GetData()); };
+  {
+    BufferPoolManagerInstance bpm(buffer_pool_size, disk_manager);
+    int reads = disk_manager->GetNumReads();
+    bpm.PrefetchChain(num_pages - 1, 5, next_page);
+    EXPECT_EQ(reads + 5, wait_for_reads(reads + 5));
+    fetch_all(&bpm, num_pages - 5, num_pages - 1);
+  }
+
+  // Scenario: in a parallel pool the chain crosses from instance to instance.
+  {
+    ParallelBufferPoolManager bpm(4, buffer_pool_size / 4, disk_manager);
+    int reads = disk_manager->GetNumReads();
+    bpm.PrefetchChain(num_pages - 1, num_pages, next_page);
+    EXPECT_EQ(reads + num_pages, wait_for_reads(reads + num_pages));
+    fetch_all(&bpm, 0, num_pages - 1);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, BackgroundWriterTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 16;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Fill the pool with dirty, unpinned pages.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  EXPECT_EQ(0, bpm->GetNumCleanVictims());
+  EXPECT_EQ(0, bpm->GetNumDirtyVictims());
+
+  // Scenario: the background writer cleans half of the evictable frames, lowest page ids first, and then stops.
+  bpm->RunBackgroundWriter(0.5);
+  for (int i = 0; i < 1000 && bpm->GetNumBackgroundWrites() < buffer_pool_size / 2; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  std::this_thread::sleep_for(bgwriter_interval * 3);
+  bpm->StopBackgroundWriter();
+  EXPECT_EQ(buffer_pool_size / 2, bpm->GetNumBackgroundWrites());
+  EXPECT_EQ(static_cast<int>(buffer_pool_size / 2), disk_manager->GetNumWrites());
+
+  // Scenario: the replacement order was not disturbed, so the first victims are exactly the pages that were cleaned.
+  for (size_t i = 0; i < buffer_pool_size / 2; ++i) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(buffer_pool_size / 2, bpm->GetNumCleanVictims());
+  EXPECT_EQ(0, bpm->GetNumDirtyVictims());
+
+  // Scenario: the cleaned pages read back what was written.
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size / 2); ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_LT(0, bpm->GetNumDirtyVictims());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ResizeTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+
+  // Each replacer has to keep finding victims as chunks of frames come and go.
+  for (auto replacer_type : {ReplacerType::LRU, ReplacerType::CLOCK, ReplacerType::LRUK}) {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, replacer_type);
+
+    // Pins new pages until the pool is full, writes their ids into them and returns them.
+    auto fill = [bpm]() {
+      std::vector<page_id_t> page_ids;
+      page_id_t page_id;
+      Page *page;
+      while ((page = bpm->NewPage(&page_id)) != nullptr) {
+        snprintf(page->GetData(), PAGE_SIZE, "%d", page_id);
+        page_ids.push_back(page_id);
+      }
+      return page_ids;
+    };
+    auto unpin = [bpm](const std::vector<page_id_t> &page_ids) {
+      for (auto page_id : page_ids) {
+        EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+      }
+    };
+
+    // Scenario: sizes that are zero or beyond the largest the pool can grow to are rejected.
+    EXPECT_FALSE(bpm->Resize(0));
+    EXPECT_FALSE(bpm->Resize(buffer_pool_size * BUFFER_POOL_MAX_CHUNKS + 1));
+    EXPECT_EQ(buffer_pool_size, bpm->GetPoolSize());
+
+    // Scenario: growing the pool gives it room for more pinned pages, rounded up to whole chunks.
+    ASSERT_TRUE(bpm->Resize(buffer_pool_size * 2 + 1));
+    EXPECT_EQ(buffer_pool_size * 3, bpm->GetPoolSize());
+    auto page_ids = fill();
+    EXPECT_EQ(buffer_pool_size * 3, page_ids.size());
+
+    // Scenario: shrinking the pool while every page is pinned leaves the pages where they are...
+    ASSERT_TRUE(bpm->Resize(buffer_pool_size));
+    EXPECT_EQ(buffer_pool_size, bpm->GetPoolSize());
+    for (auto page_id : page_ids) {
+      auto *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(std::to_string(page_id), std::string(page->GetData()));
+      EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+
+    // ...and once they are unpinned the pool holds no more than its new size.
+    unpin(page_ids);
+    auto new_page_ids = fill();
+    EXPECT_EQ(buffer_pool_size, new_page_ids.size());
+    unpin(new_page_ids);
+
+    // Scenario: the pages that left the pool were written back.
+    for (auto page_id : page_ids) {
+      auto *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(std::to_string(page_id), std::string(page->GetData()));
+      EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+
+    // Scenario: growing the pool again brings back the room.
+    ASSERT_TRUE(bpm->Resize(buffer_pool_size * 2));
+    page_ids = fill();
+    EXPECT_EQ(buffer_pool_size * 2, page_ids.size());
+    unpin(page_ids);
+
+    disk_manager->ShutDown();
+    remove("test.db");
+
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ConcurrentResizeTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  const size_t num_pages = buffer_pool_size * 4;
+  const size_t num_threads = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(2, buffer_pool_size, disk_manager);
+
+  for (size_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: readers keep finding their pages while the pool grows and shrinks underneath them.
+  std::atomic<bool> done{false};
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t] {
+      std::mt19937 gen(t);
+      std::uniform_int_distribution<page_id_t> dis(0, num_pages - 1);
+      while (!done) {
+        page_id_t page_id = dis(gen);
+        auto *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        EXPECT_EQ(std::to_string(page_id), std::string(page->GetData()));
+        EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+      }
+    });
+  }
+  for (int i = 0; i < 50; ++i) {
+    EXPECT_TRUE(bpm->Resize(buffer_pool_size * 2 * (1 + i % 4)));
+    EXPECT_TRUE(bpm->ResizeInstance(i % 2, buffer_pool_size));
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+  }
+  done = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Scenario: a resize that fails leaves every instance as it was.
+  size_t pool_size = bpm->GetPoolSize();
+  EXPECT_FALSE(bpm->Resize(buffer_pool_size * 2 * BUFFER_POOL_MAX_CHUNKS + 2));
+  EXPECT_EQ(pool_size, bpm->GetPoolSize());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, HotSetTest) {
+  const std::string db_name = "test.db";
+  const std::string hot_set_name = "test.db.hot";
+  const size_t buffer_pool_size = 8;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  bpm->SetHotSetFile(hot_set_name);
+
+  // Write twice as many pages as fit, then touch every other one of the first half so that those are the hot set.
+  for (size_t i = 0; i < buffer_pool_size * 2; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  std::vector<page_id_t> hot_pages{6, 4, 2, 0};
+  for (auto it = hot_pages.rbegin(); it != hot_pages.rend(); ++it) {
+    ASSERT_NE(nullptr, bpm->FetchPage(*it));
+    EXPECT_TRUE(bpm->UnpinPage(*it, false));
+  }
+  std::vector<page_id_t> hot_set = bpm->GetHotSet();
+  ASSERT_EQ(buffer_pool_size, hot_set.size());
+  EXPECT_EQ(hot_pages, std::vector<page_id_t>(hot_set.begin(), hot_set.begin() + hot_pages.size()));
+
+  // Scenario: a clean shutdown flushes every page and saves the hot set.
+  delete bpm;
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  EXPECT_EQ(0, bpm->LoadHotSet("no_such_file.hot"));
+  EXPECT_EQ(buffer_pool_size, bpm->LoadHotSet(hot_set_name));
+
+  // Scenario: the hot set is resident with its contents and in its old recency order, so fetching it reads nothing.
+  EXPECT_EQ(hot_set, bpm->GetHotSet());
+  int num_reads = disk_manager->GetNumReads();
+  for (page_id_t page_id : hot_set) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(num_reads, disk_manager->GetNumReads());
+
+  // Scenario: a hot set that lists a page of a tablespace dropped since skips that page and warms up the rest.
+  tablespace_id_t tablespace = bpm->CreateTablespace("");
+  page_id_t dropped_page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&dropped_page_id, tablespace));
+  EXPECT_TRUE(bpm->UnpinPage(dropped_page_id, true));
+  EXPECT_TRUE(bpm->DropTablespace(tablespace));
+  EXPECT_EQ(2, bpm->WarmUp({dropped_page_id, buffer_pool_size * 2 - 1, dropped_page_id, 1}));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.tablespaces");
+  remove(hot_set_name.c_str());
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, FetchPagesTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  for (size_t i = 0; i < buffer_pool_size * 2; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: a batch of hits (8, 9) and misses (0, 1, 2, 5), unsorted and with a page asked for twice, comes back in
+  // the order it was asked for, with each page pinned once per time it was asked for.
+  std::vector<page_id_t> page_ids{5, 8, 1, 9, 0, 5, 2};
+  std::vector<Page *> pages = bpm->FetchPages(page_ids);
+  ASSERT_EQ(page_ids.size(), pages.size());
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    ASSERT_NE(nullptr, pages[i]);
+    EXPECT_EQ(page_ids[i], pages[i]->GetPageId());
+    EXPECT_EQ(std::to_string(page_ids[i]), std::string(pages[i]->GetData()));
+  }
+  EXPECT_EQ(pages[0], pages[5]);
+  EXPECT_EQ(2, pages[0]->GetPinCount());
+  for (auto page_id : page_ids) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: a batch larger than the pool gets as many pages as there are frames.
+  std::vector<page_id_t> all_page_ids;
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size * 2); ++page_id) {
+    all_page_ids.push_back(page_id);
+  }
+  pages = bpm->FetchPages(all_page_ids);
+  size_t num_fetched = 0;
+  for (size_t i = 0; i < pages.size(); ++i) {
+    if (pages[i] != nullptr) {
+      EXPECT_EQ(std::to_string(all_page_ids[i]), std::string(pages[i]->GetData()));
+      EXPECT_TRUE(bpm->UnpinPage(all_page_ids[i], false));
+      num_fetched++;
+    }
+  }
+  EXPECT_EQ(buffer_pool_size, num_fetched);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ConcurrentFetchPagesTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 16;
+  const size_t num_pages = buffer_pool_size * 4;
+  const size_t num_threads = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(2, buffer_pool_size, disk_manager);
+  for (size_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: batches that overlap each other's pages, and evict each other's dirty victims, neither deadlock nor
+  // read stale data.
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t] {
+      std::mt19937 gen(t);
+      std::uniform_int_distribution<page_id_t> dis(0, num_pages - 1);
+      for (int round = 0; round < 200; ++round) {
+        std::vector<page_id_t> page_ids(4);
+        for (auto &page_id : page_ids) {
+          page_id = dis(gen);
+        }
+        std::vector<Page *> pages = bpm->FetchPages(page_ids);
+        for (size_t i = 0; i < page_ids.size(); ++i) {
+          if (pages[i] != nullptr) {
+            EXPECT_EQ(std::to_string(page_ids[i]), std::string(pages[i]->GetData()));
+            EXPECT_TRUE(bpm->UnpinPage(page_ids[i], true));
+          }
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, DeletePageTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(2, buffer_pool_size, disk_manager);
+  std::vector<page_id_t> page_ids(buffer_pool_size * 4);
+  for (auto &page_id : page_ids) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: deleted pages, resident or not, are handed out again by the instance they belong to. Two pages of each
+  // instance are deleted, as new pages go to the instances in turn.
+  std::vector<page_id_t> deleted{page_ids[0], page_ids[1], page_ids[page_ids.size() - 2], page_ids.back()};
+  for (auto page_id : deleted) {
+    EXPECT_TRUE(bpm->DeletePage(page_id));
+    EXPECT_FALSE(disk_manager->IsAllocated(page_id));
+  }
+  std::vector<page_id_t> reused(deleted.size());
+  for (auto &page_id : reused) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  std::sort(reused.begin(), reused.end());
+  EXPECT_EQ(deleted, reused);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, DropTablespaceTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(2, buffer_pool_size, disk_manager);
+  tablespace_id_t tablespace = bpm->CreateTablespace("");
+  std::string file_name = disk_manager->GetTablespaceFile(tablespace);
+
+  // Scenario: new pages of a tablespace go to both instances, and some are evicted, dirty, to its file.
+  std::vector<page_id_t> page_ids(buffer_pool_size * 3);
+  for (auto &page_id : page_ids) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id, tablespace));
+    EXPECT_EQ(tablespace, GetTablespace(page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  EXPECT_EQ(0U, static_cast<uint32_t>(page_ids[0]) % 2);
+  EXPECT_EQ(1U, static_cast<uint32_t>(page_ids[1]) % 2);
+  int num_writes = disk_manager->GetNumWrites();
+  EXPECT_GT(num_writes, 0);
+
+  // Scenario: a pinned page keeps the tablespace from being dropped, and leaves its pages alone in every instance,
+  // including the dirty page of the other instance; once it is unpinned, the dirty pages left in the pool are thrown
+  // away rather than written back.
+  page_id_t dirty_page_id = page_ids[page_ids.size() - 2];
+  auto *page = bpm->FetchPage(dirty_page_id);
+  ASSERT_NE(nullptr, page);
+  snprintf(page->GetData(), PAGE_SIZE, "dirty");
+  EXPECT_TRUE(bpm->UnpinPage(dirty_page_id, true));
+  ASSERT_NE(nullptr, bpm->FetchPage(page_ids.back()));
+  EXPECT_FALSE(bpm->DropTablespace(tablespace));
+  EXPECT_TRUE(std::ifstream(file_name).good());
+  page = bpm->FetchPage(dirty_page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_STREQ("dirty", page->GetData());
+  EXPECT_TRUE(page->IsDirty());
+  EXPECT_TRUE(bpm->UnpinPage(dirty_page_id, false));
+  EXPECT_TRUE(bpm->UnpinPage(page_ids.back(), true));
+  EXPECT_TRUE(bpm->DropTablespace(tablespace));
+  EXPECT_FALSE(std::ifstream(file_name).good());
+
+  // The frames are free for pages of the db file.
+  page_id_t page_id;
+  for (size_t i = 0; i < buffer_pool_size * 2; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(DEFAULT_TABLESPACE, GetTablespace(page_id));
+  }
+  EXPECT_EQ(num_writes, disk_manager->GetNumWrites());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.tablespaces");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, FailedFlushTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  tablespace_id_t tablespace = bpm->CreateTablespace("");
+  page_id_t page_id;
+  page_id_t dropped_page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  ASSERT_NE(nullptr, bpm->NewPage(&dropped_page_id, tablespace));
+  EXPECT_TRUE(bpm->UnpinPage(dropped_page_id, true));
+  // Drop the file behind the pool's back, so that writing the page there fails.
+  disk_manager->DropTablespace(tablespace);
+
+  // Scenario: a flush that fails leaves the pages it did not get out dirty, and unpinned.
+  EXPECT_THROW(bpm->FlushPage(dropped_page_id), Exception);
+  EXPECT_THROW(bpm->FlushAllPages(), Exception);
+  for (page_id_t id : {page_id, dropped_page_id}) {
+    auto *page = bpm->FetchPage(id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_TRUE(page->IsDirty());
+    EXPECT_EQ(1, page->GetPinCount());
+    EXPECT_TRUE(bpm->UnpinPage(id, false));
+  }
+
+  // Scenario: so does the background writer, which keeps running.
+  bpm->RunBackgroundWriter(1.0);
+  std::this_thread::sleep_for(bgwriter_interval * 3);
+  bpm->StopBackgroundWriter();
+  EXPECT_EQ(0, bpm->GetNumBackgroundWrites());
+  for (page_id_t id : {page_id, dropped_page_id}) {
+    auto *page = bpm->FetchPage(id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_TRUE(page->IsDirty());
+    EXPECT_EQ(1, page->GetPinCount());
+    EXPECT_TRUE(bpm->UnpinPage(id, false));
+  }
+
+  // Scenario: a flush of the pages that can still be written succeeds and cleans them.
+  EXPECT_TRUE(bpm->FlushPage(page_id));
+  auto *page = bpm->FetchPage(page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_FALSE(page->IsDirty());
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.tablespaces");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, FailedWriteBackTest) {
+  const std::string db_name = "test.db";
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(1, disk_manager);
+  tablespace_id_t tablespace = bpm->CreateTablespace("");
+  page_id_t page_id;
+  page_id_t victim_page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  auto *page = bpm->NewPage(&victim_page_id, tablespace);
+  ASSERT_NE(nullptr, page);
+  snprintf(page->GetData(), PAGE_SIZE, "victim");
+  EXPECT_TRUE(bpm->UnpinPage(victim_page_id, true));
+  // Drop the file behind the pool's back, so that writing the victim back fails.
+  disk_manager->DropTablespace(tablespace);
+
+  // Scenario: a fetch that cannot write back its victim fails, by FetchPage and FetchPages alike, and the victim
+  // stays in the pool with its changes, dirty and unpinned.
+  EXPECT_THROW(bpm->FetchPage(page_id), Exception);
+  EXPECT_THROW(bpm->FetchPages({page_id}), Exception);
+  // Scenario: so does a new page, which is given up again.
+  page_id_t new_page_id;
+  EXPECT_THROW(bpm->NewPage(&new_page_id), Exception);
+  page = bpm->FetchPage(victim_page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_STREQ("victim", page->GetData());
+  EXPECT_TRUE(page->IsDirty());
+  EXPECT_EQ(1, page->GetPinCount());
+  EXPECT_TRUE(bpm->UnpinPage(victim_page_id, false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.tablespaces");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, FailedRetireTest) {
+  const std::string db_name = "test.db";
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(1, disk_manager);
+  tablespace_id_t tablespace = bpm->CreateTablespace("");
+  ASSERT_TRUE(bpm->Resize(2));
+  std::vector<page_id_t> page_ids(2);
+  for (auto &page_id : page_ids) {
+    auto *page = bpm->NewPage(&page_id, tablespace);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  // Drop the file behind the pool's back, so that writing back the page of the retired chunk fails.
+  disk_manager->DropTablespace(tablespace);
+
+  // Scenario: shrinking the pool cannot write back the page of the chunk that goes, and leaves it where it is, dirty.
+  // Neither can unpinning it later.
+  ASSERT_TRUE(bpm->Resize(1));
+  EXPECT_EQ(1, bpm->GetPoolSize());
+  for (int round = 0; round < 2; ++round) {
+    for (auto page_id : page_ids) {
+      auto *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(std::to_string(page_id), std::string(page->GetData()));
+      EXPECT_TRUE(page->IsDirty());
+      EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.tablespaces");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, NewPageInDroppedTablespaceTest) {
+  const std::string db_name = "test.db";
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(1, disk_manager);
+  page_id_t victim_page_id;
+  auto *page = bpm->NewPage(&victim_page_id);
+  ASSERT_NE(nullptr, page);
+  snprintf(page->GetData(), PAGE_SIZE, "victim");
+  EXPECT_TRUE(bpm->UnpinPage(victim_page_id, true));
+  tablespace_id_t tablespace = bpm->CreateTablespace("");
+  EXPECT_TRUE(bpm->DropTablespace(tablespace));
+
+  // Scenario: a new page in a tablespace that is gone throws, and leaves the only frame to the page it holds.
+  page_id_t page_id;
+  EXPECT_THROW(bpm->NewPage(&page_id, tablespace), Exception);
+  page = bpm->FetchPage(victim_page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(1, page->GetPinCount());
+  EXPECT_EQ(0, strcmp(page->GetData(), "victim"));
+  // The page is pinned, so there is no frame for another one.
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(victim_page_id, page->GetPageId());
+  EXPECT_TRUE(bpm->UnpinPage(victim_page_id, false));
+  EXPECT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.tablespaces");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, FetchPageInDroppedTablespaceTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 2;
+
+  for (bool use_async_disk_manager : {false, true}) {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *async_disk_manager = new AsyncDiskManager(disk_manager);
+    auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+    if (use_async_disk_manager) {
+      bpm->SetAsyncDiskManager(async_disk_manager);
+    }
+    tablespace_id_t tablespace = bpm->CreateTablespace("");
+    page_id_t dropped_page_id;
+    page_id_t other_dropped_page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&dropped_page_id, tablespace));
+    EXPECT_TRUE(bpm->UnpinPage(dropped_page_id, true));
+    ASSERT_NE(nullptr, bpm->NewPage(&other_dropped_page_id, tablespace));
+    EXPECT_TRUE(bpm->UnpinPage(other_dropped_page_id, true));
+    EXPECT_TRUE(bpm->DropTablespace(tablespace));
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+
+    // Scenario: reading a page whose file is gone throws, every time, rather than waiting on a read that never ends.
+    for (int i = 0; i < 2; ++i) {
+      try {
+        bpm->FetchPage(dropped_page_id);
+        ADD_FAILURE() << "a page of a dropped tablespace was handed out";
+      } catch (const Exception &e) {
+        EXPECT_EQ(ExceptionType::OUT_OF_RANGE, e.GetType());
+      }
+    }
+    EXPECT_THROW(bpm->FetchPages({page_id, dropped_page_id, dropped_page_id}), Exception);
+    // Two misses are read as one batch, through the async disk manager if there is one.
+    EXPECT_THROW(bpm->FetchPages({dropped_page_id, other_dropped_page_id}), Exception);
+
+    // Scenario: no pins were left behind, so the whole pool can still be pinned at once.
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    page_id_t other_page_id;
+    EXPECT_NE(nullptr, bpm->NewPage(&other_page_id));
+    EXPECT_EQ(page, bpm->FetchPage(page_id));
+    EXPECT_EQ(2, page->GetPinCount());
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    EXPECT_TRUE(bpm->UnpinPage(other_page_id, false));
+
+    delete bpm;
+    delete async_disk_manager;
+    disk_manager->ShutDown();
+    remove("test.db");
+    remove("test.tablespaces");
+    delete disk_manager;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, AsyncDiskManagerTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 16;
+  const size_t num_pages = buffer_pool_size * 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *async_disk_manager = new AsyncDiskManager(disk_manager);
+  auto *bpm = new ParallelBufferPoolManager(2, buffer_pool_size / 2, disk_manager);
+  bpm->SetAsyncDiskManager(async_disk_manager);
+
+  // Scenario: batches of misses whose victims are dirty write the victims back and read the pages in through the async
+  // disk manager.
+  for (size_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  for (page_id_t first = 0; first < static_cast<page_id_t>(num_pages); first += buffer_pool_size / 2) {
+    std::vector<page_id_t> page_ids;
+    for (page_id_t page_id = first; page_id < first + static_cast<page_id_t>(buffer_pool_size / 2); ++page_id) {
+      page_ids.push_back(page_id);
+    }
+    std::vector<Page *> pages = bpm->FetchPages(page_ids);
+    for (size_t i = 0; i < page_ids.size(); ++i) {
+      ASSERT_NE(nullptr, pages[i]);
+      EXPECT_EQ(std::to_string(page_ids[i]), std::string(pages[i]->GetData()));
+      EXPECT_TRUE(bpm->UnpinPage(page_ids[i], true));
+    }
+  }
+
+  // Scenario: the background writers write their batches through it too.
+  int writes = disk_manager->GetNumWrites();
+  bpm->RunBackgroundWriter(1.0);
+  for (int i = 0; i < 1000 && disk_manager->GetNumWrites() < writes + static_cast<int>(buffer_pool_size); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  bpm->StopBackgroundWriter();
+  EXPECT_EQ(writes + static_cast<int>(buffer_pool_size), disk_manager->GetNumWrites());
+
+  delete bpm;
+  delete async_disk_manager;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, CorruptPageTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const page_id_t num_pages = buffer_pool_size * 4;
+
+  for (bool use_async_disk_manager : {false, true}) {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *async_disk_manager = new AsyncDiskManager(disk_manager);
+    auto *bpm = new ParallelBufferPoolManager(2, buffer_pool_size, disk_manager);
+    if (use_async_disk_manager) {
+      bpm->SetAsyncDiskManager(async_disk_manager);
+    }
+    for (page_id_t i = 0; i < num_pages; ++i) {
+      page_id_t page_id;
+      auto *page = bpm->NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "page %d|", page_id);
+      EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+    bpm->FlushAllPages();
+    // Push every page out of the pool, then damage page 5 on disk.
+    for (page_id_t page_id = num_pages - 2 * buffer_pool_size; page_id < num_pages; ++page_id) {
+      ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+      EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+    {
+      std::fstream file(db_name, std::ios::binary | std::ios::in | std::ios::out);
+      std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+      file.seekp(contents.find("page 5|"));
+      file.put('x');
+    }
+
+    // Scenario: fetching the damaged page throws, every time, alone or as part of a batch.
+    for (int i = 0; i < 2; ++i) {
+      try {
+        bpm->FetchPage(5);
+        ADD_FAILURE() << "page 5 was handed out";
+      } catch (const Exception &e) {
+        EXPECT_EQ(ExceptionType::CORRUPTION, e.GetType());
+      }
+    }
+    EXPECT_THROW(bpm->FetchPages({4, 5, 6, 7, 5}), Exception);
+
+    // Scenario: no pins were left behind, so the whole pool can still be pinned at once.
+    std::vector<page_id_t> page_ids{0, 1, 2, 3, 4, 6, 7, 9};
+    std::vector<Page *> pages = bpm->FetchPages(page_ids);
+    for (size_t i = 0; i < page_ids.size(); ++i) {
+      ASSERT_NE(nullptr, pages[i]);
+      EXPECT_EQ("page " + std::to_string(page_ids[i]) + "|", std::string(pages[i]->GetData()));
+    }
+    for (auto page_id : page_ids) {
+      EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+
+    delete bpm;
+    delete async_disk_manager;
+    disk_manager->ShutDown();
+    remove("test.db");
+    delete disk_manager;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, PrefetchCorruptPageTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  const page_id_t num_pages = buffer_pool_size * 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d|", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  bpm->FlushAllPages();
+  // Push pages 0 to 7 out of the pool, then damage page 5 on disk.
+  for (page_id_t page_id = buffer_pool_size; page_id < num_pages; ++page_id) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  {
+    std::fstream file(db_name, std::ios::binary | std::ios::in | std::ios::out);
+    std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    file.seekp(contents.find("page 5|"));
+    file.put('x');
+  }
+
+  // Scenario: reading ahead over the damaged page, alone, in a batch or along a chain, drops the request instead of
+  // taking the process down. Page 0 is queued after the chain, so once it has been read the chain has been tried.
+  auto wait_for_reads = [disk_manager](int reads) {
+    for (int i = 0; i < 1000 && disk_manager->GetNumReads() < reads; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return disk_manager->GetNumReads();
+  };
+  int reads = disk_manager->GetNumReads();
+  bpm->PrefetchPage(5);
+  EXPECT_LE(reads + 1, wait_for_reads(reads + 1));
+  bpm->PrefetchRange(4, 4);
+  EXPECT_LE(reads + 5, wait_for_reads(reads + 5));
+  bpm->PrefetchChain(7, 3, [](Page *page) { return page->GetPageId() - 1; });
+  bpm->PrefetchPage(0);
+  EXPECT_LE(reads + 7, wait_for_reads(reads + 7));
+
+  // Scenario: the damaged page is still reported to whoever fetches it.
+  try {
+    bpm->FetchPage(5);
+    ADD_FAILURE() << "page 5 was handed out";
+  } catch (const Exception &e) {
+    EXPECT_EQ(ExceptionType::CORRUPTION, e.GetType());
+  }
+
+  // Scenario: the dropped requests left no pins behind, so the whole pool can be pinned at once.
+  std::vector<page_id_t> page_ids{0, 1, 2, 3, 4, 6, 7, 8};
+  for (auto page_id : page_ids) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id) + "|", std::string(page->GetData()));
+  }
+  for (auto page_id : page_ids) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
 }  // namespace bustub
@@ -0,0 +1,130 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats_test.cpp
+//
+// Identification: test/buffer/buffer_pool_stats_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_stats.h"
+
+#include <cstdio>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(BufferPoolStatsTest, CountersTest) {
+  BufferPoolCounters counters;
+  const size_t num_threads = 8;
+  const size_t num_adds = 10000;
+
+  // Scenario: counts from many threads, which land on different shards, add up.
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&] {
+      for (size_t i = 0; i < num_adds; ++i) {
+        counters.Add(BufferPoolCounter::HITS);
+        counters.Add(BufferPoolCounter::LATCH_HOLD_NS, 2);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_threads * num_adds, counters.Get(BufferPoolCounter::HITS));
+  EXPECT_EQ(2 * num_threads * num_adds, counters.Get(BufferPoolCounter::LATCH_HOLD_NS));
+  EXPECT_EQ(0, counters.Get(BufferPoolCounter::MISSES));
+
+  // Scenario: a timed mutex counts its acquisitions.
+  TimedMutex mutex(&counters);
+  { std::scoped_lock lk{mutex}; }
+  ASSERT_TRUE(mutex.try_lock());
+  mutex.unlock();
+  EXPECT_EQ(2, counters.Get(BufferPoolCounter::LATCH_ACQUISITIONS));
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolStatsTest, PageHeatTest) {
+  PageHeatMap heat;
+  heat.Record(1);
+  EXPECT_TRUE(heat.GetHottest(10).empty());
+
+  // Scenario: with every fetch sampled, the counts are exact and the hottest page comes first.
+  heat.SetSampleRate(1);
+  for (int i = 0; i < 5; ++i) {
+    heat.Record(7);
+  }
+  heat.Record(3);
+  heat.Record(3);
+  heat.Record(9);
+  auto hottest = heat.GetHottest(2);
+  ASSERT_EQ(2, hottest.size());
+  EXPECT_EQ(std::make_pair(7, uint64_t{5}), hottest[0]);
+  EXPECT_EQ(std::make_pair(3, uint64_t{2}), hottest[1]);
+
+  // Scenario: sampling one in four counts each sample four times over.
+  heat.SetSampleRate(4);
+  for (int i = 0; i < 400; ++i) {
+    heat.Record(11);
+  }
+  hottest = heat.GetHottest(10);
+  ASSERT_EQ(1, hottest.size());
+  EXPECT_EQ(std::make_pair(11, uint64_t{400}), hottest[0]);
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolStatsTest, BufferPoolTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(2, buffer_pool_size, disk_manager);
+  bpm->SetPageHeatSampling(1);
+
+  // Twice as many pages as fit, all dirty, so that the second half evicts the first.
+  for (size_t i = 0; i < buffer_pool_size * 4; ++i) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  BufferPoolStats stats = bpm->GetStats();
+  EXPECT_EQ(0, stats.hits_ + stats.misses_);
+  EXPECT_EQ(buffer_pool_size * 2, stats.evictions_);
+  EXPECT_EQ(buffer_pool_size * 2, stats.dirty_write_backs_);
+  EXPECT_LT(0, stats.latch_acquisitions_);
+
+  // Scenario: page 15 is still in the pool, page 0 is not; page 15 is fetched most.
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(15));
+    EXPECT_TRUE(bpm->UnpinPage(15, false));
+  }
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+  stats = bpm->GetStats(1);
+  EXPECT_EQ(3, stats.hits_);
+  EXPECT_EQ(1, stats.misses_);
+  EXPECT_DOUBLE_EQ(0.75, stats.HitRatio());
+  EXPECT_EQ(buffer_pool_size * 2 + 1, stats.evictions_);
+  ASSERT_EQ(1, stats.hot_pages_.size());
+  EXPECT_EQ(std::make_pair(15, uint64_t{3}), stats.hot_pages_[0]);
+  EXPECT_NE(std::string::npos, stats.ToString().find("hits: 3"));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -0,0 +1,72 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena_test.cpp
+//
+// Identification: test/buffer/frame_arena_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(FrameArenaTest, SampleTest) {
+  const size_t num_frames = 1000;
+  FrameArena arena(num_frames);
+  EXPECT_EQ(num_frames, arena.GetNumFrames());
+
+  // An arena of more than a huge page starts on a huge page boundary. Its frames are contiguous and start out zeroed.
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(arena.GetFrameData(0)) % FrameArena::HUGE_PAGE_SIZE);
+  for (size_t i = 0; i < num_frames; ++i) {
+    char *data = arena.GetFrameData(i);
+    EXPECT_EQ(arena.GetFrameData(0) + i * PAGE_SIZE, data);
+    EXPECT_EQ(0, data[0]);
+    EXPECT_EQ(0, data[PAGE_SIZE - 1]);
+  }
+
+  // Every byte of every frame is usable.
+  for (size_t i = 0; i < num_frames; ++i) {
+    memset(arena.GetFrameData(i), static_cast<int>(i % 128), PAGE_SIZE);
+  }
+  for (size_t i = 0; i < num_frames; ++i) {
+    EXPECT_EQ(static_cast<char>(i % 128), arena.GetFrameData(i)[0]);
+    EXPECT_EQ(static_cast<char>(i % 128), arena.GetFrameData(i)[PAGE_SIZE - 1]);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(FrameArenaTest, BufferPoolTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // The frames of a pool hand out consecutive, non-overlapping blocks of one arena.
+  Page *pages = bpm->GetPages();
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(pages[0].GetData() + i * PAGE_SIZE, pages[i].GetData());
+  }
+  // A pool this small does not get huge pages, but its frames are still page aligned.
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(pages[0].GetData()) % PAGE_SIZE);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
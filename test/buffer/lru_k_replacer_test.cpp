@@ -0,0 +1,184 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer_test.cpp
+//
+// Identification: test/buffer/lru_k_replacer_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/lru_k_replacer.h"
+
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer lru_k_replacer(7, 2);
+
+  // Scenario: access six frames once each and unpin them. Frame 1 is then accessed a second time.
+  for (frame_id_t frame_id = 1; frame_id <= 6; ++frame_id) {
+    lru_k_replacer.RecordAccess(frame_id);
+    lru_k_replacer.Unpin(frame_id);
+  }
+  lru_k_replacer.RecordAccess(1);
+  EXPECT_EQ(6, lru_k_replacer.Size());
+
+  // Scenario: frames seen only once have an infinite backward k-distance and go first, oldest access first.
+  int value;
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(3, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(4, value);
+  EXPECT_EQ(3, lru_k_replacer.Size());
+
+  // Scenario: pinning 4 has no effect since it is already gone. Frame 5 is pinned, accessed again and unpinned.
+  lru_k_replacer.Pin(4);
+  lru_k_replacer.Pin(5);
+  EXPECT_EQ(2, lru_k_replacer.Size());
+  lru_k_replacer.RecordAccess(5);
+  lru_k_replacer.Unpin(5);
+  EXPECT_EQ(3, lru_k_replacer.Size());
+
+  // Scenario: 6 still has a single access. Between 1 and 5, whose second most recent access is older goes first.
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(6, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(5, value);
+  EXPECT_EQ(0, lru_k_replacer.Size());
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+
+  // Scenario: a removed frame forgets its history and comes back as a cold frame.
+  lru_k_replacer.RecordAccess(1);
+  lru_k_replacer.RecordAccess(1);
+  lru_k_replacer.Unpin(1);
+  lru_k_replacer.RecordAccess(2);
+  lru_k_replacer.Unpin(2);
+  lru_k_replacer.Remove(1);
+  EXPECT_EQ(1, lru_k_replacer.Size());
+  lru_k_replacer.RecordAccess(1);
+  lru_k_replacer.Unpin(1);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+}
+
+/**
+ * Point lookups on a small hot set interleaved with sequential scans over a table several times larger than the pool,
+ * run once per replacement policy, with and without the scan access hint. Reports the hit ratio of the lookups and of
+ * all fetches.
+ */
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, ScanResistanceBenchmark) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 64;
+  const int num_hot_pages = 48;
+  const int num_scan_pages = 1024;
+  const int num_rounds = 20;
+  const int lookups_per_round = 500;
+  const int scan_pages_per_round = 256;
+
+  auto *disk_manager = new DiskManager(db_name);
+  {
+    BufferPoolManagerInstance bpm(buffer_pool_size, disk_manager);
+    for (int i = 0; i < num_hot_pages + num_scan_pages; ++i) {
+      page_id_t page_id;
+      ASSERT_NE(nullptr, bpm.NewPage(&page_id));
+      bpm.UnpinPage(page_id, true);
+    }
+    bpm.FlushAllPages();
+  }
+
+  // The first three run the scans without an access hint; the others fetch scanned pages with AccessType::Scan.
+  const std::vector<std::tuple<std::string, ReplacerType, AccessType>> policies = {
+      {"LRU", ReplacerType::LRU, AccessType::Unknown},
+      {"CLOCK", ReplacerType::CLOCK, AccessType::Unknown},
+      {"LRU-K", ReplacerType::LRUK, AccessType::Unknown},
+      {"LRU+ring", ReplacerType::LRU, AccessType::Scan},
+      {"CLOCK+ring", ReplacerType::CLOCK, AccessType::Scan},
+      {"LRU-K+ring", ReplacerType::LRUK, AccessType::Scan}};
+  std::vector<double> lookup_hit_ratios;
+  std::cout << "policy\t\tlookup hit ratio\toverall hit ratio" << std::endl;
+  for (const auto &[name, replacer_type, scan_access_type] : policies) {
+    BufferPoolManagerInstance bpm(buffer_pool_size, disk_manager, nullptr, replacer_type);
+    std::default_random_engine rng(0);
+    std::uniform_int_distribution<page_id_t> hot_dist(0, num_hot_pages - 1);
+    int lookups = 0;
+    int lookup_misses = 0;
+    int fetches = 0;
+    int reads_before = disk_manager->GetNumReads();
+    page_id_t scan_cursor = 0;
+
+    auto fetch = [&](page_id_t page_id, AccessType access_type) {
+      ASSERT_NE(nullptr, bpm.FetchPage(page_id, access_type));
+      bpm.UnpinPage(page_id, false);
+      fetches++;
+    };
+    for (int round = 0; round < num_rounds; ++round) {
+      for (int i = 0; i < lookups_per_round; ++i) {
+        int reads = disk_manager->GetNumReads();
+        fetch(hot_dist(rng), AccessType::Lookup);
+        lookups++;
+        lookup_misses += disk_manager->GetNumReads() - reads;
+      }
+      for (int i = 0; i < scan_pages_per_round; ++i) {
+        fetch(num_hot_pages + scan_cursor, scan_access_type);
+        scan_cursor = (scan_cursor + 1) % num_scan_pages;
+      }
+    }
+
+    int misses = disk_manager->GetNumReads() - reads_before;
+    double lookup_hit_ratio = 1.0 - static_cast<double>(lookup_misses) / lookups;
+    double hit_ratio = 1.0 - static_cast<double>(misses) / fetches;
+    lookup_hit_ratios.push_back(lookup_hit_ratio);
+    std::cout << name << (name.size() < 8 ? "\t\t" : "\t") << lookup_hit_ratio << "\t\t\t" << hit_ratio << std::endl;
+  }
+
+  // The scans are too large to ever hit, so the best any policy can do is keep the hot set resident through them.
+  EXPECT_GT(lookup_hit_ratios[2], lookup_hit_ratios[0]);
+  // With the scan hint the scans never leave their ring, whatever the policy.
+  EXPECT_GT(lookup_hit_ratios[3], lookup_hit_ratios[0]);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, RecencyOrderTest) {
+  LRUKReplacer lru_replacer(7, 2);
+  for (frame_id_t frame_id : {1, 2, 3, 4, 1, 3, 3}) {
+    lru_replacer.RecordAccess(frame_id);
+  }
+  for (frame_id_t frame_id = 1; frame_id <= 4; ++frame_id) {
+    lru_replacer.Unpin(frame_id);
+  }
+
+  // Scenario: frames with k accesses come first, the most recent k-th access first, and the order is the reverse of
+  // the victim order.
+  std::vector<frame_id_t> order = lru_replacer.GetRecencyOrder();
+  EXPECT_EQ((std::vector<frame_id_t>{3, 1, 4, 2}), order);
+  for (auto it = order.rbegin(); it != order.rend(); ++it) {
+    frame_id_t value;
+    ASSERT_TRUE(lru_replacer.Victim(&value));
+    EXPECT_EQ(*it, value);
+  }
+}
+
+}  // namespace bustub
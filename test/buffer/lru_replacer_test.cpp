@@ -59,4 +59,25 @@ TEST(LRUReplacerTest, SampleTest) {
   EXPECT_EQ(4, value);
 }
 
+// NOLINTNEXTLINE
+TEST(LRUReplacerTest, RecencyOrderTest) {
+  LRUReplacer lru_replacer(7);
+  lru_replacer.Unpin(1);
+  lru_replacer.Unpin(2);
+  lru_replacer.Unpin(3);
+  lru_replacer.Unpin(4);
+  lru_replacer.Pin(2);
+  lru_replacer.Unpin(2);
+
+  // Scenario: the most recently unpinned frame comes first, and the order is the reverse of the victim order.
+  std::vector<frame_id_t> order = lru_replacer.GetRecencyOrder();
+  EXPECT_EQ((std::vector<frame_id_t>{2, 4, 3, 1}), order);
+  for (auto it = order.rbegin(); it != order.rend(); ++it) {
+    frame_id_t value;
+    ASSERT_TRUE(lru_replacer.Victim(&value));
+    EXPECT_EQ(*it, value);
+  }
+  EXPECT_TRUE(lru_replacer.GetRecencyOrder().empty());
+}
+
 }  // namespace bustub
@@ -0,0 +1,253 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// mmap_buffer_pool_manager_test.cpp
+//
+// Identification: test/buffer/mmap_buffer_pool_manager_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/mmap_buffer_pool_manager.h"
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/exception.h"
+#include "concurrency/transaction.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/** Remove the files a test database may have left behind. */
+static void RemoveDatabase() {
+  for (const char *file_name : {"test.db", "test.log", "test.tablespaces", "test.1.db", "test.db.slots",
+                                "test.db.slotmap"}) {
+    remove(file_name);
+  }
+}
+
+/**
+ * Write num_pages pages holding "page <id>|" to test.db through a buffer pool, and one such page to a tablespace.
+ * @return the id of the page in the tablespace
+ */
+static page_id_t WriteDatabase(page_id_t num_pages) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(10, disk_manager);
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    EXPECT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d|", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  tablespace_id_t tablespace = bpm->CreateTablespace("");
+  page_id_t tablespace_page_id;
+  auto *page = bpm->NewPage(&tablespace_page_id, tablespace);
+  EXPECT_NE(nullptr, page);
+  snprintf(page->GetData(), PAGE_SIZE, "page %d|", tablespace_page_id);
+  EXPECT_TRUE(bpm->UnpinPage(tablespace_page_id, true));
+  bpm->FlushAllPages();
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+  return tablespace_page_id;
+}
+
+// NOLINTNEXTLINE
+TEST(MmapBufferPoolManagerTest, SampleTest) {
+  const page_id_t num_pages = 20;
+  RemoveDatabase();
+  page_id_t tablespace_page_id = WriteDatabase(num_pages);
+  {
+    // A page that is allocated but never written lies past the end of the file.
+    DiskManager disk_manager("test.db");
+    EXPECT_EQ(num_pages, disk_manager.AllocatePage());
+    disk_manager.ShutDown();
+  }
+
+  auto *bpm = new MmapBufferPoolManager("test.db");
+  EXPECT_EQ(num_pages + 2, bpm->GetPoolSize());
+
+  // Scenario: every page reads back, straight out of the mapping, where consecutive pages lie next to each other.
+  std::vector<Page *> pages;
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(page_id, page->GetPageId());
+    EXPECT_EQ("page " + std::to_string(page_id) + "|", std::string(page->GetData()));
+    if (!pages.empty()) {
+      EXPECT_EQ(pages.back()->GetData() + PAGE_SIZE, page->GetData());
+    }
+    pages.push_back(page);
+  }
+  auto *page = bpm->FetchPage(tablespace_page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ("page " + std::to_string(tablespace_page_id) + "|", std::string(page->GetData()));
+  EXPECT_TRUE(bpm->UnpinPage(tablespace_page_id, false));
+
+  // Scenario: the page past the end of the file reads as zeros; pages beyond it do not exist.
+  page = bpm->FetchPage(num_pages);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(std::string(PAGE_SIZE, '\0'), std::string(page->GetData(), PAGE_SIZE));
+  EXPECT_TRUE(bpm->UnpinPage(num_pages, false));
+  EXPECT_EQ(nullptr, bpm->FetchPage(num_pages + 1));
+  EXPECT_EQ(nullptr, bpm->FetchPage(MakePageId(5, 0)));
+
+  // Scenario: pins are counted, and a page that is not pinned cannot be unpinned.
+  EXPECT_EQ(pages[3], bpm->FetchPage(3));
+  EXPECT_EQ(2, pages[3]->GetPinCount());
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  EXPECT_TRUE(bpm->UnpinPage(3, false));
+  EXPECT_FALSE(bpm->UnpinPage(3, false));
+
+  // Scenario: nothing can be written. There is nothing to flush either.
+  page_id_t page_id;
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+  EXPECT_FALSE(bpm->DeletePage(0));
+  EXPECT_TRUE(bpm->FlushPage(0));
+  EXPECT_FALSE(bpm->FlushPage(num_pages + 1));
+  bpm->FlushAllPages();
+  EXPECT_THROW(bpm->CreateTablespace(""), Exception);
+  EXPECT_FALSE(bpm->DropTablespace(GetTablespace(tablespace_page_id)));
+  EXPECT_FALSE(bpm->Resize(10));
+
+  // Scenario: the first fetch of a page is a miss, later ones are hits.
+  BufferPoolStats stats = bpm->GetStats();
+  EXPECT_EQ(num_pages + 2, stats.misses_);
+  EXPECT_EQ(1, stats.hits_);
+
+  delete bpm;
+  RemoveDatabase();
+}
+
+// NOLINTNEXTLINE
+TEST(MmapBufferPoolManagerTest, CorruptPageTest) {
+  RemoveDatabase();
+  WriteDatabase(8);
+  {
+    std::fstream file("test.db", std::ios::binary | std::ios::in | std::ios::out);
+    std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    file.seekp(contents.find("page 5|"));
+    file.put('x');
+  }
+
+  // Scenario: fetching the damaged page throws, every time, and leaves no pin behind; other pages are fine.
+  auto *bpm = new MmapBufferPoolManager("test.db");
+  for (int i = 0; i < 2; ++i) {
+    try {
+      bpm->FetchPage(5);
+      ADD_FAILURE() << "page 5 was handed out";
+    } catch (const Exception &e) {
+      EXPECT_EQ(ExceptionType::CORRUPTION, e.GetType());
+    }
+  }
+  EXPECT_FALSE(bpm->UnpinPage(5, false));
+  ASSERT_NE(nullptr, bpm->FetchPage(4));
+  EXPECT_TRUE(bpm->UnpinPage(4, false));
+  delete bpm;
+
+  // Scenario: a compressed database cannot be mapped.
+  RemoveDatabase();
+  {
+    DiskManager disk_manager("test.db", false, true);
+    disk_manager.ShutDown();
+  }
+  EXPECT_THROW(MmapBufferPoolManager("test.db"), Exception);
+  RemoveDatabase();
+}
+
+// NOLINTNEXTLINE
+TEST(MmapBufferPoolManagerTest, TableHeapTest) {
+  Schema schema{std::vector<Column>{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 100}}};
+  const int num_tuples = 2000;
+  RemoveDatabase();
+  auto *transaction = new Transaction(0);
+  page_id_t first_page_id;
+  {
+    auto *disk_manager = new DiskManager("test.db");
+    auto *bpm = new BufferPoolManagerInstance(10, disk_manager);
+    auto *table = new TableHeap(bpm, nullptr, nullptr, transaction);
+    for (int i = 0; i < num_tuples; ++i) {
+      std::vector<Value> values{ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::string(50, 'x'))};
+      RID rid;
+      ASSERT_TRUE(table->InsertTuple(Tuple(values, &schema), &rid, transaction));
+    }
+    first_page_id = table->GetFirstPageId();
+    bpm->FlushAllPages();
+    delete table;
+    delete bpm;
+    disk_manager->ShutDown();
+    delete disk_manager;
+  }
+
+  // Scenario: a table written through a buffer pool scans the same through the mapping.
+  auto *bpm = new MmapBufferPoolManager("test.db");
+  auto *table = new TableHeap(bpm, nullptr, nullptr, first_page_id);
+  int num_scanned = 0;
+  for (auto it = table->Begin(transaction); it != table->End(); ++it) {
+    EXPECT_EQ(num_scanned, it->GetValue(&schema, 0).GetAs<int32_t>());
+    num_scanned++;
+  }
+  EXPECT_EQ(num_tuples, num_scanned);
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(bpm->GetPoolSize()); ++page_id) {
+    EXPECT_FALSE(bpm->UnpinPage(page_id, false));
+  }
+
+  delete table;
+  delete bpm;
+  delete transaction;
+  RemoveDatabase();
+}
+
+// NOLINTNEXTLINE
+TEST(MmapBufferPoolManagerTest, ScanBenchmark) {
+  const page_id_t num_pages = 5000;
+  const size_t pool_size = 1000;
+  RemoveDatabase();
+  WriteDatabase(num_pages);
+
+  // Fetch every page once, as a scan would, and then every page of the last pool_size once more.
+  auto scan = [&](BufferPoolManager *bpm) {
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < 2; ++round) {
+      for (page_id_t page_id = round * (num_pages - pool_size); page_id < num_pages; ++page_id) {
+        auto *page = bpm->FetchPage(page_id);
+        EXPECT_NE(nullptr, page);
+        EXPECT_EQ('p', page->GetData()[0]);
+        bpm->UnpinPage(page_id, false);
+      }
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  };
+
+  auto *disk_manager = new DiskManager("test.db");
+  auto *pool = new BufferPoolManagerInstance(pool_size, disk_manager);
+  double pool_ms = scan(pool);
+  delete pool;
+  disk_manager->ShutDown();
+  delete disk_manager;
+
+  auto *mapped = new MmapBufferPoolManager("test.db");
+  double mapped_ms = scan(mapped);
+  delete mapped;
+
+  std::cout << "scan of " << num_pages << " pages, then the last " << pool_size << " again: buffer pool of "
+            << pool_size << " frames " << pool_ms << " ms, mapped " << mapped_ms << " ms" << std::endl;
+  RemoveDatabase();
+}
+
+}  // namespace bustub
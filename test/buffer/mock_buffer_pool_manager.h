@@ -16,18 +16,18 @@
 #include <unordered_map>
 
 #include "../test/buffer/counter.h"
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 
 namespace bustub {
 
 // Add callback functions on BufferPoolManager
-class MockBufferPoolManager : public BufferPoolManager {
+class MockBufferPoolManager : public BufferPoolManagerInstance {
  public:
   enum class CallbackType { BEFORE, AFTER };
   using bufferpool_callback_fn = void (MockBufferPoolManager::*)(enum CallbackType type, FuncType func_type);
 
-  MockBufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr)
-      : BufferPoolManager(pool_size, disk_manager, log_manager) {}
+  MockBufferPoolManager(size_t pool_size, DiskInterface *disk_manager, LogManager *log_manager = nullptr)
+      : BufferPoolManagerInstance(pool_size, disk_manager, log_manager) {}
 
   void counter_callback(enum CallbackType type, FuncType func_type) {
     if (type == CallbackType::BEFORE) {
@@ -59,7 +59,7 @@ class MockBufferPoolManager : public BufferPoolManager {
   /** Grading function. Do not modify/call! */
   Page *FetchPage(page_id_t page_id, bufferpool_callback_fn callback = &MockBufferPoolManager::counter_callback) {
     GradingCallback(callback, CallbackType::BEFORE, FuncType::FetchPage, page_id);
-    auto *result = FetchPageImpl(page_id);
+    auto *result = FetchPageImpl(page_id, AccessType::Unknown);
     GradingCallback(callback, CallbackType::AFTER, FuncType::FetchPage, page_id);
     return result;
   }
@@ -122,11 +122,12 @@ class MockBufferPoolManager : public BufferPoolManager {
   /**
    * Fetch the requested page from the buffer pool.
    * @param page_id id of page to be fetched
+   * @param access_type how the page is accessed
    * @return the requested page
    */
-  Page *FetchPageImpl(page_id_t page_id) {
+  Page *FetchPageImpl(page_id_t page_id, AccessType access_type) override {
     counter.AddCount(FuncType::FetchPage);
-    return BufferPoolManager::FetchPageImpl(page_id);
+    return BufferPoolManagerInstance::FetchPageImpl(page_id, access_type);
   }
 
   /**
@@ -137,7 +138,7 @@ class MockBufferPoolManager : public BufferPoolManager {
    */
   bool UnpinPageImpl(page_id_t page_id, bool is_dirty) {
     counter.AddCount(FuncType::UnpinPage);
-    return BufferPoolManager::UnpinPageImpl(page_id, is_dirty);
+    return BufferPoolManagerInstance::UnpinPageImpl(page_id, is_dirty);
   }
 
   /**
@@ -147,7 +148,7 @@ class MockBufferPoolManager : public BufferPoolManager {
    */
   bool FlushPageImpl(page_id_t page_id) {
     counter.AddCount(FuncType::FlushPage);
-    return BufferPoolManager::FlushPageImpl(page_id);
+    return BufferPoolManagerInstance::FlushPageImpl(page_id);
   }
 
   /**
@@ -157,7 +158,7 @@ class MockBufferPoolManager : public BufferPoolManager {
    */
   Page *NewPageImpl(page_id_t *page_id) {
     counter.AddCount(FuncType::NewPage);
-    return BufferPoolManager::NewPageImpl(page_id);
+    return BufferPoolManagerInstance::NewPageImpl(page_id);
   }
 
   /**
@@ -167,7 +168,7 @@ class MockBufferPoolManager : public BufferPoolManager {
    */
   bool DeletePageImpl(page_id_t page_id) {
     counter.AddCount(FuncType::DeletePage);
-    return BufferPoolManager::DeletePageImpl(page_id);
+    return BufferPoolManagerInstance::DeletePageImpl(page_id);
   }
 
   /**
@@ -175,7 +176,7 @@ class MockBufferPoolManager : public BufferPoolManager {
    */
   void FlushAllPagesImpl() {
     counter.AddCount(FuncType::FlushAllPages);
-    BufferPoolManager::FlushAllPagesImpl();
+    BufferPoolManagerInstance::FlushAllPagesImpl();
   }
 
   // For grading. Do not modify!
@@ -185,7 +186,7 @@ class MockBufferPoolManager : public BufferPoolManager {
   /** Array of buffer pool pages. */
   Page *pages_;
   /** Pointer to the disk manager. */
-  DiskManager *disk_manager_ __attribute__((__unused__));
+  DiskInterface *disk_manager_ __attribute__((__unused__));
   /** Pointer to the log manager. */
   LogManager *log_manager_ __attribute__((__unused__));
   /** Page table for keeping track of buffer pool pages. */
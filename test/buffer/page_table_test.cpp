@@ -0,0 +1,136 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table_test.cpp
+//
+// Identification: test/buffer/page_table_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+#include <atomic>
+#include <map>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(PageTableTest, SampleTest) {
+  PageTable page_table(4);
+  frame_id_t frame_id;
+  EXPECT_FALSE(page_table.Find(1, &frame_id));
+
+  page_table.Insert(1, 0);
+  page_table.Insert(5, 1);
+  page_table.Insert(9, 2);
+  EXPECT_EQ(3, page_table.Size());
+  ASSERT_TRUE(page_table.Find(5, &frame_id));
+  EXPECT_EQ(1, frame_id);
+
+  // Erasing an entry keeps the ones around it reachable, and erasing a missing page is a no-op.
+  page_table.Erase(5);
+  page_table.Erase(5);
+  page_table.Erase(INVALID_PAGE_ID);
+  EXPECT_EQ(2, page_table.Size());
+  EXPECT_FALSE(page_table.Find(5, &frame_id));
+  ASSERT_TRUE(page_table.Find(1, &frame_id));
+  EXPECT_EQ(0, frame_id);
+  ASSERT_TRUE(page_table.Find(9, &frame_id));
+  EXPECT_EQ(2, frame_id);
+
+  // Inserting a page that is already there remaps it.
+  page_table.Insert(9, 3);
+  EXPECT_EQ(2, page_table.Size());
+  ASSERT_TRUE(page_table.Find(9, &frame_id));
+  EXPECT_EQ(3, frame_id);
+
+  std::map<page_id_t, frame_id_t> entries;
+  page_table.ForEach([&](page_id_t page_id, frame_id_t frame_id) { entries[page_id] = frame_id; });
+  EXPECT_EQ((std::map<page_id_t, frame_id_t>{{1, 0}, {9, 3}}), entries);
+}
+
+// NOLINTNEXTLINE
+TEST(PageTableTest, ChurnTest) {
+  // Keep the table full while pages come and go, like a buffer pool does, and check it against a reference.
+  const size_t num_frames = 64;
+  PageTable page_table(num_frames);
+  std::map<page_id_t, frame_id_t> reference;
+  std::default_random_engine rng(0);
+  std::uniform_int_distribution<page_id_t> dist(0, 1000);
+  for (int i = 0; i < 100000; ++i) {
+    page_id_t page_id = dist(rng);
+    if (reference.count(page_id) != 0) {
+      page_table.Erase(page_id);
+      reference.erase(page_id);
+    } else if (reference.size() < num_frames) {
+      page_table.Insert(page_id, i % num_frames);
+      reference[page_id] = i % num_frames;
+    }
+  }
+  EXPECT_EQ(reference.size(), page_table.Size());
+  for (page_id_t page_id = 0; page_id <= 1000; ++page_id) {
+    frame_id_t frame_id;
+    auto it = reference.find(page_id);
+    ASSERT_EQ(it != reference.end(), page_table.Find(page_id, &frame_id));
+    if (it != reference.end()) {
+      EXPECT_EQ(it->second, frame_id);
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(PageTableTest, ConcurrentFindTest) {
+  // Pages 0..num_stable - 1 never move, while a writer keeps inserting and erasing other pages around them. Readers
+  // must always find the stable pages, in the right frame.
+  const size_t num_frames = 32;
+  const page_id_t num_stable = 16;
+  PageTable page_table(num_frames);
+  for (page_id_t page_id = 0; page_id < num_stable; ++page_id) {
+    page_table.Insert(page_id, page_id);
+  }
+
+  std::atomic<bool> done{false};
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < 4; ++tid) {
+    threads.emplace_back([&page_table, &done, tid] {
+      std::default_random_engine rng(tid);
+      std::uniform_int_distribution<page_id_t> dist(0, num_stable - 1);
+      while (!done) {
+        page_id_t page_id = dist(rng);
+        frame_id_t frame_id;
+        ASSERT_TRUE(page_table.Find(page_id, &frame_id));
+        EXPECT_EQ(page_id, frame_id);
+      }
+    });
+  }
+  std::default_random_engine rng(42);
+  std::uniform_int_distribution<page_id_t> dist(num_stable, 10000);
+  std::vector<page_id_t> churn;
+  for (int i = 0; i < 100000; ++i) {
+    if (churn.size() == num_frames - num_stable) {
+      page_table.Erase(churn[i % churn.size()]);
+      churn[i % churn.size()] = churn.back();
+      churn.pop_back();
+    }
+    page_id_t page_id = dist(rng);
+    frame_id_t frame_id;
+    if (!page_table.Find(page_id, &frame_id)) {
+      page_table.Insert(page_id, static_cast<frame_id_t>(num_stable));
+      churn.push_back(page_id);
+    }
+  }
+  done = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+}  // namespace bustub
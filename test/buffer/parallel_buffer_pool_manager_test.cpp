@@ -0,0 +1,277 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager_test.cpp
+//
+// Identification: test/buffer/parallel_buffer_pool_manager_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_latency.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+  const size_t num_instances = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+  EXPECT_EQ(buffer_pool_size * num_instances, bpm->GetPoolSize());
+
+  page_id_t page_id_temp;
+  auto *page0 = bpm->NewPage(&page_id_temp);
+
+  // Scenario: The buffer pool is empty. We should be able to create a new page.
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, page_id_temp);
+
+  // Scenario: Once we have a page, we should be able to read and write content.
+  snprintf(page0->GetData(), PAGE_SIZE, "Hello");
+  EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
+
+  // Scenario: We should be able to create new pages until we fill up the buffer pool. Round-robin allocation hands out
+  // page ids in order, and every page lands in the instance that page_id % num_instances points at.
+  for (size_t i = 1; i < buffer_pool_size * num_instances; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(static_cast<page_id_t>(i), page_id_temp);
+  }
+
+  // Scenario: Once the buffer pool is full, we should not be able to create any new pages.
+  for (size_t i = 0; i < buffer_pool_size * num_instances; ++i) {
+    EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  }
+
+  // Scenario: After unpinning pages {0, 1, 2, 3, 4}, every instance has one evictable frame again.
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(i, true));
+    bpm->FlushPage(i);
+  }
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    bpm->UnpinPage(page_id_temp, false);
+  }
+
+  // Scenario: We should be able to fetch the data we wrote a while ago.
+  page0 = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
+  EXPECT_EQ(true, bpm->UnpinPage(0, true));
+
+  // Scenario: Deleting a pinned page fails, deleting an unpinned page succeeds.
+  EXPECT_EQ(false, bpm->DeletePage(5));
+  EXPECT_EQ(true, bpm->UnpinPage(5, false));
+  EXPECT_EQ(true, bpm->DeletePage(5));
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ConcurrencyTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  const size_t num_instances = 4;
+  const int num_threads = 8;
+  const int num_pages = 64;
+
+  for (auto replacer_type : {ReplacerType::LRU, ReplacerType::CLOCK}) {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager, nullptr, replacer_type);
+
+    // Every page starts out holding its own id.
+    for (int i = 0; i < num_pages; ++i) {
+      page_id_t page_id;
+      auto *page = bpm->NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "%d", page_id);
+      EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+
+    // Half of the unpins below mark the page dirty, which keeps the background writers busy all along.
+    bpm->RunBackgroundWriter(0.5);
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads; ++tid) {
+      threads.emplace_back([bpm, tid] {
+        std::default_random_engine rng(tid);
+        std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+        for (int i = 0; i < 1000; ++i) {
+          page_id_t page_id = dist(rng);
+          auto *page = bpm->FetchPage(page_id);
+          if (page == nullptr) {
+            continue;
+          }
+          EXPECT_EQ(page_id, page->GetPageId());
+          EXPECT_EQ(std::to_string(page_id), std::string(page->GetData()));
+          EXPECT_TRUE(bpm->UnpinPage(page_id, i % 2 == 0));
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    bpm->StopBackgroundWriter();
+    EXPECT_LT(0, bpm->GetNumBackgroundWrites());
+
+    disk_manager->ShutDown();
+    remove("test.db");
+
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+/**
+ * Fetch/unpin throughput of a single instance against a sharded pool of the same total size, for 1 to 32 threads.
+ * The first run keeps the working set resident so that only the latches are measured; in the second run the working
+ * set is twice the pool, so roughly half of the fetches miss and go to disk.
+ */
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, FetchUnpinScalingBenchmark) {
+  const std::string db_name = "test.db";
+  const size_t num_instances = 16;
+  const size_t frames_per_instance = 16;
+  const size_t total_frames = num_instances * frames_per_instance;
+  const int ops_per_run = 40000;
+
+  auto run = [](BufferPoolManager *bpm, int num_threads, int num_pages) {
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int tid = 0; tid < num_threads; ++tid) {
+      threads.emplace_back([bpm, tid, num_threads, num_pages] {
+        std::default_random_engine rng(tid);
+        std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+        for (int i = 0; i < ops_per_run / num_threads; ++i) {
+          page_id_t page_id = dist(rng);
+          if (bpm->FetchPage(page_id) != nullptr) {
+            bpm->UnpinPage(page_id, false);
+          }
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return ops_per_run / elapsed.count();
+  };
+
+  auto *disk_manager = new DiskManager(db_name);
+  std::unique_ptr<BufferPoolManager> single = std::make_unique<BufferPoolManagerInstance>(total_frames, disk_manager);
+  std::unique_ptr<BufferPoolManager> parallel =
+      std::make_unique<ParallelBufferPoolManager>(num_instances, frames_per_instance, disk_manager);
+
+  // Lay the pages out on disk once; both pools read the same file.
+  const int max_pages = static_cast<int>(total_frames * 2);
+  for (int i = 0; i < max_pages; ++i) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, parallel->NewPage(&page_id));
+    parallel->UnpinPage(page_id, true);
+  }
+  parallel->FlushAllPages();
+
+  for (int num_pages : {static_cast<int>(total_frames / 2), max_pages}) {
+    std::cout << "working set " << num_pages << " pages, pool " << total_frames << " frames" << std::endl;
+    std::cout << "threads\tsingle (ops/s)\tparallel x" << num_instances << " (ops/s)" << std::endl;
+    for (int num_threads = 1; num_threads <= 32; num_threads *= 2) {
+      double single_ops = run(single.get(), num_threads, num_pages);
+      double parallel_ops = run(parallel.get(), num_threads, num_pages);
+      std::cout << num_threads << "\t" << static_cast<int64_t>(single_ops) << "\t\t"
+                << static_cast<int64_t>(parallel_ops) << std::endl;
+    }
+  }
+
+  single.reset();
+  parallel.reset();
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+/**
+ * Fetch/unpin throughput of the same workload over each disk backend: in memory, which leaves only the CPU cost of the
+ * pool, on a file, and in memory behind the latency of an SSD and of a network volume. The working set is four times
+ * the pool, so most fetches miss.
+ */
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, DiskBackendBenchmark) {
+  const size_t num_instances = 8;
+  const size_t frames_per_instance = 16;
+  const int num_pages = static_cast<int>(num_instances * frames_per_instance * 4);
+  const int num_threads = 8;
+  const int ops_per_run = 16000;
+
+  auto run = [&](DiskInterface *disk) {
+    auto bpm = std::make_unique<ParallelBufferPoolManager>(num_instances, frames_per_instance, disk);
+    for (int i = 0; i < num_pages; ++i) {
+      page_id_t page_id;
+      EXPECT_NE(nullptr, bpm->NewPage(&page_id));
+      bpm->UnpinPage(page_id, true);
+    }
+    bpm->FlushAllPages();
+    int reads = disk->GetNumReads();
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int tid = 0; tid < num_threads; ++tid) {
+      threads.emplace_back([&bpm, tid, num_pages, num_threads] {
+        std::default_random_engine rng(tid);
+        std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+        for (int i = 0; i < ops_per_run / num_threads; ++i) {
+          page_id_t page_id = dist(rng);
+          if (bpm->FetchPage(page_id) != nullptr) {
+            bpm->UnpinPage(page_id, false);
+          }
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << static_cast<int64_t>(ops_per_run / elapsed.count()) << " ops/s\t"
+              << disk->GetNumReads() - reads << " page reads" << std::endl;
+  };
+
+  DiskManagerMemory memory;
+  std::cout << "memory\t\t";
+  run(&memory);
+  remove("test.db");
+  DiskManager file("test.db");
+  std::cout << "file\t\t";
+  run(&file);
+  file.ShutDown();
+  remove("test.db");
+  DiskManagerMemory ssd_memory;
+  DiskManagerLatency ssd(&ssd_memory, DiskProfile::Ssd());
+  std::cout << "ssd\t\t";
+  run(&ssd);
+  DiskManagerMemory network_memory;
+  DiskManagerLatency network(&network_memory, DiskProfile::NetworkVolume());
+  std::cout << "network volume\t";
+  run(&network);
+}
+
+}  // namespace bustub
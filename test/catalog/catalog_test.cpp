@@ -10,13 +10,17 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <cstdio>
+#include <fstream>
 #include <string>
 #include <unordered_set>
 #include <vector>
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 #include "catalog/catalog.h"
+#include "concurrency/transaction.h"
 #include "gtest/gtest.h"
+#include "storage/index/generic_key.h"
 #include "type/value_factory.h"
 
 namespace bustub {
@@ -24,7 +28,7 @@ namespace bustub {
 // NOLINTNEXTLINE
 TEST(CatalogTest, DISABLED_CreateTableTest) {
   auto disk_manager = new DiskManager("catalog_test.db");
-  auto bpm = new BufferPoolManager(32, disk_manager);
+  auto bpm = new BufferPoolManagerInstance(32, disk_manager);
   auto catalog = new Catalog(bpm, nullptr, nullptr);
   std::string table_name = "potato";
 
@@ -48,4 +52,82 @@ TEST(CatalogTest, DISABLED_CreateTableTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(CatalogTest, PlacementTest) {
+  remove("catalog_test.db");
+  remove("catalog_test.tablespaces");
+  remove("catalog_test.1.db");
+  remove("catalog_test_index.db");
+  auto *disk_manager = new DiskManager("catalog_test.db");
+  auto *bpm = new BufferPoolManagerInstance(32, disk_manager);
+  auto *catalog = new Catalog(bpm, nullptr, nullptr);
+  Transaction txn(0);
+
+  std::vector<Column> columns;
+  columns.emplace_back("A", TypeId::INTEGER);
+  columns.emplace_back("B", TypeId::INTEGER);
+  Schema schema(columns);
+  Schema key_schema(std::vector<Column>{columns[0]});
+
+  // Scenario: one table in the db file, and one in a tablespace of its own with its index in another.
+  auto *shared = catalog->CreateTable(&txn, "shared", schema);
+  EXPECT_EQ(DEFAULT_TABLESPACE, GetTablespace(shared->table_->GetFirstPageId()));
+  auto *own = catalog->CreateTable(&txn, "own", schema, Placement::OwnFile());
+  EXPECT_NE(DEFAULT_TABLESPACE, own->tablespace_);
+  EXPECT_EQ(own->tablespace_, own->table_->GetTablespaceId());
+  std::string table_file = disk_manager->GetTablespaceFile(own->tablespace_);
+  EXPECT_EQ("catalog_test.1.db", table_file);
+  EXPECT_EQ(own, catalog->GetTable("own"));
+  EXPECT_EQ(own, catalog->GetTable(own->oid_));
+
+  auto *index = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      &txn, "own_a", "own", schema, key_schema, {0}, 8, Placement::OwnFile("catalog_test_index.db"));
+  EXPECT_NE(own->tablespace_, index->tablespace_);
+  EXPECT_EQ("catalog_test_index.db", disk_manager->GetTablespaceFile(index->tablespace_));
+  EXPECT_EQ(index, catalog->GetIndex("own_a", "own"));
+  EXPECT_EQ(std::vector<IndexInfo *>{index}, catalog->GetTableIndexes("own"));
+
+  // Enough tuples that the table heap grows past its first page, which stays in the table's tablespace.
+  RID own_rid;
+  RID shared_rid;
+  for (int i = 0; i < 1000; ++i) {
+    Tuple tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(-i)}, &schema);
+    ASSERT_TRUE(own->table_->InsertTuple(tuple, &own_rid, &txn));
+    ASSERT_TRUE(shared->table_->InsertTuple(tuple, &shared_rid, &txn));
+  }
+  EXPECT_NE(own->table_->GetFirstPageId(), own_rid.GetPageId());
+  EXPECT_EQ(own->tablespace_, GetTablespace(own_rid.GetPageId()));
+  EXPECT_EQ(DEFAULT_TABLESPACE, GetTablespace(shared_rid.GetPageId()));
+
+
+  // Scenario: a table with a pinned page cannot be dropped yet, but its index in a tablespace of its own goes.
+  Page *pinned = bpm->FetchPage(own->table_->GetFirstPageId());
+  ASSERT_NE(nullptr, pinned);
+  EXPECT_FALSE(catalog->DropTable(&txn, "own"));
+  EXPECT_FALSE(std::ifstream("catalog_test_index.db").good());
+  EXPECT_THROW(catalog->GetIndex("own_a", "own"), std::out_of_range);
+  EXPECT_TRUE(catalog->GetTableIndexes("own").empty());
+  EXPECT_EQ(own, catalog->GetTable("own"));
+  EXPECT_TRUE(bpm->UnpinPage(pinned->GetPageId(), false));
+
+  // Scenario: dropping the tables unlinks the files of the one with its own tablespace, and frees the pages of the
+  // other one by one.
+  page_id_t first_page_id = shared->table_->GetFirstPageId();
+  EXPECT_TRUE(catalog->DropTable(&txn, "own"));
+  EXPECT_TRUE(catalog->DropTable(&txn, "shared"));
+  EXPECT_FALSE(std::ifstream(table_file).good());
+  EXPECT_FALSE(std::ifstream("catalog_test_index.db").good());
+  EXPECT_FALSE(disk_manager->IsAllocated(first_page_id));
+  EXPECT_THROW(catalog->GetTable("own"), std::out_of_range);
+  EXPECT_THROW(catalog->GetIndex("own_a", "own"), std::out_of_range);
+
+  delete catalog;
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+  remove("catalog_test.tablespaces");
+}
+
 }  // namespace bustub
@@ -0,0 +1,126 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c_test.cpp
+//
+// Identification: test/common/crc32c_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/util/crc32c.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(Crc32cTest, KnownValuesTest) {
+  // Check values from RFC 3720.
+  std::string digits("123456789");
+  EXPECT_EQ(0xe3069283, Crc32c::Compute(digits.data(), digits.size()));
+  EXPECT_EQ(0xe3069283, Crc32c::ComputeSoftware(digits.data(), digits.size()));
+  std::vector<char> zeros(32, 0);
+  EXPECT_EQ(0x8a9136aa, Crc32c::Compute(zeros.data(), zeros.size()));
+  std::vector<char> ones(32, static_cast<char>(0xff));
+  EXPECT_EQ(0x62a8ab43, Crc32c::Compute(ones.data(), ones.size()));
+  EXPECT_EQ(0, Crc32c::Compute(nullptr, 0));
+
+  // Extending a checksum gives the checksum of the concatenation.
+  uint32_t head = Crc32c::Compute(digits.data(), 4);
+  EXPECT_EQ(0xe3069283, Crc32c::Compute(digits.data() + 4, digits.size() - 4, head));
+}
+
+// NOLINTNEXTLINE
+TEST(Crc32cTest, HardwareMatchesSoftwareTest) {
+  std::mt19937 gen(0);
+  std::vector<char> data(3 * PAGE_SIZE);
+  for (auto &c : data) {
+    c = static_cast<char>(gen());
+  }
+  // Lengths and alignments around the 8-byte words the instruction works on, and the streams it interleaves.
+  for (size_t offset = 0; offset < 8; ++offset) {
+    for (size_t length : {0, 1, 7, 8, 9, 63, 64, 65, PAGE_SIZE - 1, PAGE_SIZE, 2 * PAGE_SIZE + 5}) {
+      EXPECT_EQ(Crc32c::ComputeSoftware(data.data() + offset, length),
+                Crc32c::ComputeHardware(data.data() + offset, length));
+    }
+  }
+}
+
+/**
+ * Cost per page of the checksum, in software and with the crc32 instruction, against the cost of reading a page that
+ * is in the OS page cache, i.e. the cheapest I/O there is. ReadPage includes reading and verifying the checksum.
+ */
+// NOLINTNEXTLINE
+TEST(Crc32cTest, ChecksumCostBenchmark) {
+  const int num_pages = 256;
+  const int rounds = 20;
+  remove("test.db");
+  auto dm = DiskManager("test.db");
+  std::vector<char> data(PAGE_SIZE);
+  std::mt19937 gen(0);
+  for (int i = 0; i < num_pages; ++i) {
+    for (auto &c : data) {
+      c = static_cast<char>(gen());
+    }
+    dm.WritePage(i, data.data());
+  }
+  int fd = open("test.db", O_RDONLY);
+  ASSERT_GE(fd, 0);
+
+  auto ns_per_page = [&](auto &&op) {
+    op();  // warm up
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; ++round) {
+      op();
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / (rounds * num_pages);
+  };
+  uint32_t sink = 0;
+  double software = ns_per_page([&] {
+    for (int i = 0; i < num_pages; ++i) {
+      sink += Crc32c::ComputeSoftware(data.data(), PAGE_SIZE, i);
+    }
+  });
+  double hardware = ns_per_page([&] {
+    for (int i = 0; i < num_pages; ++i) {
+      sink += Crc32c::ComputeHardware(data.data(), PAGE_SIZE, i);
+    }
+  });
+  double raw_read = ns_per_page([&] {
+    for (int i = 0; i < num_pages; ++i) {
+      sink += pread(fd, data.data(), PAGE_SIZE, static_cast<off_t>(i) * PAGE_SIZE);
+    }
+  });
+  double read_page = ns_per_page([&] {
+    for (int i = 0; i < num_pages; ++i) {
+      dm.ReadPage(i, data.data());
+    }
+  });
+  close(fd);
+  dm.ShutDown();
+  remove("test.db");
+
+  std::cout << "crc32 instruction " << (Crc32c::IsHardwareAccelerated() ? "used" : "not available") << " (" << sink
+            << ")" << std::endl;
+  std::cout << "software crc32c\t" << software << " ns/page" << std::endl;
+  std::cout << "hardware crc32c\t" << hardware << " ns/page" << std::endl;
+  std::cout << "cached pread\t" << raw_read << " ns/page" << std::endl;
+  std::cout << "ReadPage\t" << read_page << " ns/page" << std::endl;
+  std::cout << "hardware crc32c / cached pread\t" << hardware / raw_read << std::endl;
+}
+
+}  // namespace bustub
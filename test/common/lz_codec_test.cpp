@@ -0,0 +1,121 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lz_codec_test.cpp
+//
+// Identification: test/common/lz_codec_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "common/util/lz_codec.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+/** @return the bytes after compressing and decompressing data, after checking that it round-trips */
+static std::vector<char> RoundTrip(const std::vector<char> &data, size_t *compressed_size = nullptr) {
+  std::vector<char> compressed(LzCodec::MaxCompressedSize(data.size()));
+  size_t size = LzCodec::Compress(data.data(), data.size(), compressed.data(), compressed.size());
+  EXPECT_NE(0, size);
+  std::vector<char> result(data.size());
+  EXPECT_TRUE(LzCodec::Decompress(compressed.data(), size, result.data(), result.size()));
+  if (compressed_size != nullptr) {
+    *compressed_size = size;
+  }
+  return result;
+}
+
+// NOLINTNEXTLINE
+TEST(LzCodecTest, RoundTripTest) {
+  std::mt19937 gen(0);
+  size_t size;
+
+  // Scenario: a zeroed page shrinks to a handful of bytes, and so does any run of one byte.
+  std::vector<char> zeros(PAGE_SIZE, 0);
+  EXPECT_EQ(zeros, RoundTrip(zeros, &size));
+  EXPECT_LT(size, 32);
+
+  // Scenario: a page like a table heap's, with a slot array in front, tuples at the back and zeros in between.
+  std::vector<char> page(PAGE_SIZE, 0);
+  for (int i = 0; i < 100; ++i) {
+    int32_t slot[2] = {PAGE_SIZE - (i + 1) * 16, 16};
+    memcpy(page.data() + 24 + i * 8, slot, sizeof(slot));
+    int32_t tuple[4] = {i, static_cast<int32_t>(gen() % 10), static_cast<int32_t>(gen() % 10000), 7};
+    memcpy(page.data() + PAGE_SIZE - (i + 1) * 16, tuple, sizeof(tuple));
+  }
+  EXPECT_EQ(page, RoundTrip(page, &size));
+  EXPECT_LT(size, PAGE_SIZE / 2);
+
+  // Scenario: noise does not compress but still round-trips, as do the lengths around the token nibbles.
+  std::vector<char> noise(PAGE_SIZE);
+  for (auto &c : noise) {
+    c = static_cast<char>(gen());
+  }
+  EXPECT_EQ(noise, RoundTrip(noise));
+  for (size_t length : {0, 1, 3, 4, 5, 14, 15, 16, 19, 20, 270, 271, 300}) {
+    std::vector<char> data(noise.begin(), noise.begin() + length);
+    EXPECT_EQ(data, RoundTrip(data));
+    std::vector<char> run(length, 'r');
+    EXPECT_EQ(run, RoundTrip(run));
+  }
+
+  // Scenario: a long match right after a long stretch of literals.
+  std::vector<char> mixed(noise.begin(), noise.begin() + 1000);
+  mixed.insert(mixed.end(), noise.begin(), noise.begin() + 1000);
+  EXPECT_EQ(mixed, RoundTrip(mixed, &size));
+  EXPECT_LT(size, 1100);
+}
+
+// NOLINTNEXTLINE
+TEST(LzCodecTest, CapacityTest) {
+  std::mt19937 gen(0);
+  std::vector<char> noise(PAGE_SIZE);
+  for (auto &c : noise) {
+    c = static_cast<char>(gen());
+  }
+  std::vector<char> compressed(LzCodec::MaxCompressedSize(PAGE_SIZE));
+  // Scenario: output that does not fit is refused rather than written past the end.
+  EXPECT_EQ(0, LzCodec::Compress(noise.data(), noise.size(), compressed.data(), PAGE_SIZE - COMPRESSED_SLOT_SIZE));
+  EXPECT_LE(LzCodec::Compress(noise.data(), noise.size(), compressed.data(), compressed.size()),
+            LzCodec::MaxCompressedSize(PAGE_SIZE));
+  std::vector<char> zeros(PAGE_SIZE, 0);
+  EXPECT_EQ(0, LzCodec::Compress(zeros.data(), zeros.size(), compressed.data(), 2));
+}
+
+// NOLINTNEXTLINE
+TEST(LzCodecTest, MalformedInputTest) {
+  std::vector<char> page(PAGE_SIZE, 0);
+  snprintf(page.data(), PAGE_SIZE, "A test string, A test string, A test string.");
+  std::vector<char> compressed(LzCodec::MaxCompressedSize(PAGE_SIZE));
+  size_t size = LzCodec::Compress(page.data(), page.size(), compressed.data(), compressed.size());
+  std::vector<char> result(PAGE_SIZE);
+
+  // Scenario: truncated input, or input for a different size, is rejected.
+  for (size_t length = 0; length < size; ++length) {
+    EXPECT_FALSE(LzCodec::Decompress(compressed.data(), length, result.data(), result.size()));
+  }
+  EXPECT_FALSE(LzCodec::Decompress(compressed.data(), size, result.data(), result.size() - 1));
+
+  // Scenario: whatever the bytes, decompressing stays within its buffers.
+  std::mt19937 gen(0);
+  for (int round = 0; round < 1000; ++round) {
+    std::vector<char> garbage(compressed.begin(), compressed.begin() + size);
+    garbage[gen() % size] = static_cast<char>(gen());
+    LzCodec::Decompress(garbage.data(), garbage.size(), result.data(), result.size());
+  }
+  // An offset pointing before the start of the output.
+  std::string bad_offset("\x14" "a\x05\x00", 4);
+  EXPECT_FALSE(LzCodec::Decompress(bad_offset.data(), bad_offset.size(), result.data(), 5));
+}
+
+}  // namespace bustub
@@ -10,6 +10,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <iostream>
 #include <thread>  // NOLINT
 #include <vector>
 
@@ -57,4 +60,154 @@ TEST(RWLatchTest, BasicTest) {
   }
   EXPECT_EQ(counter.Read(), 55);
 }
+
+/**
+ * Two values that a writer keeps equal. Readers may read them under the read latch or optimistically; the values are
+ * relaxed atomics only so that an optimistic read racing with the writer is not undefined behavior.
+ */
+class VersionedPair {
+ public:
+  void Add(int num) {
+    latch_.WLock();
+    first_.store(first_.load(std::memory_order_relaxed) + num, std::memory_order_relaxed);
+    second_.store(second_.load(std::memory_order_relaxed) + num, std::memory_order_relaxed);
+    latch_.WUnlock();
+  }
+
+  int ReadLatched(bool *consistent) {
+    latch_.RLock();
+    int first = first_.load(std::memory_order_relaxed);
+    *consistent = first == second_.load(std::memory_order_relaxed);
+    latch_.RUnlock();
+    return first;
+  }
+
+  // returns false if the read has to be retried
+  bool ReadOptimistic(int *first, bool *consistent) const {
+    uint64_t version;
+    if (!latch_.TryOptimisticRead(&version)) {
+      return false;
+    }
+    *first = first_.load(std::memory_order_relaxed);
+    int second = second_.load(std::memory_order_relaxed);
+    if (!latch_.Validate(version)) {
+      return false;
+    }
+    *consistent = *first == second;
+    return true;
+  }
+
+ private:
+  std::atomic<int> first_{0};
+  std::atomic<int> second_{0};
+  ReaderWriterLatch latch_;
+};
+
+// NOLINTNEXTLINE
+TEST(RWLatchTest, OptimisticReadTest) {
+  ReaderWriterLatch latch;
+  uint64_t version;
+  ASSERT_TRUE(latch.TryOptimisticRead(&version));
+  EXPECT_TRUE(latch.Validate(version));
+
+  // Readers do not invalidate optimistic reads; writers do, and block them while they hold the latch.
+  latch.RLock();
+  EXPECT_TRUE(latch.Validate(version));
+  latch.RUnlock();
+  latch.WLock();
+  EXPECT_FALSE(latch.Validate(version));
+  uint64_t locked_version;
+  EXPECT_FALSE(latch.TryOptimisticRead(&locked_version));
+  latch.WUnlock();
+  EXPECT_FALSE(latch.Validate(version));
+  ASSERT_TRUE(latch.TryOptimisticRead(&version));
+  EXPECT_TRUE(latch.Validate(version));
+
+  // A validated optimistic read never sees a half-done write.
+  VersionedPair pair;
+  std::atomic<bool> done{false};
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < 4; tid++) {
+    threads.emplace_back([&pair, &done] {
+      int validated = 0;
+      while (!done || validated == 0) {
+        int first;
+        bool consistent;
+        if (pair.ReadOptimistic(&first, &consistent)) {
+          EXPECT_TRUE(consistent);
+          validated++;
+        }
+      }
+    });
+  }
+  for (int i = 0; i < 10000; i++) {
+    pair.Add(1);
+  }
+  done = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  bool consistent;
+  EXPECT_EQ(10000, pair.ReadLatched(&consistent));
+  EXPECT_TRUE(consistent);
+}
+
+/**
+ * Read throughput of the read latch against optimistic reads for 1 to 32 reader threads, with no writer and with one
+ * writer updating the pair every 100 microseconds.
+ */
+// NOLINTNEXTLINE
+TEST(RWLatchTest, OptimisticReadBenchmark) {
+  const int reads_per_thread = 200000;
+
+  auto run = [](VersionedPair *pair, int num_threads, bool optimistic, bool with_writer) {
+    std::atomic<bool> done{false};
+    std::thread writer;
+    if (with_writer) {
+      writer = std::thread([pair, &done] {
+        while (!done) {
+          pair->Add(1);
+          std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+      });
+    }
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int tid = 0; tid < num_threads; ++tid) {
+      threads.emplace_back([pair, optimistic] {
+        int first;
+        bool consistent;
+        for (int i = 0; i < reads_per_thread; ++i) {
+          if (optimistic) {
+            while (!pair->ReadOptimistic(&first, &consistent)) {
+            }
+          } else {
+            pair->ReadLatched(&consistent);
+          }
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    done = true;
+    if (writer.joinable()) {
+      writer.join();
+    }
+    return num_threads * reads_per_thread / elapsed.count();
+  };
+
+  VersionedPair pair;
+  for (bool with_writer : {false, true}) {
+    std::cout << (with_writer ? "one writer" : "no writer") << std::endl;
+    std::cout << "threads\tlatched (reads/s)\toptimistic (reads/s)" << std::endl;
+    for (int num_threads = 1; num_threads <= 32; num_threads *= 2) {
+      double latched = run(&pair, num_threads, false, with_writer);
+      double optimistic = run(&pair, num_threads, true, with_writer);
+      std::cout << num_threads << "\t" << static_cast<int64_t>(latched) << "\t\t" << static_cast<int64_t>(optimistic)
+                << std::endl;
+    }
+  }
+}
 }  // namespace bustub
@@ -0,0 +1,228 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_disk_manager_test.cpp
+//
+// Identification: test/storage/async_disk_manager_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <future>  // NOLINT
+#include <iterator>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/exception.h"
+#include "gtest/gtest.h"
+#include "storage/disk/async_disk_manager.h"
+
+namespace bustub {
+
+class AsyncDiskManagerTest : public ::testing::TestWithParam<bool> {
+ protected:
+  // This function is called before every test.
+  void SetUp() override {
+    remove("test.db");
+    remove("test.log");
+    remove("test.dwb");
+  }
+
+  // This function is called after every test.
+  void TearDown() override {
+    remove("test.db");
+    remove("test.log");
+    remove("test.dwb");
+  };
+};
+
+// NOLINTNEXTLINE
+TEST_P(AsyncDiskManagerTest, ReadWritePageTest) {
+  char buf[PAGE_SIZE] = {0};
+  char data[PAGE_SIZE] = {0};
+  auto dm = DiskManager("test.db");
+  {
+    AsyncDiskManager adm(&dm, ASYNC_IO_QUEUE_DEPTH, GetParam());
+    std::strncpy(data, "A test string.", sizeof(data));
+
+    // Scenario: a page past the end of the file reads as zeros.
+    std::memset(buf, 'x', sizeof(buf));
+    adm.ReadPageAsync(3, buf).get();
+    EXPECT_EQ(std::vector<char>(PAGE_SIZE, 0), std::vector<char>(buf, buf + PAGE_SIZE));
+
+    // Scenario: what is written reads back, both through the async disk manager and through the disk manager.
+    adm.WritePageAsync(5, data).get();
+    adm.ReadPageAsync(5, buf).get();
+    EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+    std::memset(buf, 0, sizeof(buf));
+    dm.ReadPage(5, buf);
+    EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+  }
+  EXPECT_EQ(1, dm.GetNumWrites());
+  EXPECT_EQ(3, dm.GetNumReads());
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_P(AsyncDiskManagerTest, ChecksumTest) {
+  const int num_pages = 8;
+  auto dm = DiskManager("test.db");
+  {
+    AsyncDiskManager adm(&dm, ASYNC_IO_QUEUE_DEPTH, GetParam());
+    std::vector<std::vector<char>> data(num_pages, std::vector<char>(PAGE_SIZE));
+    std::vector<std::vector<char>> bufs(num_pages, std::vector<char>(PAGE_SIZE));
+    std::vector<page_id_t> page_ids;
+    std::vector<const char *> page_data;
+    std::vector<char *> page_bufs;
+    for (int i = 0; i < num_pages; ++i) {
+      page_ids.push_back(i);
+      snprintf(data[i].data(), PAGE_SIZE, "page %d|", i);
+      page_data.push_back(data[i].data());
+      page_bufs.push_back(bufs[i].data());
+    }
+
+    // Scenario: the checksum of every page written is stored with it.
+    adm.WritePagesAsync(page_ids, page_data).get();
+    for (int i = 0; i < num_pages; ++i) {
+      EXPECT_TRUE(dm.VerifyPage(i, data[i].data()));
+      data[i][0] ^= 1;
+      EXPECT_FALSE(dm.VerifyPage(i, data[i].data()));
+      data[i][0] ^= 1;
+    }
+
+    // Scenario: a page damaged on disk fails its batch with a CORRUPTION exception; the rest read back fine.
+    {
+      std::fstream file("test.db", std::ios::binary | std::ios::in | std::ios::out);
+      std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+      file.seekp(contents.find("page 5|"));
+      file.put('x');
+    }
+    try {
+      adm.ReadPagesAsync(page_ids, page_bufs).get();
+      ADD_FAILURE() << "page 5 was read";
+    } catch (const Exception &e) {
+      EXPECT_EQ(ExceptionType::CORRUPTION, e.GetType());
+    }
+    page_ids.erase(page_ids.begin() + 5);
+    page_bufs.erase(page_bufs.begin() + 5);
+    adm.ReadPagesAsync(page_ids, page_bufs).get();
+    for (page_id_t page_id : page_ids) {
+      EXPECT_EQ(data[page_id], bufs[page_id]);
+    }
+  }
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_P(AsyncDiskManagerTest, BatchTest) {
+  const size_t queue_depth = 4;
+  const int num_pages = 37;
+  auto dm = DiskManager("test.db");
+  {
+    AsyncDiskManager adm(&dm, queue_depth, GetParam());
+    EXPECT_LE(adm.GetQueueDepth(), queue_depth);
+
+    // Scenario: batches much larger than the queue depth are written and read back in one call each.
+    std::vector<std::vector<char>> data(num_pages, std::vector<char>(PAGE_SIZE));
+    std::vector<std::vector<char>> bufs(num_pages, std::vector<char>(PAGE_SIZE));
+    std::vector<page_id_t> page_ids;
+    std::vector<const char *> page_data;
+    std::vector<char *> page_bufs;
+    for (int i = 0; i < num_pages; ++i) {
+      page_ids.push_back(num_pages - i);
+      snprintf(data[i].data(), PAGE_SIZE, "page %d", num_pages - i);
+      page_data.push_back(data[i].data());
+      page_bufs.push_back(bufs[i].data());
+    }
+    adm.WritePagesAsync(page_ids, page_data).get();
+    adm.ReadPagesAsync(page_ids, page_bufs).get();
+    EXPECT_EQ(data, bufs);
+
+    // Scenario: an empty batch is ready right away.
+    EXPECT_EQ(std::future_status::ready, adm.ReadPagesAsync({}, {}).wait_for(std::chrono::seconds(0)));
+  }
+  EXPECT_EQ(num_pages, dm.GetNumWrites());
+  EXPECT_EQ(num_pages, dm.GetNumReads());
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_P(AsyncDiskManagerTest, ConcurrencyTest) {
+  const int num_threads = 8;
+  const int pages_per_thread = 32;
+  auto dm = DiskManager("test.db");
+  {
+    AsyncDiskManager adm(&dm, 8, GetParam());
+
+    // Every thread keeps all of its writes in flight at once, then reads its pages back.
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads; ++tid) {
+      threads.emplace_back([&adm, tid] {
+        std::vector<std::vector<char>> data(pages_per_thread, std::vector<char>(PAGE_SIZE));
+        std::vector<std::future<void>> writes;
+        for (int i = 0; i < pages_per_thread; ++i) {
+          page_id_t page_id = i * num_threads + tid;
+          std::memset(data[i].data(), 'a' + page_id % 26, PAGE_SIZE);
+          writes.push_back(adm.WritePageAsync(page_id, data[i].data()));
+        }
+        for (auto &write : writes) {
+          write.get();
+        }
+        std::vector<char> buf(PAGE_SIZE);
+        for (int i = 0; i < pages_per_thread; ++i) {
+          adm.ReadPageAsync(i * num_threads + tid, buf.data()).get();
+          EXPECT_EQ(data[i], buf);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  }
+  EXPECT_EQ(num_threads * pages_per_thread, dm.GetNumWrites());
+  EXPECT_EQ(num_threads * pages_per_thread, dm.GetNumReads());
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_P(AsyncDiskManagerTest, DoubleWriteTest) {
+  const int num_pages = DOUBLE_WRITE_PAGES + 3;
+  auto dm = DiskManager("test.db", true);
+  {
+    AsyncDiskManager adm(&dm, ASYNC_IO_QUEUE_DEPTH, GetParam());
+
+    // Scenario: writes go through the disk manager's double-write file, and read back like any others.
+    std::vector<std::vector<char>> data(num_pages, std::vector<char>(PAGE_SIZE));
+    std::vector<std::vector<char>> bufs(num_pages, std::vector<char>(PAGE_SIZE));
+    std::vector<page_id_t> page_ids;
+    std::vector<const char *> page_data;
+    std::vector<char *> page_bufs;
+    for (int i = 0; i < num_pages; ++i) {
+      page_ids.push_back(i);
+      snprintf(data[i].data(), PAGE_SIZE, "page %d", i);
+      page_data.push_back(data[i].data());
+      page_bufs.push_back(bufs[i].data());
+    }
+    adm.WritePagesAsync(page_ids, page_data).get();
+    adm.ReadPagesAsync(page_ids, page_bufs).get();
+    EXPECT_EQ(data, bufs);
+  }
+  EXPECT_EQ(num_pages, dm.GetNumWrites());
+
+  dm.ShutDown();
+}
+
+// Run every test through io_uring, if the kernel has it, and through the thread pool.
+INSTANTIATE_TEST_SUITE_P(IoUringAndThreadPool, AsyncDiskManagerTest, ::testing::Bool());
+
+}  // namespace bustub
@@ -2,13 +2,17 @@
  * b_plus_tree_test.cpp
  */
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>  // NOLINT
 #include <cstdio>
 #include <functional>
+#include <random>
+#include <set>
 #include <thread>                   // NOLINT
 #include "b_plus_tree_test_util.h"  // NOLINT
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
 #include "storage/index/b_plus_tree.h"
 
@@ -98,7 +102,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest1) {
   GenericComparator<8> comparator(key_schema);
 
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
   // create b+ tree
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
   // create and fetch header_page
@@ -150,7 +154,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest2) {
   Schema *key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema);
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
   // create b+ tree
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
   // create and fetch header_page
@@ -203,7 +207,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest1) {
   GenericComparator<8> comparator(key_schema);
 
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
   // create b+ tree
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
   GenericKey<8> index_key;
@@ -246,7 +250,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest2) {
   GenericComparator<8> comparator(key_schema);
 
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
   // create b+ tree
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
   GenericKey<8> index_key;
@@ -290,7 +294,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_MixTest) {
   GenericComparator<8> comparator(key_schema);
 
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
   // create b+ tree
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
   GenericKey<8> index_key;
@@ -330,4 +334,97 @@ TEST(BPlusTreeConcurrentTest, DISABLED_MixTest) {
   remove("test.log");
 }
 
+TEST(BPlusTreeConcurrentTest, OptimisticReadTest) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  // the tree outgrows the pool, so descents also race with evictions
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create b+ tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+  tree.SetOptimisticLatching(true);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // keys to Insert, in an order that splits leaves all over the tree
+  std::vector<int64_t> keys;
+  int64_t scale_factor = 10000;
+  for (int64_t key = 1; key <= scale_factor; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::default_random_engine(15445));
+  std::vector<int64_t> preloaded_keys(keys.begin(), keys.begin() + keys.size() / 2);
+  std::vector<int64_t> concurrent_keys(keys.begin() + keys.size() / 2, keys.end());
+  InsertHelper(&tree, preloaded_keys);
+
+  // Scenario: lookups and scans descend optimistically while other threads split the leaves under them. Every key
+  // inserted before they started is found, and scans see keys in order and only keys that were inserted.
+  std::atomic<bool> done{false};
+  std::thread writers([&] { LaunchParallelTest(4, InsertHelperSplit, &tree, concurrent_keys, 4); });
+  std::vector<std::thread> readers;
+  for (int tid = 0; tid < 2; ++tid) {
+    readers.emplace_back([&, tid] {
+      std::vector<RID> rids;
+      GenericKey<8> index_key;
+      do {
+        for (size_t i = tid; i < preloaded_keys.size(); i += 2) {
+          rids.clear();
+          index_key.SetFromInteger(preloaded_keys[i]);
+          EXPECT_TRUE(tree.GetValue(index_key, rids));
+          ASSERT_EQ(rids.size(), 1);
+          EXPECT_EQ(rids[0].GetSlotNum(), preloaded_keys[i]);
+        }
+      } while (!done);
+    });
+  }
+  readers.emplace_back([&] {
+    std::set<int64_t> preloaded(preloaded_keys.begin(), preloaded_keys.end());
+    do {
+      int64_t last_key = 0;
+      size_t num_preloaded = 0;
+      for (auto iterator = tree.begin(); !iterator.isEnd(); ++iterator) {
+        int64_t key = (*iterator).second.GetSlotNum();
+        EXPECT_LT(last_key, key);
+        EXPECT_LE(key, scale_factor);
+        num_preloaded += preloaded.count(key);
+        last_key = key;
+      }
+      EXPECT_EQ(preloaded.size(), num_preloaded);
+    } while (!done);
+  });
+  writers.join();
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  // Scenario: once the writers are done, lookups and a scan match the reference set.
+  std::set<int64_t> reference(keys.begin(), keys.end());
+  std::vector<RID> rids;
+  GenericKey<8> index_key;
+  for (auto key : reference) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    tree.GetValue(index_key, rids);
+    ASSERT_EQ(rids.size(), 1);
+    EXPECT_EQ(rids[0].GetSlotNum(), key);
+  }
+  std::vector<int64_t> scanned;
+  for (auto iterator = tree.begin(); !iterator.isEnd(); ++iterator) {
+    scanned.push_back((*iterator).second.GetSlotNum());
+  }
+  EXPECT_EQ(std::vector<int64_t>(reference.begin(), reference.end()), scanned);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
 }  // namespace bustub
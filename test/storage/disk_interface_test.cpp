@@ -0,0 +1,208 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_interface_test.cpp
+//
+// Identification: test/storage/disk_interface_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/exception.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_manager_latency.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+enum class DiskBackend { FILE, COMPRESSED_FILE, MEMORY, LATENCY };
+
+/** Every backend must behave the same way through the interface. */
+class DiskInterfaceTest : public ::testing::TestWithParam<DiskBackend> {
+ protected:
+  // This function is called before every test.
+  void SetUp() override {
+    remove("test.db");
+    remove("test.log");
+    remove("test.db.slots");
+    remove("test.db.slotmap");
+    switch (GetParam()) {
+      case DiskBackend::FILE:
+        disk_ = std::make_unique<DiskManager>("test.db");
+        break;
+      case DiskBackend::COMPRESSED_FILE:
+        disk_ = std::make_unique<DiskManager>("test.db", false, true);
+        break;
+      case DiskBackend::MEMORY:
+        disk_ = std::make_unique<DiskManagerMemory>(1024);
+        break;
+      case DiskBackend::LATENCY:
+        inner_ = std::make_unique<DiskManagerMemory>(1024);
+        disk_ = std::make_unique<DiskManagerLatency>(inner_.get(), DiskProfile::Ssd());
+        break;
+    }
+  }
+
+  // This function is called after every test.
+  void TearDown() override {
+    disk_->ShutDown();
+    disk_.reset();
+    inner_.reset();
+    remove("test.db");
+    remove("test.log");
+    remove("test.db.slots");
+    remove("test.db.slotmap");
+  };
+
+  std::unique_ptr<DiskInterface> inner_;
+  std::unique_ptr<DiskInterface> disk_;
+};
+
+// NOLINTNEXTLINE
+TEST_P(DiskInterfaceTest, ReadWritePageTest) {
+  char buf[PAGE_SIZE];
+  char data[PAGE_SIZE] = {0};
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  // Scenario: a page that was never written reads as zeros.
+  std::memset(buf, 'x', sizeof(buf));
+  disk_->ReadPage(5, buf);
+  EXPECT_EQ(std::vector<char>(PAGE_SIZE, 0), std::vector<char>(buf, buf + PAGE_SIZE));
+
+  // Scenario: what is written reads back, alone or in a batch.
+  disk_->WritePage(5, data);
+  disk_->ReadPage(5, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+
+  std::vector<std::vector<char>> pages(3, std::vector<char>(PAGE_SIZE));
+  std::vector<std::vector<char>> bufs(3, std::vector<char>(PAGE_SIZE));
+  std::vector<page_id_t> page_ids{7, 8, 9};
+  std::vector<const char *> page_data;
+  std::vector<char *> page_bufs;
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    snprintf(pages[i].data(), PAGE_SIZE, "page %d", page_ids[i]);
+    page_data.push_back(pages[i].data());
+    page_bufs.push_back(bufs[i].data());
+  }
+  disk_->WritePages(page_ids, page_data);
+  disk_->ReadPages(page_ids, page_bufs);
+  EXPECT_EQ(pages, bufs);
+  EXPECT_TRUE(disk_->VerifyPage(7, bufs[0].data()));
+
+  EXPECT_EQ(4, disk_->GetNumWrites());
+  EXPECT_EQ(5, disk_->GetNumReads());
+}
+
+// NOLINTNEXTLINE
+TEST_P(DiskInterfaceTest, AllocateDeallocateTest) {
+  // Scenario: two instances sharing the disk get the page ids of their residue, lowest first.
+  EXPECT_EQ(0, disk_->AllocatePage(2, 0));
+  EXPECT_EQ(1, disk_->AllocatePage(2, 1));
+  EXPECT_EQ(2, disk_->AllocatePage(2, 0));
+  EXPECT_EQ(3, disk_->AllocatePage(2, 1));
+  EXPECT_EQ(4, disk_->AllocatePage());
+  EXPECT_TRUE(disk_->IsAllocated(2));
+  EXPECT_FALSE(disk_->IsAllocated(5));
+
+  // Scenario: deallocated ids are handed out again, to the instance they belong to.
+  disk_->DeallocatePage(0);
+  disk_->DeallocatePage(0);
+  disk_->DeallocatePage(3);
+  EXPECT_FALSE(disk_->IsAllocated(0));
+  EXPECT_EQ(3, disk_->AllocatePage(2, 1));
+  EXPECT_EQ(0, disk_->AllocatePage(2, 0));
+  EXPECT_EQ(5, disk_->AllocatePage());
+}
+
+// NOLINTNEXTLINE
+TEST_P(DiskInterfaceTest, ReadWriteLogTest) {
+  char buf[16] = {0};
+  char data[16] = {0};
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  EXPECT_FALSE(disk_->ReadLog(buf, sizeof(buf), 0));
+  disk_->WriteLog(data, sizeof(data));
+  EXPECT_TRUE(disk_->ReadLog(buf, sizeof(buf), 0));
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+  EXPECT_EQ(1, disk_->GetNumFlushes());
+  EXPECT_FALSE(disk_->GetFlushState());
+}
+
+INSTANTIATE_TEST_SUITE_P(AllBackends, DiskInterfaceTest,
+                         ::testing::Values(DiskBackend::FILE, DiskBackend::COMPRESSED_FILE, DiskBackend::MEMORY,
+                                           DiskBackend::LATENCY));
+
+// NOLINTNEXTLINE
+TEST(DiskManagerMemoryTest, OutOfRangeTest) {
+  DiskManagerMemory disk(4);
+  char buf[PAGE_SIZE] = {0};
+  EXPECT_THROW(disk.ReadPage(4, buf), Exception);
+  EXPECT_THROW(disk.WritePage(-1, buf), Exception);
+  for (int i = 0; i < 4; ++i) {
+    disk.AllocatePage();
+  }
+  EXPECT_THROW(disk.AllocatePage(), Exception);
+
+  // A deallocated page reads as zeros.
+  std::memset(buf, 'x', sizeof(buf));
+  disk.WritePage(3, buf);
+  disk.DeallocatePage(3);
+  disk.ReadPage(3, buf);
+  EXPECT_EQ(std::vector<char>(PAGE_SIZE, 0), std::vector<char>(buf, buf + PAGE_SIZE));
+}
+
+// NOLINTNEXTLINE
+TEST(DiskManagerLatencyTest, DelayTest) {
+  using std::chrono::milliseconds;
+  DiskManagerMemory memory(64);
+  char buf[PAGE_SIZE] = {0};
+
+  // Scenario: concurrent requests each wait out their latency.
+  DiskProfile slow{milliseconds(50), milliseconds(10), 0, 0};
+  DiskManagerLatency latency_disk(&memory, slow);
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&latency_disk, i] {
+      char page[PAGE_SIZE] = {0};
+      latency_disk.ReadPage(i, page);
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  // Only a lower bound: a loaded machine may take arbitrarily long to run the threads.
+  EXPECT_GE(elapsed, milliseconds(50));
+
+  start = std::chrono::steady_clock::now();
+  latency_disk.WritePage(0, buf);
+  EXPECT_GE(std::chrono::steady_clock::now() - start, milliseconds(10));
+
+  // Scenario: the bandwidth limit holds transfers back one after another. 16 pages at 64 pages per second take 250 ms.
+  DiskProfile narrow{milliseconds(0), milliseconds(0), 64 * PAGE_SIZE, 64 * PAGE_SIZE};
+  DiskManagerLatency bandwidth_disk(&memory, narrow);
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < 8; ++i) {
+    bandwidth_disk.ReadPage(i, buf);
+  }
+  std::vector<page_id_t> page_ids{8, 9, 10, 11, 12, 13, 14, 15};
+  std::vector<char *> page_data(page_ids.size(), buf);
+  bandwidth_disk.ReadPages(page_ids, page_data);
+  EXPECT_GE(std::chrono::steady_clock::now() - start, milliseconds(250));
+  // The wrapper reports the counters of the disk below it.
+  EXPECT_EQ(20, bandwidth_disk.GetNumReads());
+}
+
+}  // namespace bustub
@@ -10,26 +10,100 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
 #include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/catalog.h"
+#include "catalog/table_generator.h"
 #include "common/exception.h"
+#include "common/util/lz_codec.h"
+#include "concurrency/transaction.h"
+#include "execution/executor_context.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/page_scrubber.h"
 
 namespace bustub {
 
+/** Overwrite the bytes of a file that follow the first occurrence of marker, behind the disk manager's back. */
+static void Scribble(const std::string &file_name, const std::string &marker, const std::string &bytes) {
+  std::fstream file(file_name, std::ios::binary | std::ios::in | std::ios::out);
+  std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  size_t pos = contents.find(marker);
+  ASSERT_NE(std::string::npos, pos);
+  file.seekp(pos + marker.size());
+  file.write(bytes.data(), bytes.size());
+}
+
+/**
+ * Swap the descriptor the process holds on a file for one opened with flags, behind the disk manager's back, so that
+ * the reads or writes it is not opened for fail.
+ */
+static void ReopenFile(const std::string &file_name, int flags) {
+  std::filesystem::path path = std::filesystem::canonical(file_name);
+  for (const auto &entry : std::filesystem::directory_iterator("/proc/self/fd")) {
+    std::error_code ec;
+    if (std::filesystem::read_symlink(entry.path(), ec) != path) {
+      continue;
+    }
+    int fd = open(file_name.c_str(), flags);
+    ASSERT_GE(fd, 0);
+    ASSERT_GE(dup2(fd, std::stoi(entry.path().filename().string())), 0);
+    close(fd);
+    return;
+  }
+  FAIL() << file_name << " is not open";
+}
+
+/** @return the type of the exception that op throws, INVALID if it does not throw one */
+template <typename Op>
+static ExceptionType ThrownType(Op op) {
+  try {
+    op();
+  } catch (const Exception &e) {
+    return e.GetType();
+  }
+  return ExceptionType::INVALID;
+}
+
 class DiskManagerTest : public ::testing::Test {
  protected:
   // This function is called before every test.
   void SetUp() override {
     remove("test.db");
     remove("test.log");
+    remove("test.dwb");
+    remove("test.tablespaces");
+    remove("test.1.db");
+    remove("test_index.db");
+    remove("test.db.slots");
+    remove("test.db.slotmap");
   }
 
   // This function is called after every test.
   void TearDown() override {
     remove("test.db");
     remove("test.log");
+    remove("test.dwb");
+    remove("test.tablespaces");
+    remove("test.1.db");
+    remove("test_index.db");
+    remove("test.db.slots");
+    remove("test.db.slotmap");
   };
 };
 
@@ -55,6 +129,715 @@ TEST_F(DiskManagerTest, ReadWritePageTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ReadPagesTest) {
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+  char data[PAGE_SIZE] = {0};
+  for (page_id_t page_id = 0; page_id < 6; ++page_id) {
+    snprintf(data, sizeof(data), "page %d", page_id);
+    dm.WritePage(page_id, data);
+  }
+
+  // Two runs of adjacent pages and a page past the end of the file, which reads as zeros.
+  std::vector<page_id_t> page_ids{1, 2, 3, 5, 8};
+  std::vector<std::vector<char>> bufs(page_ids.size(), std::vector<char>(PAGE_SIZE, 'x'));
+  std::vector<char *> page_data;
+  for (auto &buf : bufs) {
+    page_data.push_back(buf.data());
+  }
+  dm.ReadPages(page_ids, page_data);
+  for (size_t i = 0; i + 1 < page_ids.size(); ++i) {
+    EXPECT_EQ("page " + std::to_string(page_ids[i]), std::string(bufs[i].data()));
+  }
+  EXPECT_EQ(std::vector<char>(PAGE_SIZE, 0), bufs.back());
+  EXPECT_EQ(static_cast<int>(page_ids.size()), dm.GetNumReads());
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ConcurrentReadWritePageTest) {
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+  const int num_threads = 8;
+  const int pages_per_thread = 64;
+
+  // Every thread writes its own pages and reads them back while the others do the same.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&dm, tid] {
+      char data[PAGE_SIZE];
+      char buf[PAGE_SIZE];
+      for (int round = 0; round < 4; ++round) {
+        for (int i = 0; i < pages_per_thread; ++i) {
+          page_id_t page_id = i * num_threads + tid;
+          std::memset(data, 'a' + (page_id + round) % 26, sizeof(data));
+          dm.WritePage(page_id, data);
+          dm.ReadPage(page_id, buf);
+          EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_threads * pages_per_thread * 4, dm.GetNumWrites());
+  EXPECT_EQ(num_threads * pages_per_thread * 4, dm.GetNumReads());
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, LargeOffsetTest) {
+  char buf[PAGE_SIZE] = {0};
+  char data[PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+  std::strncpy(data, "A page beyond 2GB.", sizeof(data));
+
+  // The file is sparse, so only the written page takes space on disk.
+  page_id_t page_id = static_cast<page_id_t>((int64_t{3} << 30) / PAGE_SIZE);
+  dm.WritePage(page_id, data);
+  dm.ReadPage(page_id, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+
+  // The hole in front of it reads as zeros.
+  dm.ReadPage(page_id - 1, buf);
+  EXPECT_EQ(std::vector<char>(PAGE_SIZE, 0), std::vector<char>(buf, buf + PAGE_SIZE));
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, AllocateDeallocateTest) {
+  char data[PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  auto *dm = new DiskManager(db_file);
+  for (page_id_t page_id = 0; page_id < 10; ++page_id) {
+    EXPECT_EQ(page_id, dm->AllocatePage());
+    snprintf(data, sizeof(data), "page %d", page_id);
+    dm->WritePage(page_id, data);
+  }
+
+  // Scenario: freed pages are reused, lowest first, before the file grows.
+  dm->DeallocatePage(5);
+  dm->DeallocatePage(3);
+  dm->DeallocatePage(3);
+  EXPECT_FALSE(dm->IsAllocated(3));
+  EXPECT_TRUE(dm->IsAllocated(4));
+  EXPECT_EQ(3, dm->AllocatePage());
+  EXPECT_EQ(5, dm->AllocatePage());
+  EXPECT_EQ(10, dm->AllocatePage());
+
+  // Scenario: instances sharing the file only get their own page ids.
+  dm->DeallocatePage(4);
+  dm->DeallocatePage(6);
+  EXPECT_EQ(6, dm->AllocatePage(3, 0));
+  EXPECT_EQ(4, dm->AllocatePage(3, 1));
+  EXPECT_EQ(13, dm->AllocatePage(3, 1));
+  EXPECT_EQ(11, dm->AllocatePage(3, 2));
+
+  // Scenario: the free-space map survives a restart.
+  dm->ShutDown();
+  delete dm;
+  dm = new DiskManager(db_file);
+  for (page_id_t page_id = 0; page_id < 14; ++page_id) {
+    EXPECT_EQ(page_id != 12, dm->IsAllocated(page_id));
+  }
+  EXPECT_EQ(12, dm->AllocatePage());
+
+  // Scenario: freeing the last pages gives their space back, down to the last page still allocated.
+  dm->WritePage(13, data);
+  int64_t file_size = dm->GetDbFileSize();
+  for (page_id_t page_id = 13; page_id >= 8; --page_id) {
+    dm->DeallocatePage(page_id);
+  }
+  EXPECT_EQ(file_size - 6 * PAGE_SIZE, dm->GetDbFileSize());
+  char buf[PAGE_SIZE] = {0};
+  dm->ReadPage(7, buf);
+  EXPECT_EQ("page 7", std::string(buf));
+  EXPECT_EQ(8, dm->AllocatePage());
+
+  dm->ShutDown();
+  delete dm;
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, FreeSpaceMapIntervalTest) {
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+
+  // Pages on both sides of the second free-space map page, read as one batch, do not overwrite or read the map.
+  std::vector<page_id_t> page_ids{FREE_SPACE_MAP_INTERVAL - 2, FREE_SPACE_MAP_INTERVAL - 1, FREE_SPACE_MAP_INTERVAL,
+                                  FREE_SPACE_MAP_INTERVAL + 1};
+  char data[PAGE_SIZE];
+  for (auto page_id : page_ids) {
+    std::memset(data, 0xff, sizeof(data));
+    snprintf(data, sizeof(data), "page %d", page_id);
+    dm.WritePage(page_id, data);
+  }
+  std::vector<std::vector<char>> bufs(page_ids.size(), std::vector<char>(PAGE_SIZE));
+  std::vector<char *> page_data;
+  for (auto &buf : bufs) {
+    page_data.push_back(buf.data());
+  }
+  dm.ReadPages(page_ids, page_data);
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    EXPECT_EQ("page " + std::to_string(page_ids[i]), std::string(bufs[i].data()));
+  }
+
+  EXPECT_FALSE(dm.IsAllocated(FREE_SPACE_MAP_INTERVAL));
+  EXPECT_EQ(0, dm.AllocatePage());
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ChecksumTest) {
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+  char data[PAGE_SIZE];
+  char buf[PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < 4; ++page_id) {
+    std::memset(data, 'a' + page_id, sizeof(data));
+    snprintf(data, sizeof(data), "page %d|", page_id);
+    dm.WritePage(page_id, data);
+  }
+
+  // Scenario: a flipped byte is caught by ReadPage, ReadPages, VerifyPage and CheckPage alike.
+  Scribble(db_file, "page 1|", "x");
+  EXPECT_EQ(ExceptionType::CORRUPTION, ThrownType([&] { dm.ReadPage(1, buf); }));
+  EXPECT_FALSE(dm.VerifyPage(1, buf));
+  EXPECT_FALSE(dm.CheckPage(1));
+  EXPECT_TRUE(dm.CheckPage(0));
+
+  // ReadPages still reads every page of the batch before it throws.
+  std::vector<std::vector<char>> bufs(4, std::vector<char>(PAGE_SIZE));
+  std::vector<char *> page_data;
+  for (auto &page_buf : bufs) {
+    page_data.push_back(page_buf.data());
+  }
+  EXPECT_EQ(ExceptionType::CORRUPTION, ThrownType([&] { dm.ReadPages({0, 1, 2, 3}, page_data); }));
+  EXPECT_EQ("page 3|", std::string(bufs[3].data(), 7));
+
+  // Scenario: a torn write, i.e. a crash after only the first half of a page reached the disk, is caught too.
+  Scribble(db_file, "page 2|", std::string(PAGE_SIZE / 2, 'z'));
+  EXPECT_EQ(ExceptionType::CORRUPTION, ThrownType([&] { dm.ReadPage(2, buf); }));
+
+  // Scenario: writing a page again repairs it, and pages that were never written are not verified.
+  dm.WritePage(1, data);
+  dm.ReadPage(1, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+  EXPECT_TRUE(dm.CheckPage(100));
+  dm.ShutDown();
+
+  // Scenario: checksums survive a restart.
+  auto dm2 = DiskManager(db_file);
+  EXPECT_EQ(ExceptionType::CORRUPTION, ThrownType([&] { dm2.ReadPage(2, buf); }));
+  dm2.ReadPage(1, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+  dm2.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, IOErrorTest) {
+  char buf[PAGE_SIZE] = {0};
+  char data[PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+  std::strncpy(data, "page 0|", sizeof(data));
+  dm.WritePage(0, data);
+  dm.WritePage(1, data);
+
+  // Scenario: a write that fails is reported rather than lost.
+  ReopenFile(db_file, O_RDONLY);
+  EXPECT_EQ(ExceptionType::IO, ThrownType([&] { dm.WritePage(0, data); }));
+  EXPECT_EQ(ExceptionType::IO, ThrownType([&] { dm.WritePages({0, 1}, {data, data}); }));
+
+  // Scenario: so is a read that fails, by ReadPage and ReadPages alike.
+  ReopenFile(db_file, O_WRONLY);
+  EXPECT_EQ(ExceptionType::IO, ThrownType([&] { dm.ReadPage(0, buf); }));
+  EXPECT_EQ(ExceptionType::IO, ThrownType([&] { dm.ReadPages({0, 1}, {buf, buf}); }));
+
+  ReopenFile(db_file, O_RDWR);
+  dm.ReadPage(0, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, PageScrubberTest) {
+  const int num_pages = SCRUB_PAGES_PER_ROUND * 2 + 10;
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+  char data[PAGE_SIZE] = {0};
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id = dm.AllocatePage();
+    snprintf(data, sizeof(data), "page %d|", page_id);
+    dm.WritePage(page_id, data);
+  }
+  // Scenario: with no write under way, every write that was started has finished.
+  EXPECT_EQ(static_cast<uint64_t>(num_pages), dm.GetWritesStarted());
+  EXPECT_EQ(dm.GetWritesStarted(), dm.GetWritesFinished());
+  Scribble(db_file, "page 7|", "x");
+  Scribble(db_file, "page 100|", "x");
+
+  auto saved_interval = scrubber_interval;
+  scrubber_interval = std::chrono::milliseconds(5);
+  {
+    // Page 100 counts as hot and is left alone.
+    PageScrubber scrubber(&dm, [](page_id_t page_id) { return page_id == 100; });
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (scrubber.GetNumScrubbed() < static_cast<size_t>(num_pages - 1) &&
+           std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_LE(static_cast<size_t>(num_pages - 1), scrubber.GetNumScrubbed());
+    EXPECT_EQ(std::set<page_id_t>{7}, scrubber.GetCorruptPages());
+  }
+  scrubber_interval = saved_interval;
+
+  // The scrubber does not count as reading pages.
+  EXPECT_EQ(0, dm.GetNumReads());
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DoubleWriteTest) {
+  const int num_pages = 10;
+  std::string db_file("test.db");
+  char data[PAGE_SIZE];
+  char buf[PAGE_SIZE];
+  std::vector<std::vector<char>> pages(num_pages, std::vector<char>(PAGE_SIZE));
+  std::vector<page_id_t> page_ids;
+  std::vector<const char *> page_data;
+  {
+    auto dm = DiskManager(db_file, true);
+    EXPECT_TRUE(dm.UsesDoubleWrite());
+    for (int i = 0; i < num_pages; ++i) {
+      page_ids.push_back(dm.AllocatePage());
+      std::memset(pages[i].data(), 'a' + i, PAGE_SIZE);
+      snprintf(pages[i].data(), PAGE_SIZE, "page %d|", page_ids.back());
+      page_data.push_back(pages[i].data());
+    }
+    dm.WritePages(page_ids, page_data);
+    EXPECT_EQ(num_pages, dm.GetNumWrites());
+
+    // Scenario: a crash tears the in-place writes of two pages of the last batch. The disk manager goes away without
+    // a shutdown, so the double-write file stays behind.
+    Scribble(db_file, "page 3|", std::string(PAGE_SIZE / 2, 'z'));
+    Scribble(db_file, "page 8|", "z");
+  }
+  {
+    // The next disk manager writes the journaled copies back, even without double write of its own.
+    auto dm = DiskManager(db_file);
+    EXPECT_EQ(2, dm.GetNumRestoredPages());
+    for (int i = 0; i < num_pages; ++i) {
+      dm.ReadPage(page_ids[i], buf);
+      EXPECT_EQ(std::memcmp(buf, page_data[i], PAGE_SIZE), 0);
+    }
+    dm.ShutDown();
+  }
+  {
+    // Scenario: a crash during the journal write leaves a torn double-write file, which is ignored.
+    auto dm = DiskManager(db_file, true);
+    EXPECT_EQ(0, dm.GetNumRestoredPages());
+    std::memset(data, 'q', sizeof(data));
+    snprintf(data, sizeof(data), "journal %d|", page_ids[0]);
+    dm.WritePage(page_ids[0], data);
+  }
+  Scribble("test.dwb", "journal 0|", "z");
+  Scribble(db_file, "journal 0|", "z");
+  {
+    auto dm = DiskManager(db_file, true);
+    EXPECT_EQ(0, dm.GetNumRestoredPages());
+    EXPECT_EQ(ExceptionType::CORRUPTION, ThrownType([&] { dm.ReadPage(page_ids[0], buf); }));
+    dm.ShutDown();
+  }
+
+  // Scenario: a shutdown removes the double-write file.
+  EXPECT_EQ(nullptr, fopen("test.dwb", "r"));
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, TablespaceTest) {
+  std::string db_file("test.db");
+  char data[PAGE_SIZE] = {0};
+  char buf[PAGE_SIZE];
+  page_id_t table_page_id;
+  page_id_t index_page_id;
+  {
+    auto dm = DiskManager(db_file);
+    EXPECT_EQ(0, dm.AllocatePage());
+
+    // Scenario: a tablespace next to the db file and one in a file of our choosing. Their page ids carry the
+    // tablespace, and their pages go to their own files.
+    tablespace_id_t table_space = dm.CreateTablespace("");
+    tablespace_id_t index_space = dm.CreateTablespace("test_index.db");
+    EXPECT_EQ(1, table_space);
+    EXPECT_EQ(2, index_space);
+    EXPECT_EQ("test.1.db", dm.GetTablespaceFile(table_space));
+    EXPECT_EQ("", dm.GetTablespaceFile(3));
+    EXPECT_THROW(dm.CreateTablespace("test_index.db"), Exception);
+
+    table_page_id = dm.AllocatePage(1, 0, table_space);
+    EXPECT_EQ(MakePageId(table_space, 0), table_page_id);
+    EXPECT_EQ(table_space, GetTablespace(table_page_id));
+    EXPECT_EQ(MakePageId(table_space, 1), dm.AllocatePage(1, 0, table_space));
+    // Instances sharing the disk still get the page ids of their residue.
+    index_page_id = dm.AllocatePage(3, 2, index_space);
+    EXPECT_EQ(2U, static_cast<uint32_t>(index_page_id) % 3);
+    EXPECT_EQ(index_space, GetTablespace(index_page_id));
+
+    int64_t db_file_size = dm.GetDbFileSize();
+    snprintf(data, sizeof(data), "table page");
+    dm.WritePage(table_page_id, data);
+    snprintf(data, sizeof(data), "index page");
+    dm.WritePage(index_page_id, data);
+    EXPECT_EQ(db_file_size, dm.GetDbFileSize());
+    EXPECT_EQ(MakePageId(table_space, 0), dm.NextAllocatedPage(1));
+    EXPECT_EQ(index_page_id, dm.NextAllocatedPage(MakePageId(table_space, 2)));
+    dm.ShutDown();
+  }
+  {
+    // Scenario: the tablespaces are opened again along with the db file.
+    auto dm = DiskManager(db_file);
+    dm.ReadPage(table_page_id, buf);
+    EXPECT_STREQ("table page", buf);
+    dm.ReadPage(index_page_id, buf);
+    EXPECT_STREQ("index page", buf);
+    EXPECT_TRUE(dm.IsAllocated(MakePageId(1, 1)));
+    EXPECT_FALSE(dm.IsAllocated(MakePageId(3, 0)));
+
+    // Scenario: dropping a tablespace unlinks its file, and its page ids are gone with it.
+    dm.DropTablespace(1);
+    EXPECT_FALSE(std::ifstream("test.1.db").good());
+    EXPECT_EQ(ExceptionType::OUT_OF_RANGE, ThrownType([&] { dm.ReadPage(table_page_id, buf); }));
+    EXPECT_FALSE(dm.IsAllocated(table_page_id));
+    EXPECT_EQ(ExceptionType::OUT_OF_RANGE, ThrownType([&] { dm.DropTablespace(1); }));
+    EXPECT_EQ(ExceptionType::OUT_OF_RANGE, ThrownType([&] { dm.DropTablespace(DEFAULT_TABLESPACE); }));
+    // The lowest free id is handed out again.
+    EXPECT_EQ(1, dm.CreateTablespace(""));
+    EXPECT_FALSE(dm.IsAllocated(table_page_id));
+    dm.DropTablespace(1);
+    dm.DropTablespace(2);
+    dm.ShutDown();
+  }
+  {
+    auto dm = DiskManager(db_file);
+    EXPECT_EQ("", dm.GetTablespaceFile(2));
+    EXPECT_FALSE(std::ifstream("test_index.db").good());
+    dm.ShutDown();
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ConcurrentDropTablespaceTest) {
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+  const int num_threads = 4;
+  const int num_pages = 16;
+  std::atomic<bool> done{false};
+
+  // Scenario: a tablespace is dropped and created again while threads do I/O on its pages. Each access either finds
+  // the tablespace or fails cleanly, and the pages of the default tablespace are not affected.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&, tid] {
+      char data[PAGE_SIZE];
+      char buf[PAGE_SIZE];
+      for (int round = 0; !done; ++round) {
+        for (int i = 0; i < num_pages; ++i) {
+          std::memset(data, 'a' + (i + round) % 26, sizeof(data));
+          try {
+            dm.WritePage(MakePageId(1, i), data);
+            dm.ReadPage(MakePageId(1, i), buf);
+          } catch (const Exception &e) {
+          }
+          page_id_t page_id = i * num_threads + tid;
+          dm.WritePage(page_id, data);
+          dm.ReadPage(page_id, buf);
+          EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+        }
+      }
+    });
+  }
+  for (int i = 0; i < 64; ++i) {
+    EXPECT_EQ(1, dm.CreateTablespace(""));
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+    dm.DropTablespace(1);
+  }
+  done = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_FALSE(std::ifstream("test.1.db").good());
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ExtentTest) {
+  const int extent_pages = 16;
+  auto dm = DiskManager("test.db", false, false, extent_pages);
+  EXPECT_EQ(extent_pages, dm.GetExtentPages());
+
+  // Scenario: allocating a page preallocates its extent, without growing the file.
+  page_id_t table_a = dm.AllocatePage();
+  page_id_t table_b = dm.AllocatePage();
+  EXPECT_EQ(PAGE_SIZE, dm.GetDbFileSize());
+  EXPECT_GE(dm.GetDiskUsage(), extent_pages * PAGE_SIZE);
+
+  // Scenario: two tables growing side by side with other allocations in between each get extents of their own, which
+  // they fill in order, and the other allocations go around them.
+  std::vector<page_id_t> a_pages{table_a};
+  std::vector<page_id_t> b_pages{table_b};
+  std::vector<page_id_t> others;
+  for (int i = 0; i < 2 * extent_pages; ++i) {
+    a_pages.push_back(dm.AllocatePage(1, 0, DEFAULT_TABLESPACE, a_pages.back()));
+    b_pages.push_back(dm.AllocatePage(1, 0, DEFAULT_TABLESPACE, b_pages.back()));
+    others.push_back(dm.AllocatePage());
+  }
+  EXPECT_EQ(extent_pages, a_pages[1]);
+  EXPECT_EQ(2 * extent_pages, b_pages[1]);
+  EXPECT_EQ(2, others[0]);
+  std::set<page_id_t> a_extents;
+  std::set<page_id_t> b_extents;
+  for (size_t i = 2; i < a_pages.size(); ++i) {
+    EXPECT_TRUE(a_pages[i] == a_pages[i - 1] + 1 || a_pages[i] % extent_pages == 0);
+    EXPECT_TRUE(b_pages[i] == b_pages[i - 1] + 1 || b_pages[i] % extent_pages == 0);
+    a_extents.insert(a_pages[i] / extent_pages);
+    b_extents.insert(b_pages[i] / extent_pages);
+  }
+  EXPECT_EQ(2, a_extents.size());
+  EXPECT_EQ(2, b_extents.size());
+  for (page_id_t page_id : others) {
+    EXPECT_EQ(0, a_extents.count(page_id / extent_pages) + b_extents.count(page_id / extent_pages));
+  }
+
+  // Scenario: allocations near a page that is not the last one of its extent go to a fresh extent.
+  page_id_t fresh = dm.AllocatePage(1, 0, DEFAULT_TABLESPACE, a_pages[3]);
+  EXPECT_EQ(0, fresh % extent_pages);
+  EXPECT_EQ(0, a_extents.count(fresh / extent_pages) + b_extents.count(fresh / extent_pages));
+
+  // Scenario: other allocations go around a reserved extent, but once its table moves on, they take what it left.
+  page_id_t extent_end = fresh + extent_pages;
+  page_id_t other;
+  do {
+    other = dm.AllocatePage(2, 1);
+    EXPECT_TRUE(other < fresh || other >= extent_end);
+  } while (other < extent_end);
+  page_id_t last = fresh;
+  while (last < extent_end) {
+    last = dm.AllocatePage(2, 0, DEFAULT_TABLESPACE, last);
+  }
+  EXPECT_EQ(fresh + 1, dm.AllocatePage(2, 1));
+
+  // Scenario: instances sharing the disk take turns filling one extent.
+  std::vector<page_id_t> c_pages{dm.AllocatePage(2, 0)};
+  for (uint32_t i = 1; i < extent_pages; ++i) {
+    c_pages.push_back(dm.AllocatePage(2, i % 2, DEFAULT_TABLESPACE, c_pages.back()));
+    EXPECT_EQ(i % 2, static_cast<uint32_t>(c_pages.back()) % 2);
+  }
+  for (size_t i = 2; i < c_pages.size(); ++i) {
+    EXPECT_EQ(c_pages[i - 1] + 1, c_pages[i]);
+  }
+
+  // Scenario: an extent that has been emptied out is open to other allocations again.
+  for (size_t i = 1; i < b_pages.size(); ++i) {
+    dm.DeallocatePage(b_pages[i]);
+  }
+  EXPECT_EQ(b_pages[1], dm.AllocatePage());
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, CompressionTest) {
+  const int num_pages = 64;
+  std::string db_file("test.db");
+  char data[PAGE_SIZE] = {0};
+  char buf[PAGE_SIZE];
+  std::vector<char> noise(PAGE_SIZE);
+  std::mt19937 gen(0);
+  for (auto &c : noise) {
+    c = static_cast<char>(gen());
+  }
+  auto file_size = [](const std::string &file_name) {
+    return static_cast<int64_t>(std::ifstream(file_name, std::ios::binary | std::ios::ate).tellg());
+  };
+  {
+    // Extents of one page, so that little space is preallocated.
+    auto dm = DiskManager(db_file, false, true, 1);
+    EXPECT_TRUE(dm.UsesCompression());
+    // Scenario: mostly empty pages take a slot unit each, and a page of noise is stored as is.
+    for (int i = 0; i < num_pages; ++i) {
+      EXPECT_EQ(i, dm.AllocatePage());
+      snprintf(data, sizeof(data), "page %d|", i);
+      dm.WritePage(i, data);
+    }
+    dm.WritePage(num_pages - 1, noise.data());
+    EXPECT_EQ(num_pages * COMPRESSED_SLOT_SIZE + PAGE_SIZE, file_size("test.db.slots"));
+    EXPECT_LT(dm.GetDiskUsage(), num_pages * PAGE_SIZE / 4);
+    for (int i = 0; i < num_pages - 1; ++i) {
+      dm.ReadPage(i, buf);
+      snprintf(data, sizeof(data), "page %d|", i);
+      EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+    }
+    dm.ReadPage(num_pages - 1, buf);
+    EXPECT_EQ(std::memcmp(buf, noise.data(), sizeof(buf)), 0);
+    dm.ShutDown();
+  }
+  {
+    // Scenario: the db file is opened compressed again without asking, and rewrites reuse the slots they free.
+    auto dm = DiskManager(db_file);
+    EXPECT_TRUE(dm.UsesCompression());
+    std::vector<page_id_t> page_ids;
+    std::vector<char *> bufs;
+    std::vector<std::vector<char>> pages(num_pages, std::vector<char>(PAGE_SIZE));
+    for (int i = 0; i < num_pages; ++i) {
+      page_ids.push_back(i);
+      bufs.push_back(pages[i].data());
+    }
+    dm.ReadPages(page_ids, bufs);
+    EXPECT_STREQ("page 5|", pages[5].data());
+    EXPECT_EQ(noise, pages[num_pages - 1]);
+    for (int round = 0; round < 4; ++round) {
+      for (int i = 0; i < num_pages - 1; ++i) {
+        snprintf(data, sizeof(data), "round %d page %d|", round, i);
+        dm.WritePage(i, data);
+      }
+    }
+    dm.ReadPage(7, buf);
+    EXPECT_STREQ("round 3 page 7|", buf);
+    EXPECT_EQ(num_pages * COMPRESSED_SLOT_SIZE + PAGE_SIZE, file_size("test.db.slots"));
+
+    // Scenario: the noise page is rewritten compressed, and its slot is split up for the pages after it.
+    dm.WritePage(num_pages - 1, data);
+    dm.DeallocatePage(num_pages - 1);
+    dm.ReadPage(num_pages - 1, buf);
+    EXPECT_EQ(std::vector<char>(PAGE_SIZE, 0), std::vector<char>(buf, buf + PAGE_SIZE));
+    EXPECT_EQ(num_pages - 1, dm.AllocatePage());
+    for (int i = 0; i < num_pages; ++i) {
+      snprintf(data, sizeof(data), "final page %d|", i);
+      dm.WritePage(i, data);
+    }
+    EXPECT_EQ(num_pages * COMPRESSED_SLOT_SIZE + PAGE_SIZE, file_size("test.db.slots"));
+
+    // Scenario: a damaged image fails its checksum like any other page.
+    snprintf(data, sizeof(data), "damaged page|");
+    dm.WritePage(3, data);
+    Scribble("test.db.slots", "damaged page|", "zz");
+    EXPECT_EQ(ExceptionType::CORRUPTION, ThrownType([&] { dm.ReadPage(3, buf); }));
+    EXPECT_FALSE(dm.CheckPage(3));
+    EXPECT_TRUE(dm.CheckPage(4));
+    dm.ShutDown();
+  }
+}
+
+/**
+ * Compression ratio of the pages of the tables TableGenerator generates, and how fast they are written and read back
+ * with and without compression. The pages are written over and over to make up a table of a few thousand pages.
+ */
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, CompressionBenchmark) {
+  const int num_pages = 4096;
+  std::vector<std::vector<char>> images;
+  {
+    auto dm = DiskManager("test.db");
+    BufferPoolManagerInstance bpm(64, &dm);
+    Catalog catalog(&bpm, nullptr, nullptr);
+    Transaction txn(0);
+    ExecutorContext exec_ctx(&txn, &catalog, &bpm, nullptr, nullptr);
+    TableGenerator gen{&exec_ctx};
+    gen.GenerateTestTables();
+    bpm.FlushAllPages();
+    for (page_id_t page_id = dm.NextAllocatedPage(0); page_id != INVALID_PAGE_ID;
+         page_id = dm.NextAllocatedPage(page_id + 1)) {
+      images.emplace_back(PAGE_SIZE);
+      dm.ReadPage(page_id, images.back().data());
+    }
+    dm.ShutDown();
+    remove("test.db");
+  }
+  ASSERT_FALSE(images.empty());
+
+  size_t compressed_size = 0;
+  std::vector<char> compressed(LzCodec::MaxCompressedSize(PAGE_SIZE));
+  for (auto &image : images) {
+    compressed_size += LzCodec::Compress(image.data(), PAGE_SIZE, compressed.data(), compressed.size());
+  }
+  std::cout << images.size() << " generated pages, codec ratio\t"
+            << static_cast<double>(images.size() * PAGE_SIZE) / compressed_size << std::endl;
+
+  auto run = [&](bool compress) {
+    auto dm = DiskManager("test.db", false, compress);
+    std::vector<char> buf(PAGE_SIZE);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_pages; ++i) {
+      dm.WritePage(dm.AllocatePage(), images[i % images.size()].data());
+    }
+    std::chrono::duration<double> write_time = std::chrono::steady_clock::now() - start;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_pages; ++i) {
+      dm.ReadPage(i, buf.data());
+    }
+    std::chrono::duration<double> read_time = std::chrono::steady_clock::now() - start;
+    double megabytes = static_cast<double>(num_pages) * PAGE_SIZE / (1 << 20);
+    std::cout << (compress ? "compressed" : "uncompressed") << "\tdisk usage "
+              << static_cast<double>(dm.GetDiskUsage()) / (1 << 20) << " MB, ratio "
+              << megabytes * (1 << 20) / static_cast<double>(dm.GetDiskUsage()) << ", write "
+              << megabytes / write_time.count() << " MB/s, read " << megabytes / read_time.count() << " MB/s"
+              << std::endl;
+    dm.ShutDown();
+    remove("test.db");
+    remove("test.db.slots");
+    remove("test.db.slotmap");
+  };
+  run(false);
+  run(true);
+}
+
+/**
+ * Pages per second written in place with no protection, through the double-write file one page at a time, and through
+ * the double-write file in batches of DOUBLE_WRITE_PAGES.
+ */
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DoubleWriteBenchmark) {
+  const int num_pages = DOUBLE_WRITE_PAGES * 4;
+  std::vector<std::vector<char>> pages(num_pages, std::vector<char>(PAGE_SIZE, 'x'));
+  std::vector<page_id_t> page_ids;
+  std::vector<const char *> page_data;
+  for (int i = 0; i < num_pages; ++i) {
+    page_ids.push_back(i);
+    page_data.push_back(pages[i].data());
+  }
+
+  auto pages_per_second = [&](bool double_write, bool batched) {
+    auto dm = DiskManager("test.db", double_write);
+    auto start = std::chrono::steady_clock::now();
+    if (batched) {
+      dm.WritePages(page_ids, page_data);
+    } else {
+      for (int i = 0; i < num_pages; ++i) {
+        dm.WritePage(page_ids[i], page_data[i]);
+      }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    dm.ShutDown();
+    remove("test.db");
+    return num_pages / elapsed.count();
+  };
+  double in_place = pages_per_second(false, false);
+  double one_by_one = pages_per_second(true, false);
+  double batched = pages_per_second(true, true);
+  std::cout << "in place, no sync\t" << static_cast<int64_t>(in_place) << " pages/s" << std::endl;
+  std::cout << "double write, page by page\t" << static_cast<int64_t>(one_by_one) << " pages/s" << std::endl;
+  std::cout << "double write, batched\t" << static_cast<int64_t>(batched) << " pages/s" << std::endl;
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ReadWriteLogTest) {
   char buf[16] = {0};
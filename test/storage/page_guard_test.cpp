@@ -0,0 +1,154 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_guard_test.cpp
+//
+// Identification: test/storage/page_guard_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/page_guard.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(PageGuardTest, BasicGuardTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id;
+  auto *page = bpm->NewPage(&page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  EXPECT_TRUE(bpm->FlushPage(page_id));
+
+  {
+    // Scenario: a guard holds exactly one pin, and a moved-from guard holds nothing.
+    auto guard = bpm->FetchPageBasic(page_id);
+    ASSERT_TRUE(guard.IsValid());
+    EXPECT_EQ(page_id, guard.PageId());
+    EXPECT_EQ(1, page->GetPinCount());
+    auto moved = std::move(guard);
+    EXPECT_FALSE(guard.IsValid());  // NOLINT
+    EXPECT_EQ(1, page->GetPinCount());
+
+    // Scenario: assigning to a guard unpins what it held before.
+    auto other = bpm->FetchPageBasic(page_id);
+    EXPECT_EQ(2, page->GetPinCount());
+    other = std::move(moved);
+    EXPECT_EQ(1, page->GetPinCount());
+
+    // Scenario: reading leaves the page clean, writing marks it dirty on unpin.
+    EXPECT_EQ(0, strcmp(other.GetData(), ""));
+    other.Drop();
+    EXPECT_FALSE(page->IsDirty());
+    other = bpm->FetchPageBasic(page_id);
+    snprintf(other.GetDataMut(), PAGE_SIZE, "Hello");
+    other.Drop();
+    EXPECT_FALSE(other.IsValid());
+    EXPECT_EQ(0, page->GetPinCount());
+    EXPECT_TRUE(page->IsDirty());
+    other.Drop();
+    EXPECT_EQ(0, page->GetPinCount());
+  }
+
+  // Scenario: a page that cannot be fetched gives an invalid guard, which is safe to destroy.
+  std::vector<BasicPageGuard> guards;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t temp;
+    guards.emplace_back(bpm->NewPageGuarded(&temp));
+    EXPECT_TRUE(guards.back().IsValid());
+  }
+  EXPECT_FALSE(bpm->FetchPageRead(page_id).IsValid());
+  guards.clear();
+  EXPECT_TRUE(bpm->FetchPageRead(page_id).IsValid());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(PageGuardTest, LatchGuardTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id;
+  auto *page = bpm->NewPage(&page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+
+  {
+    // Scenario: read guards share the page; each holds its own pin.
+    auto reader1 = bpm->FetchPageRead(page_id);
+    auto reader2 = bpm->FetchPageRead(page_id);
+    EXPECT_EQ(2, page->GetPinCount());
+    reader1.Drop();
+    EXPECT_EQ(1, page->GetPinCount());
+  }
+  EXPECT_EQ(0, page->GetPinCount());
+
+  {
+    // Scenario: a write guard can only be taken once every read latch is gone, and its writes are unpinned dirty.
+    auto writer = bpm->FetchPageWrite(page_id);
+    snprintf(writer.GetDataMut(), PAGE_SIZE, "Hello");
+    EXPECT_EQ(1, page->GetPinCount());
+  }
+  EXPECT_EQ(0, page->GetPinCount());
+  EXPECT_TRUE(page->IsDirty());
+
+  {
+    // Scenario: upgrading a basic guard latches the page and hands the pin over.
+    auto basic = bpm->FetchPageBasic(page_id);
+    auto reader = basic.UpgradeRead();
+    EXPECT_FALSE(basic.IsValid());  // NOLINT
+    EXPECT_EQ(1, page->GetPinCount());
+    EXPECT_EQ(0, strcmp(reader.GetData(), "Hello"));
+    reader.Drop();
+
+    basic = bpm->FetchPageBasic(page_id);
+    auto writer = basic.UpgradeWrite();
+    EXPECT_EQ(1, page->GetPinCount());
+  }
+  EXPECT_EQ(0, page->GetPinCount());
+
+  {
+    // Scenario: moving a read guard onto another releases the old latch, so the old page can be written right away.
+    page_id_t other_page_id;
+    auto other = bpm->NewPageGuarded(&other_page_id);
+    other.Drop();
+    auto reader = bpm->FetchPageRead(page_id);
+    reader = bpm->FetchPageRead(other_page_id);
+    auto writer = bpm->FetchPageWrite(page_id);
+    EXPECT_TRUE(writer.IsValid());
+  }
+  EXPECT_EQ(0, page->GetPinCount());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
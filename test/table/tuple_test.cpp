@@ -16,11 +16,12 @@
 #include <string>
 #include <vector>
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
 #include "logging/common.h"
 #include "storage/table/table_heap.h"
 #include "storage/table/tuple.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 // NOLINTNEXTLINE
@@ -39,7 +40,7 @@ TEST(TupleTest, DISABLED_TableHeapTest) {
   // create transaction
   auto *transaction = new Transaction(0);
   auto *disk_manager = new DiskManager("test.db");
-  auto *buffer_pool_manager = new BufferPoolManager(50, disk_manager);
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(50, disk_manager);
   auto *lock_manager = new LockManager();
   auto *log_manager = new LogManager(disk_manager);
   auto *table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction);
@@ -71,4 +72,115 @@ TEST(TupleTest, DISABLED_TableHeapTest) {
   delete disk_manager;
 }
 
+
+// NOLINTNEXTLINE
+TEST(TupleTest, GetTuplesTest) {
+  Column col1{"a", TypeId::INTEGER};
+  Column col2{"b", TypeId::VARCHAR, 100};
+  std::vector<Column> cols{col1, col2};
+  Schema schema{cols};
+
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(10, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *log_manager = new LogManager(disk_manager);
+  auto *table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction);
+
+  // Enough tuples to spread over more pages than the pool holds.
+  std::vector<RID> rids;
+  for (int i = 0; i < 1000; ++i) {
+    std::vector<Value> values{ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::string(50, 'x'))};
+    Tuple tuple(values, &schema);
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+    rids.push_back(rid);
+  }
+
+  // Scenario: tuples come back in the order their rids were given in, and a rid that points nowhere gives none.
+  std::vector<RID> wanted;
+  std::vector<int> expected;
+  for (int i = 999; i >= 0; i -= 7) {
+    wanted.push_back(rids[i]);
+    expected.push_back(i);
+  }
+  wanted.emplace_back(rids[0].GetPageId(), 1000);
+  std::vector<Tuple> tuples;
+  ASSERT_TRUE(table->GetTuples(wanted, &tuples, transaction));
+  ASSERT_EQ(wanted.size(), tuples.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    ASSERT_TRUE(tuples[i].IsAllocated());
+    EXPECT_EQ(expected[i], tuples[i].GetValue(&schema, 0).GetAs<int32_t>());
+  }
+  EXPECT_FALSE(tuples.back().IsAllocated());
+
+  // Scenario: a scan that cannot fetch the pages of the table, as the pool is pinned full, ends at once and aborts.
+  std::vector<page_id_t> pinned;
+  page_id_t page_id;
+  while (buffer_pool_manager->NewPage(&page_id) != nullptr) {
+    pinned.push_back(page_id);
+  }
+  Transaction scan_transaction(1);
+  EXPECT_TRUE(table->Begin(&scan_transaction) == table->End());
+  EXPECT_EQ(TransactionState::ABORTED, scan_transaction.GetState());
+  for (page_id_t pinned_page_id : pinned) {
+    EXPECT_TRUE(buffer_pool_manager->UnpinPage(pinned_page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete table;
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete transaction;
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, TableHeapExtentTest) {
+  Column col1{"a", TypeId::INTEGER};
+  Column col2{"b", TypeId::VARCHAR, 100};
+  std::vector<Column> cols{col1, col2};
+  Schema schema{cols};
+
+  remove("test.db");
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(10, disk_manager);
+  auto *table_a = new TableHeap(buffer_pool_manager, nullptr, nullptr, transaction);
+  auto *table_b = new TableHeap(buffer_pool_manager, nullptr, nullptr, transaction);
+
+  // Scenario: two tables filled at the same time each keep their pages after the first one in a run of page ids.
+  std::vector<page_id_t> a_pages;
+  std::vector<page_id_t> b_pages;
+  for (int i = 0; i < 1000; ++i) {
+    std::vector<Value> values{ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::string(50, 'x'))};
+    Tuple tuple(values, &schema);
+    RID rid;
+    for (auto [table, pages] : {std::make_pair(table_a, &a_pages), std::make_pair(table_b, &b_pages)}) {
+      ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+      if (pages->empty() || pages->back() != rid.GetPageId()) {
+        pages->push_back(rid.GetPageId());
+      }
+    }
+  }
+  ASSERT_GT(a_pages.size(), 2);
+  ASSERT_LT(a_pages.size(), EXTENT_PAGES);
+  EXPECT_EQ(a_pages.size(), b_pages.size());
+  for (size_t i = 2; i < a_pages.size(); ++i) {
+    EXPECT_EQ(a_pages[i - 1] + 1, a_pages[i]);
+    EXPECT_EQ(b_pages[i - 1] + 1, b_pages[i]);
+  }
+  EXPECT_NE(a_pages[1] / EXTENT_PAGES, b_pages[1] / EXTENT_PAGES);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete table_b;
+  delete table_a;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete transaction;
+}
+
 }  // namespace bustub